@@ -0,0 +1,86 @@
+#pragma once
+
+#include <heptcore.hpp>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+    Minimal benchmark harness for heptcore_bench
+
+    Every sample is closed with glFinish so gpu work is part of the measurement,
+    iteration counts are fixed (not time based) so runs are comparable.
+*/
+namespace HeptcoreBench{
+    struct Result{
+        std::string name;
+        std::map<std::string, std::string> parameters = {};
+
+        size_t iterations = 0;
+        double median = 0; // Nanoseconds per iteration
+        double mean = 0;
+        double min = 0;
+        double max = 0;
+
+        // Optional work per iteration for throughput (bytes, draws, ...)
+        double work = 0;
+        std::string work_unit = "";
+
+        std::map<std::string, double> counters = {};
+    };
+
+    class Context{
+        private:
+            size_t warmup;
+            size_t iterations;
+            Result& result;
+
+        public:
+            Context(Result& result, size_t warmup, size_t iterations): warmup(warmup), iterations(iterations), result(result) {}
+
+            void parameter(const std::string& name, const std::string& value) {result.parameters[name] = value;}
+            void parameter(const std::string& name, long long value) {result.parameters[name] = std::to_string(value);}
+            void work(double amount, const std::string& unit) {result.work = amount; result.work_unit = unit;}
+            void counter(const std::string& name, double value) {result.counters[name] = value;}
+
+            /*
+                Runs function warmup + iterations times, timing every call separately.
+                setup runs before every call and isnt measured.
+            */
+            void measure(const std::function<void()>& function, const std::function<void()>& setup = nullptr);
+
+            /*
+                For things that are too fast to time one by one, every sample runs function batch times
+            */
+            void measureBatched(size_t batch, const std::function<void()>& function);
+    };
+
+    using Benchmark = std::function<void(Context&)>;
+
+    class Suite{
+        private:
+            struct Entry{
+                std::string name;
+                Benchmark function;
+                size_t iterations;
+            };
+            std::vector<Entry> entries = {};
+
+        public:
+            void add(const std::string& name, Benchmark function, size_t iterations = 50);
+
+            std::vector<Result> run(const std::string& filter, size_t warmup, double iteration_scale);
+            static void writeJSON(std::ostream& stream, const std::vector<Result>& results);
+    };
+
+    void registerBufferBenchmarks(Suite& suite);
+    void registerShaderBenchmarks(Suite& suite);
+    void registerTextureBenchmarks(Suite& suite);
+    void registerDrawBenchmarks(Suite& suite);
+    void registerComputeBenchmarks(Suite& suite);
+    void registerCullingBenchmarks(Suite& suite);
+    void registerFarmBenchmarks(Suite& suite, Heptcore::Window& window);
+}
@@ -0,0 +1,89 @@
+#include "bench.hpp"
+
+#include <random>
+
+using namespace HeptcoreBench;
+
+void HeptcoreBench::registerBufferBenchmarks(Suite& suite){
+    for(size_t bytes: {4096ul, 65536ul, 1ul << 20, 16ul << 20}){
+        suite.add("buffer_insert/" + std::to_string(bytes), [bytes](Context& context){
+            size_t count = bytes / sizeof(float);
+
+            Heptcore::Buffer<float, GL_ARRAY_BUFFER> buffer{};
+            buffer.initialize(count);
+            std::vector<float> data(count, 1.0f);
+
+            context.parameter("bytes", bytes);
+            context.work((double) bytes, "bytes");
+            context.measure([&]{ buffer.insert(0, count, data.data()); });
+        }, bytes >= (1ul << 20) ? 20 : 100);
+    }
+
+    // Lots of tiny edits scattered over a buffer, the editor entity update pattern
+    suite.add("buffer_insert_scattered/1000x64", [](Context& context){
+        constexpr size_t buffer_count = (1 << 20) / sizeof(float);
+        constexpr size_t edit_count = 64 / sizeof(float);
+        constexpr size_t edits = 1000;
+
+        Heptcore::Buffer<float, GL_ARRAY_BUFFER> buffer{};
+        buffer.initialize(buffer_count);
+        std::vector<float> data(edit_count, 1.0f);
+
+        std::mt19937 random(1234);
+        std::vector<size_t> offsets(edits);
+        for(auto& offset: offsets) offset = random() % (buffer_count - edit_count);
+
+        context.parameter("edits", (long long) edits);
+        context.parameter("edit_bytes", 64);
+        context.work((double) edits, "edits");
+        context.measure([&]{
+            for(size_t offset: offsets) buffer.insert(offset, edit_count, data.data());
+        });
+    }, 20);
+
+    // Same edits through a GpuVector, coalesced and uploaded once per frame
+    struct Edit{ float values[16]; };
+    for(auto [name, upload]: {std::pair{"subdata", Heptcore::GPU_VECTOR_SUBDATA}, std::pair{"staging", Heptcore::GPU_VECTOR_STAGING}}){
+        suite.add(std::string("gpu_vector_scattered/1000x64/") + name, [upload](Context& context){
+            constexpr size_t element_count = (1 << 20) / sizeof(Edit);
+            constexpr size_t edits = 1000;
+
+            Heptcore::GpuVector<Edit, GL_ARRAY_BUFFER> vector{upload};
+            vector.resize(element_count, Edit{});
+            vector.flush();
+
+            std::mt19937 random(1234);
+            std::vector<size_t> indices(edits);
+            for(auto& index: indices) index = random() % element_count;
+
+            Edit edit{};
+            for(float& value: edit.values) value = 1.0f;
+
+            context.parameter("edits", (long long) edits);
+            context.parameter("edit_bytes", 64);
+            context.work((double) edits, "edits");
+            context.measure([&]{
+                for(size_t index: indices) vector[index] = edit;
+                vector.flush();
+            });
+            context.parameter("ranges", (long long) vector.getLastFlushRangeCount());
+            context.parameter("upload_bytes", (long long) vector.getLastFlushBytes());
+        }, 20);
+    }
+
+    // Growing one element at a time, the buffer is reallocated log(n) times
+    suite.add("gpu_vector_push_back/100000", [](Context& context){
+        constexpr size_t count = 100000;
+
+        context.parameter("elements", (long long) count);
+        context.work((double) count, "elements");
+        context.measure([&]{
+            Heptcore::GpuVector<glm::vec4, GL_ARRAY_BUFFER> vector{};
+            for(size_t i = 0; i < count; i++){
+                vector.push_back(glm::vec4((float) i));
+                if(i % 1000 == 999) vector.flush();
+            }
+            vector.flush();
+        });
+    }, 20);
+}
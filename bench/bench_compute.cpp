@@ -0,0 +1,407 @@
+#include "bench.hpp"
+
+#include <memory>
+#include <random>
+
+using namespace HeptcoreBench;
+
+/*
+    Every compute kernel against the fragment shader ping pong through Framebuffers it replaces
+*/
+
+static const char* vertex_source = R"(
+    #version 450 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    out vec2 TexCoord;
+    void main() {
+        gl_Position = vec4(aPos, 0.0, 1.0);
+        TexCoord = aTexCoord;
+    }
+)";
+
+// 2x2 average of the level above, what one level of the compute downsampler does
+static const char* downsample_fragment_source = R"(
+    #version 450 core
+    out vec4 FragColor;
+    uniform sampler2D benchSource;
+    void main() {
+        ivec2 position = ivec2(gl_FragCoord.xy) * 2;
+        ivec2 last = textureSize(benchSource, 0) - 1;
+        FragColor = (texelFetch(benchSource, min(position, last), 0) + texelFetch(benchSource, min(position + ivec2(1, 0), last), 0) +
+            texelFetch(benchSource, min(position + ivec2(0, 1), last), 0) + texelFetch(benchSource, min(position + ivec2(1, 1), last), 0)) * 0.25;
+    }
+)";
+
+// One direction of the separable blur, every pixel fetches all of its taps
+static const char* blur_fragment_source = R"(
+    #version 450 core
+    out vec4 FragColor;
+    uniform sampler2D benchSource;
+    uniform ivec2 benchDirection;
+    uniform int benchRadius;
+    uniform float benchSigma;
+    void main() {
+        ivec2 position = ivec2(gl_FragCoord.xy);
+        ivec2 last = textureSize(benchSource, 0) - 1;
+        vec4 sum = vec4(0.0);
+        float total = 0.0;
+        for(int i = -benchRadius; i <= benchRadius; i++){
+            float weight = exp(-float(i * i) / (2.0 * benchSigma * benchSigma));
+            sum += texelFetch(benchSource, clamp(position + benchDirection * i, ivec2(0), last), 0) * weight;
+            total += weight;
+        }
+        FragColor = sum / total;
+    }
+)";
+
+static const char* bloom_prefilter_fragment_source = R"(
+    #version 450 core
+    in vec2 TexCoord;
+    out vec4 FragColor;
+    uniform sampler2D benchSource;
+    void main() {
+        vec3 color = texture(benchSource, TexCoord).rgb;
+        float brightness = max(color.r, max(color.g, color.b));
+        float soft = clamp(brightness - 0.5, 0.0, 1.0);
+        soft = soft * soft / 2.00001;
+        FragColor = vec4(color * max(soft, brightness - 1.0) / max(brightness, 0.00001), 1.0);
+    }
+)";
+
+static const char* bloom_downsample_fragment_source = R"(
+    #version 450 core
+    in vec2 TexCoord;
+    out vec4 FragColor;
+    uniform sampler2D benchSource;
+    void main() {
+        FragColor = texture(benchSource, TexCoord);
+    }
+)";
+
+// Added onto the level through blending
+static const char* bloom_upsample_fragment_source = R"(
+    #version 450 core
+    in vec2 TexCoord;
+    out vec4 FragColor;
+    uniform sampler2D benchSource;
+    void main() {
+        vec2 offset = 1.0 / vec2(textureSize(benchSource, 0));
+        vec3 sum = texture(benchSource, TexCoord).rgb * 4.0;
+        sum += (texture(benchSource, TexCoord + vec2(-offset.x, 0.0)).rgb + texture(benchSource, TexCoord + vec2(offset.x, 0.0)).rgb) * 2.0;
+        sum += (texture(benchSource, TexCoord + vec2(0.0, -offset.y)).rgb + texture(benchSource, TexCoord + vec2(0.0, offset.y)).rgb) * 2.0;
+        sum += texture(benchSource, TexCoord - offset).rgb + texture(benchSource, TexCoord + offset).rgb;
+        sum += texture(benchSource, TexCoord + vec2(-offset.x, offset.y)).rgb + texture(benchSource, TexCoord + vec2(offset.x, -offset.y)).rgb;
+        FragColor = vec4(sum / 16.0, 0.0);
+    }
+)";
+
+// Depth of a sloped, wavy floor from 2 to 80 units away, so it crosses most depth slices
+static const char* light_scene_fragment_source = R"(
+    #version 450 core
+    in vec2 TexCoord;
+    void main() {
+        float near_plane = 0.1;
+        float far_plane = 100.0;
+        float z = -(2.0 + 78.0 * TexCoord.y + 3.0 * sin(TexCoord.x * 20.0));
+        float ndc = (-(far_plane + near_plane) / (far_plane - near_plane) * z - 2.0 * far_plane * near_plane / (far_plane - near_plane)) / -z;
+        gl_FragDepth = ndc * 0.5 + 0.5;
+    }
+)";
+
+// Diffuse-less point light sum, every light or only those of the fragments cluster
+static const char* light_shading_fragment_source = R"(
+    #version 450 core
+    in vec2 TexCoord;
+    out vec4 FragColor;
+    #include "heptcore/clustered_lighting.glsl"
+    uniform sampler2D benchSource;
+    void main() {
+        float depth = texelFetch(benchSource, ivec2(gl_FragCoord.xy), 0).r;
+        float z = heptcoreLinearDepth(depth);
+        vec2 ndc = TexCoord * 2.0 - 1.0;
+        vec3 position = vec3(ndc.x * z / heptcoreClusterProjection[0][0], ndc.y * z / heptcoreClusterProjection[1][1], -z); // The view is identity
+
+        vec3 color = vec3(0.0);
+    #ifdef CLUSTERED
+        uvec2 range = heptcoreClusterLightRange(vec4(gl_FragCoord.xy, depth, 1.0));
+        for(uint i = 0u; i < range.y; i++){
+            HeptcorePointLight light = heptcoreClusterLight(range, i);
+    #else
+        for(uint i = 0u; i < heptcoreClusterGrid.w; i++){
+            HeptcorePointLight light = heptcoreLights[i];
+    #endif
+            color += light.color * light.intensity * heptcoreLightAttenuation(light, position);
+        }
+        FragColor = vec4(color, 1.0);
+    }
+)";
+
+static constexpr int image_size = 1024;
+static constexpr float blur_sigma = 4.0f;
+static constexpr int bloom_levels = 6;
+
+static Heptcore::ShaderProgram& fragmentProgram(Heptcore::ShaderVariantCache& cache, const char* fragment_source){
+    Heptcore::ShaderProgram& program = cache.getFromSources({{vertex_source, GL_VERTEX_SHADER}, {fragment_source, GL_FRAGMENT_SHADER}});
+    program.setSamplerSlot("benchSource", 0);
+    return program;
+}
+
+static std::unique_ptr<Heptcore::Framebuffer> colorTarget(int width, int height){
+    Heptcore::FramebufferSettings settings = {};
+    settings.depth = Heptcore::DEPTH_NONE;
+    return std::make_unique<Heptcore::Framebuffer>(width, height, std::vector<Heptcore::Framebuffer::FramebufferTexture>{{GL_RGBA16F, GL_RGBA, GL_FLOAT}}, settings);
+}
+
+/*
+    Fills an immutable RGBA16F texture with a gradient that has a few bright spots
+*/
+static void fillTestImage(Heptcore::Texture2D& texture, int levels){
+    texture.setup(image_size, image_size, levels, GL_RGBA16F);
+
+    std::vector<float> pixels((size_t) image_size * image_size * 4);
+    for(int y = 0; y < image_size; y++){
+        for(int x = 0; x < image_size; x++){
+            float* pixel = &pixels[((size_t) y * image_size + x) * 4];
+            float bright = (x % 128 < 4 && y % 128 < 4) ? 8.0f : 0.0f;
+            pixel[0] = (float) x / image_size + bright;
+            pixel[1] = (float) y / image_size + bright;
+            pixel[2] = bright;
+            pixel[3] = 1.0f;
+        }
+    }
+    texture.upload(0, image_size, image_size, pixels.data(), GL_RGBA, GL_FLOAT);
+}
+
+/*
+    Random lights inside the view frustum of a 60 degree camera looking down -z
+*/
+static std::vector<Heptcore::PointLight> randomLights(size_t count){
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<Heptcore::PointLight> lights(count);
+    for(auto& light: lights){
+        float z = -(2.0f + 78.0f * unit(random));
+        float extent = -z * std::tan(glm::radians(30.0f));
+        light.position = glm::vec3((unit(random) * 2.0f - 1.0f) * extent, (unit(random) * 2.0f - 1.0f) * extent, z);
+        light.radius = 1.0f + 3.0f * unit(random);
+        light.color = glm::vec3(unit(random), unit(random), unit(random));
+        light.intensity = 4.0f;
+    }
+    return lights;
+}
+
+void HeptcoreBench::registerComputeBenchmarks(Suite& suite){
+    constexpr int full_levels = 11; // 1024 down to 1
+
+    // A whole mip chain, the fragment version renders every level into its own framebuffer
+    suite.add("downsample/compute", [](Context& context){
+        Heptcore::ShaderVariantCache cache{};
+        Heptcore::Downsampler downsampler{cache};
+
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, full_levels);
+
+        context.parameter("size", image_size);
+        context.parameter("levels", full_levels);
+        context.measure([&]{
+            downsampler.generate(texture);
+        });
+    }, 30);
+
+    suite.add("downsample/fragment", [](Context& context){
+        Heptcore::ShaderVariantCache cache{};
+        Heptcore::ShaderProgram& program = fragmentProgram(cache, downsample_fragment_source);
+        Heptcore::FullscreenQuad quad{};
+
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, 1);
+
+        std::vector<std::unique_ptr<Heptcore::Framebuffer>> levels = {};
+        for(int level = 1; level < full_levels; level++) levels.push_back(colorTarget(image_size >> level, image_size >> level));
+
+        context.parameter("size", image_size);
+        context.parameter("levels", full_levels);
+        context.measure([&]{
+            program.use();
+            Heptcore::BindableTexture* source = &texture;
+            for(auto& level: levels){
+                level->bind();
+                glViewport(0, 0, level->getWidth(), level->getHeight());
+                source->bind(0);
+                quad.render();
+                source = &level->getTextures()[0];
+            }
+            Heptcore::Framebuffer::bindDefault();
+        });
+    }, 30);
+
+    suite.add("downsample/generate_mipmap", [](Context& context){
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, full_levels);
+
+        context.parameter("size", image_size);
+        context.parameter("levels", full_levels);
+        context.measure([&]{
+            glGenerateTextureMipmap(texture.getID());
+        });
+    }, 30);
+
+    suite.add("blur/compute", [](Context& context){
+        Heptcore::ShaderVariantCache cache{};
+        Heptcore::GaussianBlur blur{cache};
+
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, 1);
+
+        context.parameter("size", image_size);
+        context.parameter("sigma", (long long) blur_sigma);
+        context.measure([&]{
+            blur.apply(texture, blur_sigma);
+        });
+    }, 30);
+
+    suite.add("blur/fragment", [](Context& context){
+        Heptcore::ShaderVariantCache cache{};
+        Heptcore::ShaderProgram& program = fragmentProgram(cache, blur_fragment_source);
+        Heptcore::uniformLinker().ignore("benchDirection");
+        Heptcore::uniformLinker().ignore("benchRadius");
+        Heptcore::uniformLinker().ignore("benchSigma");
+        Heptcore::FullscreenQuad quad{};
+
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, 1);
+        auto ping = colorTarget(image_size, image_size);
+        auto pong = colorTarget(image_size, image_size);
+
+        int direction_location = program.getUniformLocation("benchDirection");
+        glUniform1i(program.getUniformLocation("benchRadius"), (int) (blur_sigma * 3.0f));
+        glUniform1f(program.getUniformLocation("benchSigma"), blur_sigma);
+
+        context.parameter("size", image_size);
+        context.parameter("sigma", (long long) blur_sigma);
+        context.measure([&]{
+            program.use();
+            glViewport(0, 0, image_size, image_size);
+
+            ping->bind();
+            glUniform2i(direction_location, 1, 0);
+            texture.bind(0);
+            quad.render();
+
+            pong->bind();
+            glUniform2i(direction_location, 0, 1);
+            ping->getTextures()[0].bind(0);
+            quad.render();
+
+            Heptcore::Framebuffer::bindDefault();
+        });
+    }, 30);
+
+    suite.add("bloom/compute", [](Context& context){
+        Heptcore::ShaderVariantCache cache{};
+        Heptcore::BloomPyramid bloom{cache, bloom_levels};
+
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, 1);
+
+        context.parameter("size", image_size);
+        context.parameter("levels", bloom_levels);
+        context.measure([&]{
+            bloom.render(texture, image_size, image_size);
+        });
+    }, 30);
+
+    suite.add("bloom/fragment", [](Context& context){
+        Heptcore::ShaderVariantCache cache{};
+        Heptcore::ShaderProgram& prefilter = fragmentProgram(cache, bloom_prefilter_fragment_source);
+        Heptcore::ShaderProgram& downsample = fragmentProgram(cache, bloom_downsample_fragment_source);
+        Heptcore::ShaderProgram& upsample = fragmentProgram(cache, bloom_upsample_fragment_source);
+        Heptcore::FullscreenQuad quad{};
+        Heptcore::Sampler& sampler = Heptcore::samplerCache().get(Heptcore::SamplerDescription::linear());
+
+        Heptcore::Texture2D texture{};
+        fillTestImage(texture, 1);
+
+        std::vector<std::unique_ptr<Heptcore::Framebuffer>> levels = {};
+        for(int level = 0; level < bloom_levels; level++) levels.push_back(colorTarget(image_size >> (level + 1), image_size >> (level + 1)));
+
+        auto pass = [&](Heptcore::ShaderProgram& program, Heptcore::BindableTexture& source, Heptcore::Framebuffer& target){
+            program.use();
+            target.bind();
+            glViewport(0, 0, target.getWidth(), target.getHeight());
+            source.bind(0, sampler);
+            quad.render();
+        };
+
+        context.parameter("size", image_size);
+        context.parameter("levels", bloom_levels);
+        context.measure([&]{
+            pass(prefilter, texture, *levels[0]);
+            for(int level = 1; level < bloom_levels; level++) pass(downsample, levels[level - 1]->getTextures()[0], *levels[level]);
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            for(int level = bloom_levels - 2; level >= 0; level--) pass(upsample, levels[level + 1]->getTextures()[0], *levels[level]);
+            glDisable(GL_BLEND);
+
+            Heptcore::Framebuffer::bindDefault();
+        });
+    }, 30);
+    // Shading 2000 point lights, every light per pixel against the clustered lists (culling included)
+    for(bool clustered: {true, false}){
+        suite.add(std::string("lights/") + (clustered ? "clustered" : "brute_force"), [clustered](Context& context){
+            constexpr int size = 512;
+            constexpr size_t light_count = 2000;
+
+            Heptcore::ShaderVariantCache cache{};
+            Heptcore::ClusteredLighting lighting{cache};
+            lighting.setLights(randomLights(light_count));
+
+            Heptcore::FramebufferSettings settings = {};
+            settings.depth = Heptcore::DEPTH_32F;
+            settings.depth_texture = true;
+            Heptcore::Framebuffer scene{size, size, {}, settings};
+            auto output = colorTarget(size, size);
+
+            Heptcore::FullscreenQuad quad{};
+            Heptcore::ShaderProgram& depth_program = cache.getFromSources({{vertex_source, GL_VERTEX_SHADER}, {light_scene_fragment_source, GL_FRAGMENT_SHADER}});
+            Heptcore::ShaderDefines defines = {};
+            if(clustered) defines["CLUSTERED"] = "";
+            Heptcore::ShaderProgram& shading = cache.getFromSources({{vertex_source, GL_VERTEX_SHADER}, {light_shading_fragment_source, GL_FRAGMENT_SHADER}}, defines);
+            shading.setSamplerSlot("benchSource", 0);
+
+            glm::mat4 view = glm::mat4(1.0f);
+            glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+
+            scene.bind();
+            glViewport(0, 0, size, size);
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_ALWAYS);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            depth_program.use();
+            quad.render();
+            glDepthFunc(GL_LESS);
+            glDisable(GL_DEPTH_TEST);
+
+            // Brute force only needs the parameters and the light buffer
+            lighting.update(scene, view, projection);
+
+            context.parameter("lights", (long long) light_count);
+            context.parameter("target", size);
+            context.parameter("clusters", lighting.getClusterCount());
+            context.measure([&]{
+                if(clustered) lighting.update(scene, view, projection);
+
+                output->bind();
+                glViewport(0, 0, size, size);
+                shading.use();
+                lighting.bind();
+                scene.getDepthTexture()->bind(0);
+                quad.render();
+                Heptcore::Framebuffer::bindDefault();
+            });
+        }, 30);
+    }
+}
@@ -0,0 +1,112 @@
+#include "bench.hpp"
+
+#include <random>
+
+using namespace HeptcoreBench;
+
+/*
+    Frustum culling a big static world, about 5% of it in view.
+    The linear loop is the baseline the Bvh has to beat.
+*/
+
+static constexpr size_t object_count = 300000;
+static constexpr float world_extent = 100.0f; // The world is -extent to extent on every axis, the camera sits in the middle
+
+static std::vector<Heptcore::Aabb> randomWorld(size_t count){
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(-world_extent, world_extent);
+    std::uniform_real_distribution<float> size(0.25f, 1.0f);
+
+    std::vector<Heptcore::Aabb> bounds(count);
+    for(auto& box: bounds){
+        glm::vec3 center = {position(random), position(random), position(random)};
+        glm::vec3 half = {size(random), size(random), size(random)};
+        box = {center - half, center + half};
+    }
+    return bounds;
+}
+
+static Heptcore::Frustum cameraFrustum(){
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, world_extent);
+    return Heptcore::Frustum::fromMatrix(projection); // Identity view, looking down -z from the origin
+}
+
+void HeptcoreBench::registerCullingBenchmarks(Suite& suite){
+    suite.add("culling/linear", [](Context& context){
+        auto bounds = randomWorld(object_count);
+        Heptcore::Frustum frustum = cameraFrustum();
+        std::vector<Heptcore::uint> visible = {};
+        visible.reserve(object_count);
+
+        context.parameter("objects", (long long) object_count);
+        context.work(object_count, "objects");
+        context.measure([&]{
+            visible.clear();
+            for(Heptcore::uint i = 0; i < bounds.size(); i++) if(frustum.intersects(bounds[i])) visible.push_back(i);
+        });
+        context.counter("visible", visible.size());
+    }, 30);
+
+    for(bool pooled: {false, true}){
+        suite.add(std::string("culling/bvh") + (pooled ? "_pooled" : ""), [pooled](Context& context){
+            auto bounds = randomWorld(object_count);
+            Heptcore::Frustum frustum = cameraFrustum();
+            std::vector<Heptcore::uint> visible = {};
+            visible.reserve(object_count);
+
+            Heptcore::Bvh bvh{};
+            bvh.build(bounds);
+            Heptcore::ThreadPool pool{pooled ? std::max(std::thread::hardware_concurrency(), 2u) - 1 : 0};
+
+            context.parameter("objects", (long long) object_count);
+            context.parameter("threads", (long long) pool.getThreadCount() + 1);
+            context.work(object_count, "objects");
+            context.measure([&]{
+                if(pooled) bvh.cull(frustum, visible, pool);
+                else bvh.cull(frustum, visible);
+            });
+            context.counter("visible", visible.size());
+            context.counter("nodes", bvh.getNodeCount());
+            context.counter("sah_cost", bvh.getSahCost());
+        }, 30);
+    }
+
+    // A tenth of the world moves every frame
+    suite.add("culling/bvh_refit", [](Context& context){
+        auto bounds = randomWorld(object_count);
+        Heptcore::Bvh bvh{};
+        bvh.build(bounds);
+
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float> offset(-0.1f, 0.1f);
+        constexpr size_t moving = object_count / 10;
+
+        context.parameter("objects", (long long) object_count);
+        context.parameter("moving", (long long) moving);
+        context.work(moving, "objects");
+        context.measure([&]{
+            bvh.refit();
+        }, [&]{
+            for(Heptcore::uint i = 0; i < object_count; i += object_count / moving){
+                glm::vec3 step = {offset(random), offset(random), offset(random)};
+                bounds[i].min = bounds[i].min + step;
+                bounds[i].max = bounds[i].max + step;
+                bvh.update(i, bounds[i]);
+            }
+        });
+        context.counter("sah_cost", bvh.getSahCost());
+    }, 30);
+
+    suite.add("culling/bvh_build", [](Context& context){
+        auto bounds = randomWorld(object_count);
+        Heptcore::Bvh bvh{};
+
+        context.parameter("objects", (long long) object_count);
+        context.work(object_count, "objects");
+        context.measure([&]{
+            bvh.build(bounds);
+        });
+        context.counter("nodes", bvh.getNodeCount());
+        context.counter("sah_cost", bvh.getSahCost());
+    }, 5);
+}
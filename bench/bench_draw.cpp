@@ -0,0 +1,226 @@
+#include "bench.hpp"
+
+#include <memory>
+
+using namespace HeptcoreBench;
+
+static const char* vertex_source = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    out vec2 TexCoord;
+    void main() {
+        gl_Position = vec4(aPos, 0.0, 1.0);
+        TexCoord = aTexCoord;
+    }
+)";
+
+static const char* fragment_source = R"(
+    #version 330 core
+    out vec4 FragColor;
+    in vec2 TexCoord;
+    uniform sampler2D benchTexture;
+    uniform vec3 bench_tint;
+    void main() {
+        FragColor = texture(benchTexture, TexCoord) * vec4(bench_tint, 1.0);
+    }
+)";
+
+static constexpr int target_size = 64;
+
+void HeptcoreBench::registerDrawBenchmarks(Suite& suite){
+    for(size_t draws: {100ul, 1000ul}){
+        suite.add("draw_quad/" + std::to_string(draws), [draws](Context& context){
+            Heptcore::Framebuffer framebuffer{target_size, target_size, {{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}}};
+
+            Heptcore::ShaderProgram program{};
+            program.addShaderSource(vertex_source, GL_VERTEX_SHADER);
+            program.addShaderSource(fragment_source, GL_FRAGMENT_SHADER);
+            program.compile();
+
+            Heptcore::FullscreenQuad quad{};
+
+            framebuffer.bind();
+            glViewport(0, 0, target_size, target_size);
+            program.use();
+
+            context.parameter("draws", (long long) draws);
+            context.parameter("target", target_size);
+            context.work((double) draws, "draws");
+            context.measure([&]{
+                for(size_t i = 0; i < draws; i++) quad.render();
+            });
+
+            framebuffer.unbind();
+        }, 30);
+    }
+
+    // Offscreen pass at 0 and 4 samples, the multisampled one includes the resolve
+    for(int samples: {0, 4}){
+        suite.add("framebuffer_msaa/" + std::to_string(samples), [samples](Context& context){
+            constexpr int size = 512;
+
+            Heptcore::FramebufferSettings settings = {};
+            settings.samples = samples;
+            Heptcore::Framebuffer framebuffer{size, size, {{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}}, settings};
+
+            Heptcore::ShaderProgram program{};
+            program.addShaderSource(vertex_source, GL_VERTEX_SHADER);
+            program.addShaderSource(fragment_source, GL_FRAGMENT_SHADER);
+            program.compile();
+
+            Heptcore::FullscreenQuad quad{};
+
+            context.parameter("samples", (long long) samples);
+            context.parameter("target", size);
+            context.measure([&]{
+                framebuffer.bind();
+                glViewport(0, 0, size, size);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                program.use();
+                for(int i = 0; i < 10; i++) quad.render();
+                framebuffer.resolve();
+                framebuffer.unbind();
+            });
+        }, 30);
+    }
+
+    // Four per pixel effects fused into one pass against one pass (and one full screen round trip) each
+    for(bool fused: {true, false}){
+        suite.add(std::string("post_chain/") + (fused ? "fused" : "separate"), [fused](Context& context){
+            constexpr int size = 1024;
+
+            Heptcore::ShaderVariantCache cache{};
+            Heptcore::FramebufferSettings settings = {};
+            settings.depth = Heptcore::DEPTH_NONE;
+            Heptcore::Framebuffer scene{size, size, {{GL_RGBA16F, GL_RGBA, GL_FLOAT}}, settings};
+            Heptcore::Framebuffer output{size, size, {{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}}, settings};
+
+            std::vector<Heptcore::PostEffect> effects = {
+                Heptcore::PostEffect::toneMapACES(),
+                Heptcore::PostEffect::vignette(0.4f),
+                Heptcore::PostEffect::vignette(0.2f),
+                Heptcore::PostEffect::gamma(2.2f)
+            };
+
+            std::vector<std::unique_ptr<Heptcore::PostProcessChain>> chains = {};
+            if(fused){
+                chains.push_back(std::make_unique<Heptcore::PostProcessChain>(cache));
+                for(auto& effect: effects) chains.back()->add(effect);
+            }
+            else{
+                for(auto& effect: effects){
+                    chains.push_back(std::make_unique<Heptcore::PostProcessChain>(cache));
+                    chains.back()->add(effect);
+                }
+            }
+
+            Heptcore::Framebuffer ping{size, size, {{GL_RGBA16F, GL_RGBA, GL_FLOAT}}, settings};
+            Heptcore::Framebuffer pong{size, size, {{GL_RGBA16F, GL_RGBA, GL_FLOAT}}, settings};
+
+            size_t passes = 0;
+            for(auto& chain: chains) passes += chain->getPasses().size();
+
+            context.parameter("passes", (long long) passes);
+            context.parameter("target", size);
+            context.measure([&]{
+                Heptcore::BindableTexture* source = &scene.getTextures()[0];
+                for(size_t i = 0; i < chains.size(); i++){
+                    bool last = i + 1 == chains.size();
+                    Heptcore::Framebuffer* target = last ? &output : (i % 2 == 0 ? &ping : &pong);
+                    chains[i]->render(*source, size, size, target);
+                    source = &target->getTextures()[0];
+                }
+            });
+
+            Heptcore::Framebuffer::bindDefault();
+        }, 30);
+    }
+
+    // Same kind of quads as draw_quad but through SpriteBatch, one draw per bin instead of per sprite
+    for(size_t sprites: {1000ul, 100000ul}){
+        suite.add("sprite_batch/" + std::to_string(sprites), [sprites](Context& context){
+            Heptcore::Framebuffer framebuffer{target_size, target_size, {{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}}};
+
+            Heptcore::TextureArray2D texture{};
+            texture.setup(1, 1, 4);
+
+            Heptcore::SpriteBatch batch{};
+
+            framebuffer.bind();
+            glViewport(0, 0, target_size, target_size);
+
+            context.parameter("sprites", (long long) sprites);
+            context.parameter("target", target_size);
+            context.work((double) sprites, "sprites");
+            context.measure([&]{
+                batch.begin(texture, glm::mat4(1.0f));
+                for(size_t i = 0; i < sprites; i++){
+                    Heptcore::Sprite sprite = {};
+                    sprite.position = glm::vec2((float) (i % 100) / 50.0f - 1.0f, (float) (i / 100 % 100) / 50.0f - 1.0f);
+                    sprite.size = glm::vec2(0.02f);
+                    sprite.rotation = (float) i;
+                    sprite.texture_layer = (int) (i % 4);
+                    sprite.layer = (int) (i % 3);
+                    batch.draw(sprite);
+                }
+                batch.end();
+            });
+
+            framebuffer.unbind();
+        }, 30);
+    }
+
+    // A whole small frame, offscreen pass with per object state changes and a composite
+    suite.add("frame/200_objects", [](Context& context){
+        constexpr size_t objects = 200;
+        constexpr int texture_count = 8;
+
+        Heptcore::Uniform<glm::vec3> tint{"bench_tint"};
+
+        Heptcore::Framebuffer framebuffer{target_size, target_size, {{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}}};
+
+        Heptcore::ShaderProgram program{};
+        program.addShaderSource(vertex_source, GL_VERTEX_SHADER);
+        program.addShaderSource(fragment_source, GL_FRAGMENT_SHADER);
+        program.compile();
+        program.setSamplerSlot("benchTexture", 0);
+
+        std::vector<unsigned char> pixel = {200, 100, 50, 255};
+        std::vector<std::unique_ptr<Heptcore::Texture2D>> textures = {};
+        for(int i = 0; i < texture_count; i++) textures.push_back(std::make_unique<Heptcore::Texture2D>(pixel.data(), 1, 1));
+
+        Heptcore::FullscreenQuad quad{};
+
+        Heptcore::RenderStatistics last_frame = {};
+        Heptcore::renderStatistics.endFrame();
+
+        context.parameter("objects", (long long) objects);
+        context.measure([&]{
+            framebuffer.bind();
+            glViewport(0, 0, target_size, target_size);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            for(size_t i = 0; i < objects; i++){
+                tint = glm::vec3((float) i / objects);
+                textures[i % texture_count]->bind(0);
+                program.updateUniforms();
+                quad.render();
+            }
+
+            framebuffer.unbind();
+            framebuffer.bindTextures();
+            quad.render();
+
+            Heptcore::renderStatistics.endFrame();
+            last_frame = Heptcore::renderStatistics.getLastFrame();
+        });
+
+#if HEPTCORE_STATS
+        context.counter("draw_calls", (double) last_frame.draw_calls);
+        context.counter("texture_binds", (double) last_frame.texture_binds);
+        context.counter("redundant_binds_skipped", (double) last_frame.redundant_binds_skipped);
+        context.counter("uniform_uploads", (double) last_frame.uniform_uploads);
+#endif
+    }, 50);
+}
@@ -0,0 +1,86 @@
+#include "bench.hpp"
+
+#include <memory>
+
+using namespace HeptcoreBench;
+
+static const char* vertex_source = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    void main() {
+        gl_Position = vec4(aPos, 0.0, 1.0);
+    }
+)";
+
+static const char* fragment_source = R"(
+    #version 330 core
+    out vec4 FragColor;
+    uniform vec3 farm_tint;
+    void main() {
+        FragColor = vec4(farm_tint, 1.0);
+    }
+)";
+
+static constexpr int target_size = 64;
+static constexpr size_t jobs_per_iteration = 16;
+
+/*
+    Jobs alternate between two tints on two contexts, every image has to come back in its own tint.
+    With one program shared by both contexts the uniform of one job can land in the draw of the other,
+    counted in wrong_images. Per context programs have to keep that at 0.
+*/
+void HeptcoreBench::registerFarmBenchmarks(Suite& suite, Heptcore::Window& window){
+    for(bool shared: {true, false}){
+        suite.add(std::string("farm_uniforms/") + (shared ? "shared_program" : "per_context_program"), [&window, shared](Context& context){
+            Heptcore::RenderFarmSettings settings = {};
+            settings.contexts = 2;
+            settings.depth = Heptcore::DEPTH_NONE;
+            Heptcore::RenderFarm farm{window, settings};
+
+            std::unique_ptr<Heptcore::ShaderProgram> shared_program = nullptr;
+            farm.load([&]{
+                shared_program = std::make_unique<Heptcore::ShaderProgram>();
+                shared_program->addShaderSource(vertex_source, GL_VERTEX_SHADER);
+                shared_program->addShaderSource(fragment_source, GL_FRAGMENT_SHADER);
+                shared_program->compile();
+            });
+
+            const glm::vec3 tints[2] = {{1, 0, 0}, {0, 0, 1}};
+            size_t wrong_images = 0;
+
+            auto renderBatch = [&]{
+                std::vector<std::pair<std::shared_ptr<Heptcore::RenderJob>, size_t>> jobs = {};
+                for(size_t i = 0; i < jobs_per_iteration; i++){
+                    glm::vec3 tint = tints[i % 2];
+                    jobs.push_back({farm.submit(target_size, target_size, [&, tint](Heptcore::RenderFarmContext& farm_context){
+                        Heptcore::ShaderProgram& program = shared ? *shared_program :
+                            farm_context.getPrograms().getFromSources({{vertex_source, GL_VERTEX_SHADER}, {fragment_source, GL_FRAGMENT_SHADER}});
+
+                        auto& uniform = farm_context.getLocal<Heptcore::Uniform<glm::vec3>>(std::string("farm_tint"));
+                        uniform = tint;
+
+                        program.use();
+                        program.updateUniforms();
+                        farm_context.getLocal<Heptcore::FullscreenQuad>().render();
+                    }), i % 2});
+                }
+
+                for(auto& [job, tint]: jobs){
+                    auto& pixels = job->getImage().pixels;
+                    size_t middle = ((size_t) target_size / 2 * target_size + target_size / 2) * 4;
+                    bool red = pixels[middle] > 128 && pixels[middle + 2] < 128;
+                    if(red != (tint == 0)) wrong_images++;
+                }
+            };
+
+            context.parameter("contexts", (long long) settings.contexts);
+            context.parameter("jobs", (long long) jobs_per_iteration);
+            context.work((double) jobs_per_iteration, "images");
+            context.measure(renderBatch);
+            context.counter("wrong_images", (double) wrong_images);
+
+            farm.load([&]{ shared_program = nullptr; });
+        }, 20);
+    }
+}
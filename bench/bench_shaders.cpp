@@ -0,0 +1,67 @@
+#include "bench.hpp"
+
+#include <memory>
+
+using namespace HeptcoreBench;
+
+static const char* vertex_source = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    out vec2 TexCoord;
+    void main() {
+        gl_Position = vec4(aPos, 0.0, 1.0);
+        TexCoord = aTexCoord;
+    }
+)";
+
+static std::string uniformFragmentSource(size_t uniform_count){
+    std::string source = "#version 330 core\nout vec4 FragColor;\nin vec2 TexCoord;\n";
+    for(size_t i = 0; i < uniform_count; i++) source += "uniform vec3 bench_uniform_" + std::to_string(i) + ";\n";
+
+    // Every uniform has to be used or the compiler drops it
+    source += "void main() {\n    vec3 color = vec3(TexCoord, 0.0);\n";
+    for(size_t i = 0; i < uniform_count; i++) source += "    color += bench_uniform_" + std::to_string(i) + ";\n";
+    source += "    FragColor = vec4(color, 1.0);\n}\n";
+
+    return source;
+}
+
+void HeptcoreBench::registerShaderBenchmarks(Suite& suite){
+    for(size_t uniform_count: {8ul, 64ul}){
+        suite.add("program_link/" + std::to_string(uniform_count), [uniform_count](Context& context){
+            std::string fragment_source = uniformFragmentSource(uniform_count);
+            std::unique_ptr<Heptcore::ShaderProgram> program = nullptr;
+
+            context.parameter("uniforms", (long long) uniform_count);
+            context.measure(
+                [&]{
+                    program = std::make_unique<Heptcore::ShaderProgram>();
+                    program->addShaderSource(vertex_source, GL_VERTEX_SHADER);
+                    program->addShaderSource(fragment_source, GL_FRAGMENT_SHADER);
+                    program->compile();
+                },
+                [&]{ program = nullptr; }
+            );
+        }, 20);
+    }
+
+    for(size_t uniform_count: {1ul, 16ul, 64ul, 128ul}){
+        suite.add("update_uniforms/" + std::to_string(uniform_count), [uniform_count](Context& context){
+            std::vector<std::unique_ptr<Heptcore::Uniform<glm::vec3>>> uniforms = {};
+            for(size_t i = 0; i < uniform_count; i++){
+                uniforms.push_back(std::make_unique<Heptcore::Uniform<glm::vec3>>("bench_uniform_" + std::to_string(i)));
+                uniforms.back()->setValue(glm::vec3(0.001f * i));
+            }
+
+            Heptcore::ShaderProgram program{};
+            program.addShaderSource(vertex_source, GL_VERTEX_SHADER);
+            program.addShaderSource(uniformFragmentSource(uniform_count), GL_FRAGMENT_SHADER);
+            program.compile();
+
+            context.parameter("uniforms", (long long) uniform_count);
+            context.work((double) uniform_count, "uniforms");
+            context.measureBatched(100, [&]{ program.updateUniforms(); });
+        }, 50);
+    }
+}
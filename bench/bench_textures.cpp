@@ -0,0 +1,87 @@
+#include "bench.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <random>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+using namespace HeptcoreBench;
+
+/*
+    Writes a deterministic noisy image so png compression has realistic work to do
+*/
+static std::string writeTestImage(int size){
+    std::vector<unsigned char> pixels((size_t) size * size * 4);
+
+    std::mt19937 random(size);
+    for(int y = 0; y < size; y++){
+        for(int x = 0; x < size; x++){
+            unsigned char* pixel = &pixels[((size_t) y * size + x) * 4];
+            pixel[0] = (unsigned char) (x * 255 / size);
+            pixel[1] = (unsigned char) (y * 255 / size);
+            pixel[2] = (unsigned char) (random() & 0x3F);
+            pixel[3] = 255;
+        }
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / ("heptcore_bench_" + std::to_string(size) + ".png")).string();
+    if(!stbi_write_png(path.c_str(), size, size, 4, pixels.data(), size * 4)) throw std::runtime_error("Failed to write test image.");
+
+    return path;
+}
+
+void HeptcoreBench::registerTextureBenchmarks(Suite& suite){
+    for(int size: {256, 1024, 2048}){
+        suite.add("texture_load/" + std::to_string(size), [size](Context& context){
+            std::string path = writeTestImage(size);
+            std::unique_ptr<Heptcore::Texture2D> texture = nullptr;
+
+            context.parameter("size", size);
+            context.work((double) size * size * 4, "bytes");
+            context.measure(
+                [&]{ texture = std::make_unique<Heptcore::Texture2D>(path.c_str()); },
+                [&]{ texture = nullptr; }
+            );
+
+            texture = nullptr;
+            std::filesystem::remove(path);
+        }, size >= 2048 ? 5 : 20);
+    }
+
+    for(int texture_count: {4, 32}){
+        suite.add("texture_bind/" + std::to_string(texture_count), [texture_count](Context& context){
+            constexpr int units = 8;
+            constexpr size_t binds = 1000;
+
+            std::vector<unsigned char> pixel = {255, 255, 255, 255};
+            std::vector<std::unique_ptr<Heptcore::Texture2D>> textures = {};
+            for(int i = 0; i < texture_count; i++) textures.push_back(std::make_unique<Heptcore::Texture2D>(pixel.data(), 1, 1));
+
+            // Skewed towards a few hot textures like a real frame
+            std::mt19937 random(42);
+            std::vector<std::pair<int, int>> sequence(binds);
+            for(auto& [texture, unit]: sequence){
+                texture = std::min<int>(texture_count - 1, (int) (random() % texture_count) * (int) (random() % 2));
+                unit = (int) (random() % units);
+            }
+
+            Heptcore::renderStatistics.endFrame();
+
+            context.parameter("textures", texture_count);
+            context.parameter("units", units);
+            context.work((double) binds, "binds");
+            context.measure([&]{
+                for(auto& [texture, unit]: sequence) textures[texture]->bind(unit);
+            });
+
+#if HEPTCORE_STATS
+            auto& statistics = Heptcore::renderStatistics.counters();
+            double total = (double) (statistics.texture_binds + statistics.redundant_binds_skipped);
+            if(total > 0) context.counter("bind_cache_hit_rate", statistics.redundant_binds_skipped / total);
+#endif
+            Heptcore::renderStatistics.endFrame();
+        }, 50);
+    }
+}
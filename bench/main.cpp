@@ -0,0 +1,208 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+/*
+    heptcore_bench [--filter substring] [--output results.json] [--warmup N] [--scale F]
+
+    Runs headless (hidden window), on a machine without a gpu use Mesa llvmpipe:
+        LIBGL_ALWAYS_SOFTWARE=1 xvfb-run ./heptcore_bench
+*/
+
+using namespace HeptcoreBench;
+
+static double nanoseconds(std::chrono::steady_clock::duration duration){
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+static void summarize(Result& result, std::vector<double>& samples){
+    if(samples.empty()) return;
+
+    std::sort(samples.begin(), samples.end());
+    result.iterations = samples.size();
+    result.min = samples.front();
+    result.max = samples.back();
+    result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+    size_t middle = samples.size() / 2;
+    result.median = samples.size() % 2 == 0 ? (samples[middle - 1] + samples[middle]) / 2.0 : samples[middle];
+}
+
+void Context::measure(const std::function<void()>& function, const std::function<void()>& setup){
+    std::vector<double> samples = {};
+    samples.reserve(iterations);
+
+    for(size_t i = 0; i < warmup + iterations; i++){
+        if(setup) setup();
+        glFinish();
+
+        auto start = std::chrono::steady_clock::now();
+        function();
+        glFinish();
+        auto end = std::chrono::steady_clock::now();
+
+        if(i >= warmup) samples.push_back(nanoseconds(end - start));
+    }
+
+    summarize(result, samples);
+}
+
+void Context::measureBatched(size_t batch, const std::function<void()>& function){
+    std::vector<double> samples = {};
+    samples.reserve(iterations);
+
+    for(size_t i = 0; i < warmup + iterations; i++){
+        glFinish();
+
+        auto start = std::chrono::steady_clock::now();
+        for(size_t j = 0; j < batch; j++) function();
+        glFinish();
+        auto end = std::chrono::steady_clock::now();
+
+        if(i >= warmup) samples.push_back(nanoseconds(end - start) / batch);
+    }
+
+    summarize(result, samples);
+}
+
+void Suite::add(const std::string& name, Benchmark function, size_t iterations){
+    entries.push_back({name, function, iterations});
+}
+
+std::vector<Result> Suite::run(const std::string& filter, size_t warmup, double iteration_scale){
+    std::vector<Result> results = {};
+
+    for(auto& entry: entries){
+        if(filter != "" && entry.name.find(filter) == std::string::npos) continue;
+
+        Result result = {};
+        result.name = entry.name;
+
+        size_t iterations = std::max<size_t>(1, (size_t) (entry.iterations * iteration_scale));
+        Context context(result, warmup, iterations);
+
+        std::cerr << "Running " << entry.name << "..." << std::endl;
+        try{
+            entry.function(context);
+        }
+        catch(const std::exception& exception){
+            std::cerr << "Benchmark " << entry.name << " failed: " << exception.what() << std::endl;
+            continue;
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+static std::string escape(const std::string& text){
+    std::string escaped = "";
+    for(char character: text){
+        if(character == '"' || character == '\\') escaped += '\\';
+        if(character == '\n'){
+            escaped += "\\n";
+            continue;
+        }
+        escaped += character;
+    }
+    return escaped;
+}
+
+void Suite::writeJSON(std::ostream& stream, const std::vector<Result>& results){
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+    stream << "{\n";
+    stream << "  \"renderer\": \"" << escape(renderer ? renderer : "") << "\",\n";
+    stream << "  \"gl_version\": \"" << escape(version ? version : "") << "\",\n";
+    stream << "  \"stats_enabled\": " << (HEPTCORE_STATS ? "true" : "false") << ",\n";
+    stream << "  \"benchmarks\": [\n";
+
+    for(size_t i = 0; i < results.size(); i++){
+        auto& result = results[i];
+
+        stream << "    {\n";
+        stream << "      \"name\": \"" << escape(result.name) << "\",\n";
+
+        stream << "      \"parameters\": {";
+        size_t p = 0;
+        for(auto& [name, value]: result.parameters) stream << (p++ ? ", " : "") << "\"" << escape(name) << "\": \"" << escape(value) << "\"";
+        stream << "},\n";
+
+        stream << "      \"iterations\": " << result.iterations << ",\n";
+        stream << "      \"median_ns\": " << result.median << ",\n";
+        stream << "      \"mean_ns\": " << result.mean << ",\n";
+        stream << "      \"min_ns\": " << result.min << ",\n";
+        stream << "      \"max_ns\": " << result.max << ",\n";
+
+        if(result.work_unit != "" && result.median > 0){
+            stream << "      \"throughput\": " << (result.work / (result.median / 1e9)) << ",\n";
+            stream << "      \"throughput_unit\": \"" << escape(result.work_unit) << "/s\",\n";
+        }
+
+        stream << "      \"counters\": {";
+        size_t c = 0;
+        for(auto& [name, value]: result.counters) stream << (c++ ? ", " : "") << "\"" << escape(name) << "\": " << value;
+        stream << "}\n";
+
+        stream << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    stream << "  ]\n";
+    stream << "}\n";
+}
+
+int main(int argc, char** argv){
+    std::string filter = "";
+    std::string output = "";
+    size_t warmup = 5;
+    double scale = 1.0;
+
+    for(int i = 1; i < argc; i++){
+        std::string argument = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(argument == "--filter" && has_value) filter = argv[++i];
+        else if(argument == "--output" && has_value) output = argv[++i];
+        else if(argument == "--warmup" && has_value) warmup = std::stoul(argv[++i]);
+        else if(argument == "--scale" && has_value) scale = std::stod(argv[++i]);
+        else{
+            std::cerr << "Usage: " << argv[0] << " [--filter substring] [--output results.json] [--warmup N] [--scale F]" << std::endl;
+            return 1;
+        }
+    }
+
+    Heptcore::WindowSettings settings = {};
+    settings.visible = false;
+    settings.samples = 0;
+    settings.version_minor = 5;
+
+    Heptcore::Window window{256, 256, "heptcore_bench", settings};
+
+    Suite suite = {};
+    registerBufferBenchmarks(suite);
+    registerShaderBenchmarks(suite);
+    registerTextureBenchmarks(suite);
+    registerDrawBenchmarks(suite);
+    registerComputeBenchmarks(suite);
+    registerCullingBenchmarks(suite);
+    registerFarmBenchmarks(suite, window);
+
+    std::vector<Result> results = suite.run(filter, warmup, scale);
+
+    if(output != ""){
+        std::ofstream file(output);
+        if(!file.is_open()){
+            std::cerr << "Failed to open output file: " << output << std::endl;
+            return 1;
+        }
+        Suite::writeJSON(file, results);
+    }
+    else Suite::writeJSON(std::cout, results);
+
+    return 0;
+}
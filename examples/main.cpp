@@ -46,20 +46,22 @@ int main() {
 
     Heptcore::Texture2D texture{reinterpret_cast<unsigned char*>(pixels), WIDTH, HEIGHT};
     
-    texture.bind(0);
     program.setSamplerSlot("screenTexture", 0);
 
     Heptcore::FullscreenQuad quad{};
 
-    // Main loop
-    while (!window.shouldClose()) {
+    // Events stay on this thread, frames are rendered on a thread that owns the context
+    window.run([&](Heptcore::Window& window){
+        Heptcore::InputState& input = window.sampleInput();
+        if(input.takeResize()) glViewport(0, 0, input.getFramebufferSize().x, input.getFramebufferSize().y);
+        if(input.isKeyDown(GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(window.getHandle(), GLFW_TRUE);
+
         glClear(GL_COLOR_BUFFER_BIT);
 
+        program.use();
+        texture.bind(0);
         quad.render();
-
-        window.swapBuffers();
-        window.pollEvents();
-    }
+    });
 
     return 0;
 }
\ No newline at end of file
@@ -1,10 +1,39 @@
 #pragma once
 
 #include <core.hpp>
+#include <input.hpp>
+#include <mesh/mesh.hpp>
+#include <mesh/mesh_file.hpp>
+#include <mesh/optimizer.hpp>
 #include <opengl/buffer.hpp>
+#include <opengl/capture.hpp>
+#include <opengl/clustered_lighting.hpp>
+#include <opengl/context_state.hpp>
+#include <opengl/debug.hpp>
 #include <opengl/framebuffer.hpp>
+#include <opengl/gpu_vector.hpp>
+#include <opengl/image_kernels.hpp>
+#include <opengl/memory.hpp>
+#include <opengl/post_process.hpp>
 #include <opengl/quad.hpp>
+#include <opengl/resource_pool.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/shader_preprocessor.hpp>
+#include <opengl/shader_variants.hpp>
 #include <opengl/shaders.hpp>
+#include <opengl/sprite_batch.hpp>
+#include <opengl/stats.hpp>
+#include <opengl/streaming_texture.hpp>
 #include <opengl/texture.hpp>
+#include <opengl/texture_atlas.hpp>
+#include <opengl/texture_cache.hpp>
 #include <opengl/vao.hpp>
+#include <render_farm.hpp>
+#include <scene/bvh.hpp>
+#include <scene/frustum.hpp>
+#include <spsc_queue.hpp>
+#include <text/font.hpp>
+#include <text/text_renderer.hpp>
+#include <thread_pool.hpp>
 #include <window.hpp>
+#include <worker.hpp>
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <array>
+#include <glm/glm.hpp>
+
+namespace Heptcore
+{
+    enum InputEventType{
+        INPUT_KEY = 0,
+        INPUT_CHARACTER = 1,
+        INPUT_MOUSE_BUTTON = 2,
+        INPUT_CURSOR = 3,
+        INPUT_SCROLL = 4,
+        INPUT_FRAMEBUFFER_SIZE = 5,
+        INPUT_FOCUS = 6
+    };
+
+    /*
+        One glfw callback, recorded on the event thread
+    */
+    struct InputEvent{
+        InputEventType type = INPUT_KEY;
+        double time = 0.0; // glfwGetTime() when glfw delivered the event
+        int code = 0; // Key, mouse button or character codepoint
+        int scancode = 0;
+        int action = 0; // GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT, focus is GLFW_TRUE or GLFW_FALSE
+        int mods = 0;
+        glm::dvec2 value = glm::dvec2(0.0); // Cursor position, scroll offset or framebuffer size
+    };
+
+    /*
+        Input as of the last event applied to it
+    */
+    class InputState{
+        private:
+            std::array<bool, GLFW_KEY_LAST + 1> keys = {};
+            std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> buttons = {};
+            glm::dvec2 cursor = glm::dvec2(0.0);
+            glm::dvec2 scroll = glm::dvec2(0.0); // Summed up until takeScroll
+            glm::ivec2 framebuffer_size = glm::ivec2(0, 0);
+            bool resized = false;
+            bool focused = true;
+            double latest_event_time = 0.0;
+        public:
+            void apply(const InputEvent& event){
+                latest_event_time = event.time;
+
+                switch(event.type){
+                    case INPUT_KEY:
+                        if(event.code >= 0 && event.code <= GLFW_KEY_LAST) keys[event.code] = event.action != GLFW_RELEASE;
+                        break;
+                    case INPUT_MOUSE_BUTTON:
+                        if(event.code >= 0 && event.code <= GLFW_MOUSE_BUTTON_LAST) buttons[event.code] = event.action != GLFW_RELEASE;
+                        break;
+                    case INPUT_CURSOR:
+                        cursor = event.value;
+                        break;
+                    case INPUT_SCROLL:
+                        scroll.x += event.value.x;
+                        scroll.y += event.value.y;
+                        break;
+                    case INPUT_FRAMEBUFFER_SIZE:
+                        framebuffer_size = glm::ivec2((int) event.value.x, (int) event.value.y);
+                        resized = true;
+                        break;
+                    case INPUT_FOCUS:
+                        focused = event.action == GLFW_TRUE;
+                        // Releases arent reported to unfocused windows
+                        if(!focused){
+                            keys.fill(false);
+                            buttons.fill(false);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            bool isKeyDown(int key) const {return key >= 0 && key <= GLFW_KEY_LAST && keys[key];}
+            bool isButtonDown(int button) const {return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && buttons[button];}
+            glm::dvec2 getCursor() const {return cursor;}
+            /*
+                Scrolling since the last call
+            */
+            glm::dvec2 takeScroll(){
+                glm::dvec2 taken = scroll;
+                scroll = glm::dvec2(0.0);
+                return taken;
+            }
+
+            glm::ivec2 getFramebufferSize() const {return framebuffer_size;}
+            /*
+                True once after the framebuffer size changed, time to update the viewport and resize framebuffers
+            */
+            bool takeResize(){
+                bool was_resized = resized;
+                resized = false;
+                return was_resized;
+            }
+
+            bool isFocused() const {return focused;}
+            /*
+                glfwGetTime() of the newest event applied, glfwGetTime() minus this at submission is how old that input is
+            */
+            double getLatestEventTime() const {return latest_event_time;}
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <core.hpp>
+
+namespace Heptcore{
+    /*
+        Cpu side indexed triangle mesh.
+
+        Vertices are interleaved floats laid out the same way as a VertexFormat,
+        vertex_size is the format's getVertexSize() and position_offset is where
+        the three position floats start inside a single vertex.
+    */
+    struct Mesh{
+        std::vector<float> vertices = {};
+        std::vector<uint> indices = {};
+
+        uint vertex_size = 3;
+        uint position_offset = 0;
+
+        size_t vertexCount() const { return vertex_size == 0 ? 0 : vertices.size() / vertex_size; }
+        size_t triangleCount() const { return indices.size() / 3; }
+
+        glm::vec3 position(uint vertex) const {
+            const float* data = vertices.data() + vertex * vertex_size + position_offset;
+            return {data[0], data[1], data[2]};
+        }
+    };
+
+    /*
+        A small cluster of triangles, indices into MeshletData::vertices and MeshletData::triangles.
+
+        The cone is used for backface culling of the whole cluster:
+            dot(normalize(cone_apex - camera_position), cone_axis) > cone_cutoff  => cluster is invisible
+
+        A cone_cutoff of 1 means the cluster cannot be culled this way.
+    */
+    struct Meshlet{
+        uint vertex_offset = 0;
+        uint triangle_offset = 0;
+        uint vertex_count = 0;
+        uint triangle_count = 0;
+
+        glm::vec3 center = {0,0,0};
+        float radius = 0;
+
+        glm::vec3 cone_apex = {0,0,0};
+        glm::vec3 cone_axis = {0,0,0};
+        float cone_cutoff = 1.0f;
+    };
+
+    struct MeshletData{
+        std::vector<Meshlet> meshlets = {};
+        std::vector<uint> vertices = {};      // Indices into the mesh vertices
+        std::vector<uint8_t> triangles = {};  // Three local vertex indices per triangle
+    };
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <mesh/mesh.hpp>
+#include <opengl/buffer.hpp>
+#include <opengl/vao.hpp>
+
+namespace Heptcore{
+    /*
+        Heptcore binary mesh (.hmesh)
+
+        [MeshFileHeader][MeshFileStream * stream_count][vertex stream 0]...[vertex stream n][indices]
+        [Meshlet * meshlet_count][meshlet vertices][meshlet triangles]   (only if meshlet_count > 0)
+
+        Every section starts on a mesh_file_alignment boundary so it can be used straight
+        out of a memory mapping. Vertex streams are interleaved floats in their VertexFormat layout,
+        indices and meshlet vertices are 32 bit, meshlet triangles three bytes each (see MeshletData).
+        All values are little endian.
+    */
+    constexpr uint32_t mesh_file_version = 2;
+    constexpr size_t mesh_file_alignment = 64;
+    constexpr size_t mesh_file_max_bindings = 16;
+
+    struct MeshFileHeader{
+        char magic[4] = {'H','P','M','S'};
+        uint32_t version = mesh_file_version;
+        uint32_t stream_count = 0;
+        uint32_t index_count = 0;
+        uint64_t index_offset = 0;
+        uint64_t file_size = 0;
+
+        float bounds_min[3] = {0,0,0};
+        float bounds_max[3] = {0,0,0};
+        float center[3] = {0,0,0};
+        float radius = 0;
+
+        uint32_t meshlet_count = 0;
+        uint32_t meshlet_vertex_count = 0;
+        uint32_t meshlet_triangle_count = 0;
+        uint32_t reserved = 0;
+        uint64_t meshlet_offset = 0;
+    };
+
+    struct MeshFileStream{
+        uint32_t vertex_count = 0;
+        uint32_t binding_count = 0;
+        uint8_t bindings[mesh_file_max_bindings] = {};
+        uint32_t per_instance = 0;
+        uint32_t reserved = 0;
+        uint64_t offset = 0; // Bytes from the start of the file
+        uint64_t size = 0;   // In bytes
+    };
+
+    /*
+        Version 1 headers stop after radius and have no meshlets, MappedMesh still reads them
+    */
+    constexpr size_t mesh_file_v1_header_size = offsetof(MeshFileHeader, meshlet_count);
+
+    static_assert(sizeof(MeshFileHeader) == 96, "MeshFileHeader layout changed.");
+    static_assert(mesh_file_v1_header_size == 72, "Version 1 header layout changed.");
+    static_assert(sizeof(MeshFileStream) == 48, "MeshFileStream layout changed.");
+    static_assert(sizeof(Meshlet) == 60, "Meshlet layout changed, it is stored as is.");
+
+    struct MeshBounds{
+        glm::vec3 min = {0,0,0};
+        glm::vec3 max = {0,0,0};
+        glm::vec3 center = {0,0,0};
+        float radius = 0;
+    };
+
+    MeshBounds computeMeshBounds(const Mesh& mesh);
+
+    struct MeshFileStreamData{
+        VertexFormat format;
+        const float* data;
+        size_t vertex_count;
+    };
+
+    void writeMeshFile(const std::string& filename, const std::vector<MeshFileStreamData>& streams, const uint* indices, size_t index_count, MeshBounds bounds, const MeshletData* meshlets = nullptr);
+    /*
+        Writes a single stream mesh, format has to describe mesh.vertex_size floats
+    */
+    void writeMeshFile(const std::string& filename, const Mesh& mesh, const VertexFormat& format, const MeshletData* meshlets = nullptr);
+
+    /*
+        A read only memory mapping of a .hmesh file, nothing is copied on load.
+        Opening walks the indices and meshlets once to check they stay inside the vertex streams,
+        so a bad file throws here instead of reading past a buffer on the gpu.
+        The pointers it hands out are valid for as long as the MappedMesh lives.
+    */
+    class MappedMesh{
+        private:
+            int file_descriptor = -1;
+            void* mapping = nullptr;
+            size_t mapping_size = 0;
+
+            MeshFileHeader header = {};
+            const MeshFileStream* streams = nullptr;
+            size_t meshlet_vertex_offset = 0;
+            size_t meshlet_triangle_offset = 0;
+
+            void close();
+        public:
+            MappedMesh(const std::string& filename);
+            ~MappedMesh();
+
+            MappedMesh(const MappedMesh&) = delete;
+            MappedMesh& operator=(const MappedMesh&) = delete;
+
+            size_t getStreamCount() const { return header.stream_count; }
+            VertexFormat getStreamFormat(size_t stream) const;
+            size_t getVertexCount(size_t stream) const;
+            const float* getStreamData(size_t stream) const;
+            size_t getStreamSize(size_t stream) const; // In floats
+
+            const uint* getIndices() const;
+            size_t getIndexCount() const { return header.index_count; }
+
+            MeshBounds getBounds() const;
+
+            /*
+                Empty (0 and nullptr) if the file was written without meshlets
+            */
+            size_t getMeshletCount() const { return header.meshlet_count; }
+            const Meshlet* getMeshlets() const;
+            const uint* getMeshletVertices() const;
+            size_t getMeshletVertexCount() const { return header.meshlet_vertex_count; }
+            const uint8_t* getMeshletTriangles() const; // Three local indices per triangle
+            size_t getMeshletTriangleCount() const { return header.meshlet_triangle_count; }
+
+            /*
+                Uploads directly from the mapping, the only copy made is the one into the driver
+            */
+            void uploadStream(size_t stream, Buffer<float, GL_ARRAY_BUFFER>& buffer) const;
+            void uploadIndices(Buffer<uint, GL_ELEMENT_ARRAY_BUFFER>& buffer) const;
+
+            /*
+                Copies a stream straight into already mapped memory (a PersistentBuffer for example), offset is in floats
+            */
+            void copyStream(size_t stream, float* destination, size_t offset = 0) const;
+            void copyIndices(uint* destination, size_t offset = 0) const;
+    };
+}
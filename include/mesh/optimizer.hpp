@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mesh/mesh.hpp>
+
+namespace Heptcore{
+    struct MeshStatistics{
+        size_t vertices = 0;
+        size_t triangles = 0;
+        size_t transformed = 0; // Simulated vertex shader invocations
+
+        float acmr = 0; // Average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+        float atvr = 0; // Average transformed to vertex ratio, transformed vertices per vertex (1.0 best)
+        float overfetch = 0; // Bytes fetched from the vertex buffer per byte of vertex data
+    };
+
+    struct MeshOptimizerSettings{
+        bool weld = true;
+        float weld_epsilon = 0.0f; // 0 welds only bitwise identical vertices
+
+        uint cache_size = 16; // Size of the simulated post-transform FIFO cache
+
+        /*
+            Clusters are reordered for overdraw only if that doesnt make the
+            cache miss ratio worse than threshold times the optimal one, 1.0 disables it.
+        */
+        float overdraw_threshold = 1.05f;
+
+        bool meshlets = false;
+        uint meshlet_max_vertices = 64;
+        uint meshlet_max_triangles = 124;
+    };
+
+    /*
+        Merges duplicate vertices, returns the new vertex count
+    */
+    size_t weldVertices(Mesh& mesh, float epsilon = 0.0f);
+
+    /*
+        Reorders triangles for post-transform vertex cache locality (Forsyth)
+    */
+    void optimizeVertexCache(Mesh& mesh);
+
+    /*
+        Splits the cache optimized triangle order into clusters and sorts them
+        so that outward facing clusters get drawn first, expects optimizeVertexCache to be run before.
+    */
+    void optimizeOverdraw(Mesh& mesh, float threshold = 1.05f, uint cache_size = 16);
+
+    /*
+        Reorders vertices in the order they are first referenced by the index buffer
+    */
+    void optimizeVertexFetch(Mesh& mesh);
+
+    MeshletData buildMeshlets(const Mesh& mesh, uint max_vertices = 64, uint max_triangles = 124);
+
+    MeshStatistics analyzeMesh(const Mesh& mesh, uint cache_size = 16);
+
+    /*
+        Runs the whole pipeline in the right order (weld, cache, overdraw, fetch, meshlets),
+        returns the statistics after optimization.
+    */
+    MeshStatistics optimizeMesh(Mesh& mesh, MeshOptimizerSettings settings = {}, MeshletData* meshlets = nullptr);
+}
@@ -12,13 +12,15 @@
 #include <list>
 
 #include <chrono>
+#include <utility>
 
 #include <core.hpp>
+#include <opengl/capture.hpp>
+#include <opengl/debug.hpp>
+#include <opengl/memory.hpp>
+#include <opengl/stats.hpp>
 
 namespace Heptcore{
-    void checkGLError(const char *file, int line);
-    #define CHECK_GL_ERROR() checkGLError(__FILE__, __LINE__)
-
     template <typename T, int type>
     class Buffer{
         private:
@@ -32,37 +34,68 @@ namespace Heptcore{
                 glGenBuffers(1, &opengl_buffer_id);
             }
             ~Buffer(){
-                glDeleteBuffers(1, &opengl_buffer_id);
+                glDeleteBuffers(1, &opengl_buffer_id); // 0 after a move, deleting it is ignored
+                if(initialized) memoryTracker.free(MEMORY_BUFFER, buffer_size * sizeof(T));
+            }
+
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+
+            /*
+                Moving hands over the GL name, the moved from buffer is left empty
+            */
+            Buffer(Buffer&& other) noexcept:
+                opengl_buffer_id(std::exchange(other.opengl_buffer_id, 0)),
+                buffer_size(std::exchange(other.buffer_size, 0)),
+                initialized(std::exchange(other.initialized, false)){}
+            Buffer& operator=(Buffer&& other) noexcept{
+                std::swap(opengl_buffer_id, other.opengl_buffer_id);
+                std::swap(buffer_size, other.buffer_size);
+                std::swap(initialized, other.initialized);
+                return *this;
             }
 
-            Buffer(std::vector<T> data): Buffer(){
-                initialize(data.size());
-                insert(0,data.size(), data.data());
+            Buffer(const std::vector<T>& data): Buffer(data.data(), data.size()){}
+
+            /*
+                Creates and fills the buffer straight from memory (for example a mapped file)
+            */
+            Buffer(const T* data, size_t size): Buffer(){
+                initialize(size, data);
             }
 
             /*
                 Creates the actual buffer of some size
             */
-            void initialize(size_t size, T* data = nullptr){
+            void initialize(size_t size, const T* data = nullptr){
                 if(size == 0) return;
 
+                if(initialized) memoryTracker.free(MEMORY_BUFFER, buffer_size * sizeof(T));
+
                 bind();
                 glBufferData(type, size * sizeof(T), data, GL_DYNAMIC_DRAW);
                 buffer_size = size;
+                if(data) HEPTCORE_COUNT(buffer_upload_bytes, size * sizeof(T));
+
+                memoryTracker.allocate(MEMORY_BUFFER, size * sizeof(T));
 
                 initialized = true;
+                HEPTCORE_RECORD(bufferData(opengl_buffer_id));
             }
 
             /*
                 Inserts data into a buffer, needs to be initialized
             */
-            void insert(size_t at, size_t size, T* data){
+            void insert(size_t at, size_t size, const T* data){
                 if(!initialized) throw std::logic_error("Inserting into uninitialized buffer.");
 
                 if(at + size > buffer_size) throw std::logic_error("Insert out of bounds the buffer."); // Dont overflow
 
+                HEPTCORE_RECORD(bufferSubData(opengl_buffer_id, at * sizeof(T), size * sizeof(T), data));
+
                 bind();
                 glBufferSubData(type, at * sizeof(T), size * sizeof(T), data);
+                HEPTCORE_COUNT(buffer_upload_bytes, size * sizeof(T));
             }
             void bind(){
                 glBindBuffer(type, opengl_buffer_id);
@@ -71,6 +104,9 @@ namespace Heptcore{
             size_t size(){
                 return buffer_size;
             }
+
+            uint getID() {return opengl_buffer_id;}
+            void label(const std::string& name) {labelObject(GL_BUFFER, opengl_buffer_id, name);}
     };
 
     template <typename T, int type>
@@ -109,10 +145,30 @@ namespace Heptcore{
                 if(!_data) {
                     throw std::runtime_error("Failed to map persistent buffer.");
                 }
+
+                memoryTracker.allocate(MEMORY_BUFFER, size);
             }
 
             ~PersistentBuffer(){
+                if(!buffer_id) return; // Moved from
                 glDeleteBuffers(1, &buffer_id);
+                memoryTracker.free(MEMORY_BUFFER, size);
+            }
+
+            PersistentBuffer(const PersistentBuffer&) = delete;
+            PersistentBuffer& operator=(const PersistentBuffer&) = delete;
+
+            PersistentBuffer(PersistentBuffer&& other) noexcept:
+                buffer_id(std::exchange(other.buffer_id, 0)),
+                type(other.type),
+                size(std::exchange(other.size, 0)),
+                _data(std::exchange(other._data, nullptr)){}
+            PersistentBuffer& operator=(PersistentBuffer&& other) noexcept{
+                std::swap(buffer_id, other.buffer_id);
+                std::swap(type, other.type);
+                std::swap(size, other.size);
+                std::swap(_data, other._data);
+                return *this;
             }
 
             uint getID() {return buffer_id;}
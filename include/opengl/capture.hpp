@@ -0,0 +1,330 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <core.hpp>
+#include <opengl/debug.hpp>
+
+/*
+    Set by the HEPTCORE_ENABLE_CAPTURE cmake option, with 0 the wrappers dont record anything
+    and the hooks compile to nothing. Enabled but not capturing every hook costs one atomic load.
+*/
+#ifndef HEPTCORE_CAPTURE
+#define HEPTCORE_CAPTURE 1
+#endif
+
+#if HEPTCORE_CAPTURE
+    #define HEPTCORE_RECORD(call) do{ if(Heptcore::frameCapture.isRecording()) Heptcore::frameCapture.call; }while(0)
+    // Calls made by the rest of the scope are part of the one already recorded
+    #define HEPTCORE_RECORD_SUPPRESS() Heptcore::CaptureSuppress HEPTCORE_CONCAT(capture_suppress_, __LINE__){}
+#else
+    #define HEPTCORE_RECORD(call) ((void)0)
+    #define HEPTCORE_RECORD_SUPPRESS() ((void)0)
+#endif
+
+namespace Heptcore{
+    template <typename T, int type>
+    class Buffer;
+    class BindableTexture;
+    class CapturedTexture;
+    class Framebuffer;
+    class FullscreenQuad;
+    class ShaderProgram;
+    class VertexArrayObject;
+    struct SamplerDescription;
+
+    /*
+        Record types of the capture file. Snapshots hold the state of a resource the first time
+        a frame used it, replay applies them up front, everything else is replayed in order.
+    */
+    enum CaptureOp: uint8_t{
+        CAPTURE_FRAME_BEGIN = 0,
+        CAPTURE_FRAME_END = 1,
+        CAPTURE_BUFFER_SNAPSHOT = 2,
+        CAPTURE_BUFFER_DATA = 3,
+        CAPTURE_BUFFER_SUBDATA = 4,
+        CAPTURE_TEXTURE_SNAPSHOT = 5,
+        CAPTURE_TEXTURE_DATA = 6,
+        CAPTURE_TEXTURE_BIND = 7,
+        CAPTURE_TEXTURE_UNBIND = 8,
+        CAPTURE_TEXTURE_PARAMETER = 9,
+        CAPTURE_PROGRAM_SNAPSHOT = 10,
+        CAPTURE_PROGRAM_USE = 11,
+        CAPTURE_UNIFORM = 12,
+        CAPTURE_FRAMEBUFFER_SNAPSHOT = 13,
+        CAPTURE_FRAMEBUFFER_BIND = 14,
+        CAPTURE_FRAMEBUFFER_RESOLVE = 15,
+        CAPTURE_FRAMEBUFFER_INVALIDATE_DEPTH = 16,
+        CAPTURE_VERTEX_ARRAY_SNAPSHOT = 17,
+        CAPTURE_VERTEX_ARRAY_FORMAT = 18,
+        CAPTURE_VERTEX_ARRAY_BIND = 19,
+        CAPTURE_DRAW = 20,
+        CAPTURE_DRAW_INDEXED = 21,
+        CAPTURE_QUAD = 22,
+        CAPTURE_RENDER_STATE = 23,
+        CAPTURE_CLEAR = 24,
+        CAPTURE_BUFFER_BIND = 25,
+        CAPTURE_BUFFER_CLEAR = 26,
+        CAPTURE_IMAGE_BIND = 27,
+        CAPTURE_DISPATCH = 28,
+        CAPTURE_DISPATCH_INDIRECT = 29,
+        CAPTURE_MEMORY_BARRIER = 30,
+        CAPTURE_OP_COUNT = 31
+    };
+
+    /*
+        Fixed function state draws and clears depend on, recorded whenever it changed since the last one
+    */
+    struct CaptureRenderState{
+        int32_t viewport[4];
+        int32_t scissor[4];
+        uint32_t depth_func;
+        uint32_t blend_source_rgb;
+        uint32_t blend_destination_rgb;
+        uint32_t blend_source_alpha;
+        uint32_t blend_destination_alpha;
+        uint32_t blend_equation_rgb;
+        uint32_t blend_equation_alpha;
+        float blend_color[4];
+        uint32_t cull_mode;
+        uint32_t front_face;
+        uint8_t scissor_test;
+        uint8_t depth_test;
+        uint8_t depth_mask;
+        uint8_t blend;
+        uint8_t cull_face;
+        uint8_t color_mask[4];
+    };
+
+    const char* captureOpName(CaptureOp op);
+
+    inline thread_local int captureSuppressed = 0;
+
+    class CaptureSuppress{
+        public:
+            CaptureSuppress() {captureSuppressed++;}
+            ~CaptureSuppress() {captureSuppressed--;}
+
+            CaptureSuppress(const CaptureSuppress&) = delete;
+            CaptureSuppress& operator=(const CaptureSuppress&) = delete;
+    };
+
+    /*
+        Records what goes through the wrappers (Buffer, textures, ShaderProgram, Uniform, Framebuffer,
+        VertexArrayObject, FullscreenQuad) into a binary file that heptcore_replay can rerun headlessly.
+
+        Resources are snapshotted (read back from the gpu) the first time a captured frame uses them,
+        so nothing is tracked outside of a capture. While recording, the glad entry points for clears,
+        glUniform*, raw draws and compute (dispatches, image and buffer bindings, barriers) are swapped
+        for ones that record the call first, so raw GL from the library (SpriteBatch, PostProcessChain,
+        the image kernels, ClusteredLighting) and from the application is captured too. Viewport,
+        scissor, depth, blend, cull and color mask state is read back before every draw and clear and
+        recorded when it changed. Other raw state changes, and raw calls of other threads, are not.
+    */
+    class FrameCapture{
+        private:
+            std::atomic<bool> recording = false;
+            std::atomic<bool> armed = false;
+            std::thread::id thread = {}; // Only read while recording
+
+            std::mutex mutex; // Arming can come from any thread
+            std::string armed_filename = "";
+            int armed_frames = 0;
+
+            std::ofstream file;
+            std::string filename = "";
+            int frames_left = 0;
+            uint32_t frames_written = 0;
+
+            std::vector<uint8_t> record = {};
+
+            std::unordered_set<uint> buffers = {};
+            std::unordered_set<uint> textures = {};
+            std::unordered_set<uint> programs = {};
+            std::unordered_set<uint> framebuffers = {};
+            std::unordered_set<uint> vertex_arrays = {};
+            std::unordered_map<uint, std::unordered_map<int, std::string>> uniform_names = {}; // Per program, by location
+
+            CaptureRenderState render_state = {};
+            bool render_state_recorded = false;
+
+            void beginRecord(CaptureOp op);
+            void endRecord();
+            void write(const void* data, size_t bytes);
+            template <typename T>
+            void write(const T& value) {write(&value, sizeof(T));}
+            void writeString(const std::string& string);
+
+            void start();
+            void finish();
+            void beginFrame();
+
+            void snapshotBuffer(uint name, CaptureOp op);
+            void snapshotTexture(uint name, uint target, CaptureOp op);
+            void snapshotProgram(ShaderProgram& program);
+            void snapshotVertexArray(uint name, CaptureOp op);
+            void snapshotFramebuffer(Framebuffer& framebuffer);
+            /*
+                Records the render state if it differs from the last one recorded
+            */
+            void renderState();
+            const std::string* uniformName(uint program, int location);
+        public:
+            /*
+                Records the given number of frames, starting at the next endFrame. Callable from any
+                thread, the capture happens on the thread that ends the frames.
+            */
+            void captureFrames(const std::string& filename, int frames = 1);
+            /*
+                Frame boundary, Window::swapBuffers calls it
+            */
+            void endFrame();
+
+            bool isRecording() const {
+                return recording.load(std::memory_order_acquire) && captureSuppressed == 0 && std::this_thread::get_id() == thread;
+            }
+            bool isCapturing() const {
+                return armed.load(std::memory_order_acquire) || recording.load(std::memory_order_acquire);
+            }
+
+            // Hooks for HEPTCORE_RECORD, names are GL names of the recorded objects
+            void bufferData(uint name);
+            void bufferSubData(uint name, size_t offset, size_t size, const void* data);
+
+            void textureData(uint name, uint target);
+            void bindTexture(uint name, uint target, int unit, const SamplerDescription* sampler);
+            void unbindTexture(uint name, uint target, int unit);
+            void textureParameter(uint name, uint target, int identifier, int value);
+
+            void useProgram(ShaderProgram& program);
+            void uniform(const std::string& name, uint type, int count, const void* data);
+
+            void bindFramebuffer(Framebuffer* framebuffer);
+            void resolveFramebuffer(Framebuffer& framebuffer, bool invalidate);
+            void invalidateDepth(Framebuffer& framebuffer);
+
+            void bindVertexArray(uint name);
+            void vertexArrayChanged(uint name);
+            void draw(uint vertex_array, uint mode, int first, int count, int instances, uint base_instance = 0);
+            void drawIndexed(uint vertex_array, uint mode, int count, uint index_type, size_t offset, int instances);
+            void renderQuad();
+
+            // Hooks for the swapped glad entry points, raw GL calls
+            void clear(uint mask);
+            void rawUniform(int location, uint type, int count, const void* data);
+            void rawDraw(uint mode, int first, int count, int instances, uint base_instance);
+            void rawDrawIndexed(uint mode, int count, uint index_type, size_t offset, int instances);
+            void bindBuffer(uint target, uint index, uint name, size_t offset, size_t size);
+            void clearBuffer(uint name, uint internal_format, uint format, uint type, const void* data);
+            void bindImage(uint unit, uint name, int level, bool layered, int layer, uint access, uint format);
+            void dispatch(uint groups_x, uint groups_y, uint groups_z);
+            void dispatchIndirect(size_t offset);
+            void memoryBarrier(uint barriers);
+    };
+
+    extern FrameCapture frameCapture;
+
+    /*
+        Routes the raw GL calls captures record (glClear, glUniform*, draws, dispatches...) through frameCapture.
+        Call right after every gladLoadGL and before other threads use GL, the hooks stay installed from then on.
+    */
+    void installCaptureHooks();
+
+    struct CaptureCallTiming{
+        uint64_t count = 0;
+        double cpu_ms = 0.0; // Time spent issuing the calls
+        double gpu_ms = 0.0; // Only with CaptureTimings::gpu
+    };
+
+    struct CaptureTimings{
+        bool gpu = false; // Timestamp query around every call, waits for the gpu at the end of every frame
+        std::array<CaptureCallTiming, CAPTURE_OP_COUNT> calls = {};
+    };
+
+    /*
+        Loads a capture and reruns its frames through the same wrappers that recorded them,
+        so changes to the library show up in the replay.
+    */
+    class CaptureReplay{
+        private:
+            struct Record{
+                CaptureOp op;
+                size_t offset; // Of the payload in data
+                size_t size;
+            };
+
+            struct ReplayTexture{
+                std::unique_ptr<CapturedTexture> owned;
+                BindableTexture* texture = nullptr; // Owned or part of a framebuffer
+                int internal_format = 0;
+                int width = 0;
+                int height = 0;
+                int depth = 0;
+                int levels = 0;
+            };
+
+            struct ReplayProgram{
+                std::unique_ptr<ShaderProgram> program;
+                std::unordered_map<std::string, int> locations;
+            };
+
+            std::vector<uint8_t> data = {};
+            std::vector<Record> snapshots = {};
+            std::vector<std::vector<Record>> frames = {};
+            int width = 0;
+            int height = 0;
+
+            // No default member initializers, the types are only complete in capture.cpp
+            std::unordered_map<uint, std::unique_ptr<Buffer<unsigned char, GL_ARRAY_BUFFER>>> buffers;
+            std::unordered_map<uint, ReplayTexture> textures;
+            std::unordered_map<uint, ReplayProgram> programs;
+            std::unordered_map<uint, std::unique_ptr<Framebuffer>> framebuffers;
+            std::unordered_map<uint, std::unique_ptr<VertexArrayObject>> vertex_arrays;
+            std::unique_ptr<FullscreenQuad> quad;
+
+            ReplayProgram* current_program = nullptr;
+            std::vector<GLuint> timestamp_queries = {};
+
+            void execute(const Record& record);
+            ReplayTexture* texture(uint name);
+            void textureRecord(const Record& record);
+            void framebufferRecord(const Record& record);
+            void vertexArrayRecord(const Record& record);
+            void programRecord(const Record& record);
+        public:
+            CaptureReplay();
+            ~CaptureReplay();
+
+            CaptureReplay(const CaptureReplay&) = delete;
+            CaptureReplay& operator=(const CaptureReplay&) = delete;
+
+            /*
+                Reads the whole file, throws std::runtime_error if it isnt a capture
+            */
+            void load(const std::string& filename);
+
+            /*
+                Creates the captured resources and sets them to their captured contents, call before the first
+                replayFrame and again whenever every repetition should start from the same state
+            */
+            void restore();
+            void replayFrame(size_t frame, CaptureTimings* timings = nullptr);
+
+            size_t getFrameCount() {return frames.size();}
+            size_t getCallCount(size_t frame) {return frames.at(frame).size();}
+            // Viewport size when the capture started
+            int getWidth() {return width;}
+            int getHeight() {return height;}
+    };
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <opengl/buffer.hpp>
+#include <opengl/framebuffer.hpp>
+#include <opengl/shader_variants.hpp>
+#include <opengl/shaders.hpp>
+#include <opengl/texture.hpp>
+
+namespace Heptcore{
+    /*
+        Same layout as HeptcorePointLight in the GLSL include (std430, 32 bytes)
+    */
+    struct PointLight{
+        glm::vec3 position = glm::vec3(0.0f); // World space
+        float radius = 1.0f; // No light past this distance
+        glm::vec3 color = glm::vec3(1.0f);
+        float intensity = 1.0f;
+    };
+
+    struct ClusterGridSettings{
+        int tiles_x = 16;
+        int tiles_y = 9;
+        int slices = 24; // Exponential in view depth, so clusters stay roughly cube shaped
+        int max_lights_per_cluster = 256; // Extra lights are dropped
+        int average_lights_per_cluster = 32; // Sizes the shared index list for every cluster together
+    };
+
+    /*
+        Clustered (Forward+) light culling.
+
+        The view frustum is split into a grid of clusters, every frame a compute pass marks the clusters
+        that contain any depth of the given depth buffer, and only those get lights assigned, as compact
+        (offset, count) ranges into one shared index list. Fragment shaders include
+            #include "heptcore/clustered_lighting.glsl"
+        and loop over heptcoreClusterLightRange(gl_FragCoord) instead of every light:
+
+            uvec2 range = heptcoreClusterLightRange(gl_FragCoord);
+            for(uint i = 0u; i < range.y; i++){
+                HeptcorePointLight light = heptcoreClusterLight(range, i);
+                color += light.color * light.intensity * heptcoreLightAttenuation(light, world_position) * ...;
+            }
+
+        The data lives on fixed bindings, bind() sets them for shading:
+        uniform block 4 (parameters), storage buffers 4 (lights), 5 (cluster ranges) and 6 (light indices).
+        Storage buffers 7 to 10 are used by the culling passes only.
+    */
+    class ClusteredLighting{
+        private:
+            // std140, mirrors HeptcoreClusterParameters
+            struct Parameters{
+                glm::mat4 view;
+                glm::mat4 projection;
+                uint tiles_x;
+                uint tiles_y;
+                uint slices;
+                uint light_count;
+                float tile_width;
+                float tile_height;
+                float screen_width;
+                float screen_height;
+                float near_plane;
+                float far_plane;
+                float slice_scale;
+                float slice_bias;
+            };
+
+            ShaderVariantCache& cache;
+            ClusterGridSettings settings;
+            int cluster_count;
+            size_t index_capacity;
+
+            Buffer<PointLight, GL_SHADER_STORAGE_BUFFER> lights = {};
+            size_t light_count = 0;
+
+            Buffer<Parameters, GL_UNIFORM_BUFFER> parameters = {};
+            Buffer<uint, GL_SHADER_STORAGE_BUFFER> cluster_lights = {}; // (offset, count) per cluster
+            Buffer<uint, GL_SHADER_STORAGE_BUFFER> light_indices = {};
+
+            Buffer<glm::vec4, GL_SHADER_STORAGE_BUFFER> bounds = {}; // View space min and max per cluster
+            Buffer<uint, GL_SHADER_STORAGE_BUFFER> active = {};
+            Buffer<uint, GL_SHADER_STORAGE_BUFFER> active_list = {};
+            Buffer<uint, GL_SHADER_STORAGE_BUFFER> counters = {}; // Indirect dispatch (active clusters, 1, 1) and used indices
+
+            glm::mat4 bounds_projection = glm::mat4(0.0f);
+            int bounds_width = 0;
+            int bounds_height = 0;
+
+            void bindCullingBuffers();
+        public:
+            static constexpr const char* include_name = "heptcore/clustered_lighting.glsl";
+
+            ClusteredLighting(ShaderVariantCache& cache, ClusterGridSettings settings = {});
+
+            ClusteredLighting(const ClusteredLighting&) = delete;
+            ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+            /*
+                Uploads the lights for the next update, the buffer grows as needed
+            */
+            void setLights(const std::vector<PointLight>& lights);
+
+            /*
+                Culls the lights against the clusters depth covers. depth is a depth texture of
+                width x height (the viewport), projection has to be a perspective projection.
+            */
+            void update(BindableTexture& depth, int width, int height, const glm::mat4& view, const glm::mat4& projection);
+            /*
+                Same with the depth of a framebuffer created with FramebufferSettings::depth_texture
+            */
+            void update(Framebuffer& framebuffer, const glm::mat4& view, const glm::mat4& projection);
+
+            /*
+                Binds the parameters, lights and cluster lists for shaders using the include
+            */
+            void bind();
+
+            size_t getLightCount() {return light_count;}
+            int getClusterCount() {return cluster_count;}
+            const ClusterGridSettings& getSettings() {return settings;}
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include <core.hpp>
+
+namespace Heptcore{
+    class ShaderUniformLinker;
+    class SamplerCache;
+
+    /*
+        What Heptcore remembers about one GL context: the bind caches, the uniform linker and the sampler cache.
+
+        Every context Heptcore creates (Window, ContextWorker, RenderFarm) owns one and makes it current
+        together with the context (see makeContextCurrent), so a context can change threads and several
+        contexts can render on several threads at once. A thread that made a context current by itself
+        gets a state of its own that shares the default linker.
+    */
+    class ContextState{
+        private:
+            std::shared_ptr<ShaderUniformLinker> uniform_linker;
+            std::shared_ptr<SamplerCache> sampler_cache;
+
+        public:
+            std::array<uint, 32> texture_bindings = {};
+            std::array<uint, 32> sampler_bindings = {};
+            uint framebuffer = 0;
+            int program = -1;
+
+            /*
+                Uniforms created while this state is current register with linker. nullptr shares the default
+                linker with every Window, so uniforms created before the Window still reach its programs.
+                Samplers come from samplers, which only contexts sharing objects with each other may share.
+                nullptr uses a default cache for states that never get one of their own.
+            */
+            ContextState(std::shared_ptr<ShaderUniformLinker> linker = nullptr, std::shared_ptr<SamplerCache> samplers = nullptr);
+            ~ContextState();
+
+            ContextState(const ContextState&) = delete;
+            ContextState& operator=(const ContextState&) = delete;
+
+            const std::shared_ptr<ShaderUniformLinker>& getUniformLinker() {return uniform_linker;}
+            const std::shared_ptr<SamplerCache>& getSamplerCache() {return sampler_cache;}
+
+            /*
+                Forgets every cached binding, for after raw GL calls changed them behind the caches back
+            */
+            void invalidate();
+
+            /*
+                State of the context current on the calling thread
+            */
+            static ContextState& current();
+            /*
+                Only switches the state, the GL context has to change with it. Returns the previous one (nullptr if there was none)
+            */
+            static ContextState* setCurrent(ContextState* state);
+    };
+}
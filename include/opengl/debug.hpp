@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <core.hpp>
+
+/*
+    Set by the HEPTCORE_ENABLE_GL_DEBUG cmake option, with 0 the debug groups, labels and
+    error checks compile to nothing
+*/
+#ifndef HEPTCORE_GL_DEBUG
+#define HEPTCORE_GL_DEBUG 1
+#endif
+
+#define HEPTCORE_CONCAT_INNER(a, b) a##b
+#define HEPTCORE_CONCAT(a, b) HEPTCORE_CONCAT_INNER(a, b)
+
+#if HEPTCORE_GL_DEBUG
+    #define CHECK_GL_ERROR() Heptcore::checkGLError(__FILE__, __LINE__)
+    #define HEPTCORE_DEBUG_GROUP(name) Heptcore::DebugGroup HEPTCORE_CONCAT(debug_group_, __LINE__)(name)
+#else
+    #define CHECK_GL_ERROR() ((void)0)
+    #define HEPTCORE_DEBUG_GROUP(name) ((void)0)
+#endif
+
+namespace Heptcore{
+    /*
+        Polls glGetError, this synchronizes with the driver so prefer the debug output
+    */
+    void checkGLError(const char *file, int line);
+
+    enum DebugSeverity{
+        DEBUG_NOTIFICATION = 0,
+        DEBUG_LOW = 1,
+        DEBUG_MEDIUM = 2,
+        DEBUG_HIGH = 3
+    };
+
+    /*
+        Receives KHR_debug messages from every context it is installed on (needs a debug context,
+        see WindowSettings::debug). Repeated messages are only printed the first time and then
+        every time their count reaches a power of two.
+    */
+    class DebugOutput{
+        private:
+            struct Message{
+                uint64_t count = 0;
+                DebugSeverity severity;
+            };
+
+            std::mutex mutex;
+            std::unordered_map<uint64_t, Message> messages = {};
+
+            DebugSeverity minimum_severity = DEBUG_LOW;
+            bool source_enabled[6] = {true, true, true, true, true, true}; // Indexed like GL_DEBUG_SOURCE_API...OTHER
+            bool synchronous = false;
+
+            static void APIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* user);
+            void receive(GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* message);
+            void applySeverityFilter(); // On the current context, with mutex held
+        public:
+            /*
+                Installs the callback on the current context, returns false if it isnt a debug context
+            */
+            bool install();
+
+            /*
+                The driver filter is updated right away if the current context has this installed,
+                other contexts get it on their next install (until then lowering it misses their messages)
+            */
+            void setMinimumSeverity(DebugSeverity severity);
+            /*
+                Source is one of GL_DEBUG_SOURCE_*
+            */
+            void setSourceEnabled(GLenum source, bool enabled);
+            /*
+                Messages arrive on the thread that caused them (useful with a debugger), takes effect on install
+            */
+            void setSynchronous(bool value) {synchronous = value;}
+
+            /*
+                Number of distinct messages and total received at or above the minimum severity
+            */
+            size_t getUniqueMessages();
+            uint64_t getTotalMessages();
+            void reset();
+    };
+
+    extern DebugOutput debugOutput;
+
+    /*
+        Names a range of commands in captures (RenderDoc, Nsight), use HEPTCORE_DEBUG_GROUP("name") so it compiles out
+    */
+    class DebugGroup{
+        public:
+            DebugGroup(const char* name){
+                glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+            }
+            DebugGroup(const std::string& name): DebugGroup(name.c_str()) {}
+            ~DebugGroup(){
+                glPopDebugGroup();
+            }
+
+            DebugGroup(const DebugGroup&) = delete;
+            DebugGroup& operator=(const DebugGroup&) = delete;
+    };
+
+    /*
+        Attaches a name to an object, identifier is GL_BUFFER, GL_TEXTURE, GL_PROGRAM...
+    */
+    inline void labelObject(GLenum identifier, uint name, const std::string& label){
+#if HEPTCORE_GL_DEBUG
+        glObjectLabel(identifier, name, (GLsizei) label.size(), label.c_str());
+#endif
+    }
+}
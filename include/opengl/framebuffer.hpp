@@ -1,10 +1,36 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <memory>
 #include <core.hpp>
 #include <opengl/texture.hpp>
 
 namespace Heptcore{
+    enum FramebufferDepth{
+        DEPTH_NONE = 0,
+        DEPTH_16 = 1,
+        DEPTH_24 = 2,
+        DEPTH_32F = 3,
+        DEPTH_24_STENCIL_8 = 4,
+        DEPTH_32F_STENCIL_8 = 5
+    };
+
+    struct FramebufferSettings{
+        /*
+            Above 0 rendering goes into multisampled storage and the textures only
+            receive the result of resolve(), color formats have to be sized (GL_RGBA8, not GL_RGBA)
+        */
+        int samples = 0;
+        FramebufferDepth depth = DEPTH_24;
+        // Multisampled color as GL_TEXTURE_2D_MULTISAMPLE (readable with texelFetch) instead of renderbuffers
+        bool multisample_textures = false;
+        /*
+            Depth as a Texture2D (getDepthTexture) instead of a renderbuffer so shaders can read it,
+            with samples it is the resolved depth and resolve() blits into it
+        */
+        bool depth_texture = false;
+    };
+
     class Framebuffer{
         public:
             struct FramebufferTexture{
@@ -19,21 +45,75 @@ namespace Heptcore{
 
         private:
             std::vector<Texture2D> textures = {};
+            FramebufferSettings settings;
+
+            uint framebuffer_id; // What gets rendered into, the multisampled one when there are samples
+            uint depth_renderbuffer_id = 0;
+            std::unique_ptr<Texture2D> depth_texture = nullptr;
+
+            uint resolve_framebuffer_id = 0; // Textures when multisampled
+            std::vector<uint> multisample_color = {}; // Renderbuffers or multisample textures
+            std::vector<uint> color_attachments = {};
+
+            size_t renderbuffer_memory = 0;
+            size_t multisample_texture_memory = 0;
 
-            uint framebuffer_id;
-            uint depth_renderbuffer_id;
-            
+            void createDepth();
+            void createDepthTexture();
+            void createMultisampleColor(const std::vector<FramebufferTexture>& texture_definitions);
+            uint depthAttachment();
         public:
-            Framebuffer(int width, int height, std::vector<FramebufferTexture> textures);
+            Framebuffer(int width, int height, std::vector<FramebufferTexture> textures, FramebufferSettings settings = {});
+            ~Framebuffer();
+
+            Framebuffer(const Framebuffer&) = delete;
+            Framebuffer& operator=(const Framebuffer&) = delete;
+
+            /*
+                Moving hands over every GL object, the moved from framebuffer is left empty
+            */
+            Framebuffer(Framebuffer&& other) noexcept;
+            Framebuffer& operator=(Framebuffer&& other) noexcept;
+
             void bind();
             void unbind();
+            /*
+                Binds the window framebuffer through the same bind cache
+            */
+            static void bindDefault();
+
+            /*
+                Resolves multisampled color (and depth with depth_texture) into the textures, then (by default)
+                invalidates the multisampled color and depth so the driver doesnt have to write them back.
+                Without samples it only invalidates depth, unless depth is a texture.
+            */
+            void resolve(bool invalidate = true);
+            /*
+                Tells the driver the depth contents arent needed anymore (tiled gpus skip storing them)
+            */
+            void invalidateDepth();
 
             std::vector<Texture2D>& getTextures() { return textures; };
+            /*
+                nullptr unless the settings asked for a depth texture
+            */
+            Texture2D* getDepthTexture() {return depth_texture.get();}
 
             void bindTextures();
             void unbindTextures();
 
+            uint getID(){return framebuffer_id;}
+            void label(const std::string& name) {labelObject(GL_FRAMEBUFFER, framebuffer_id, name);}
+
+            /*
+                GL_TEXTURE_2D_MULTISAMPLE name of a color attachment, 0 unless multisample_textures is set
+            */
+            uint getMultisampleTexture(size_t index);
+            int getSamples(){return settings.samples;}
+            FramebufferDepth getDepth(){return settings.depth;}
+            const FramebufferSettings& getSettings(){return settings;}
+
             int getWidth(){return width;}
             int getHeight(){return height;}
     };
-    }
\ No newline at end of file
+    }
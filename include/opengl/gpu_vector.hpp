@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <opengl/buffer.hpp>
+
+namespace Heptcore{
+    enum GpuVectorUpload{
+        GPU_VECTOR_SUBDATA = 0, // One glBufferSubData per dirty range
+        GPU_VECTOR_STAGING = 1 // Dirty ranges go through a persistently mapped ring and get copied on the gpu
+    };
+
+    /*
+        A std::vector with a copy on the gpu.
+
+        Edits only touch the cpu shadow and record which elements changed. flush() (once per frame,
+        before the buffer is used) uploads every changed range, ranges closer than merge_gap elements
+        are merged so thousands of small edits turn into a few uploads. The buffer grows geometrically,
+        old contents are copied on the gpu so only what changed since the last flush is uploaded.
+
+        Non const operator[] marks the element changed, read through a const reference (or at) to avoid that.
+    */
+    template <typename T, int type>
+    class GpuVector{
+        private:
+            static constexpr int STAGING_SECTIONS = 3;
+
+            std::vector<T> shadow = {};
+            std::unique_ptr<Buffer<T, type>> buffer = nullptr;
+            size_t capacity = 0; // Elements the gpu buffer holds
+            size_t uploaded = 0; // Elements of the gpu buffer that are valid
+
+            // Start to end (exclusive) of changed elements, never overlapping or closer than merge_gap
+            std::map<size_t, size_t> dirty = {};
+            size_t merge_gap;
+
+            GpuVectorUpload upload;
+            size_t staging_section_bytes;
+            std::unique_ptr<PersistentBuffer<unsigned char>> staging = nullptr;
+            GLsync staging_fences[STAGING_SECTIONS] = {};
+            int staging_section = 0;
+
+            size_t last_flush_ranges = 0;
+            size_t last_flush_bytes = 0;
+
+            void markDirty(size_t begin, size_t end){
+                if(begin >= end) return;
+
+                auto next = dirty.upper_bound(begin);
+                if(next != dirty.begin()){
+                    auto previous = std::prev(next);
+                    if(previous->second + merge_gap >= begin){
+                        begin = previous->first;
+                        end = std::max(end, previous->second);
+                        dirty.erase(previous);
+                    }
+                }
+
+                while(next != dirty.end() && next->first <= end + merge_gap){
+                    end = std::max(end, next->second);
+                    next = dirty.erase(next);
+                }
+
+                dirty.emplace(begin, end);
+            }
+
+            /*
+                Geometric growth, the valid part of the old buffer is copied on the gpu
+            */
+            void grow(size_t needed){
+                if(needed <= capacity) return;
+
+                size_t new_capacity = std::max({needed, capacity * 2, (size_t) 16});
+                auto grown = std::make_unique<Buffer<T, type>>();
+                grown->initialize(new_capacity);
+
+                if(buffer && uploaded > 0){
+                    glCopyNamedBufferSubData(buffer->getID(), grown->getID(), 0, 0, uploaded * sizeof(T));
+                    HEPTCORE_RECORD(bufferData(grown->getID()));
+                }
+
+                buffer = std::move(grown);
+                capacity = new_capacity;
+            }
+
+            /*
+                Waits until the gpu is done copying out of the next staging section
+            */
+            unsigned char* nextStagingSection(){
+                if(!staging) staging = std::make_unique<PersistentBuffer<unsigned char>>(staging_section_bytes * STAGING_SECTIONS, GL_COPY_READ_BUFFER);
+
+                staging_section = (staging_section + 1) % STAGING_SECTIONS;
+                GLsync& fence = staging_fences[staging_section];
+                if(fence){
+                    while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+
+                return staging->data() + staging_section * staging_section_bytes;
+            }
+
+            void flushStaging(){
+                unsigned char* section = nextStagingSection();
+                size_t section_offset = staging_section * staging_section_bytes;
+                size_t used = 0;
+
+                for(auto& [begin, end]: dirty){
+                    size_t bytes = (end - begin) * sizeof(T);
+
+                    // Whatever doesnt fit into the section anymore goes straight through glBufferSubData
+                    if(used + bytes > staging_section_bytes){
+                        buffer->insert(begin, end - begin, shadow.data() + begin);
+                        continue;
+                    }
+
+                    std::memcpy(section + used, shadow.data() + begin, bytes);
+                    glCopyNamedBufferSubData(staging->getID(), buffer->getID(), section_offset + used, begin * sizeof(T), bytes);
+                    HEPTCORE_RECORD(bufferSubData(buffer->getID(), begin * sizeof(T), bytes, shadow.data() + begin));
+                    HEPTCORE_COUNT(buffer_upload_bytes, bytes);
+                    used += bytes;
+                }
+
+                if(used > 0) staging_fences[staging_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+        public:
+            /*
+                staging_bytes is the size of one of the three staging sections, only used with GPU_VECTOR_STAGING
+            */
+            GpuVector(GpuVectorUpload upload = GPU_VECTOR_SUBDATA, size_t merge_gap = 16, size_t staging_bytes = 1 << 20):
+                merge_gap(merge_gap), upload(upload), staging_section_bytes(staging_bytes){}
+
+            ~GpuVector(){
+                for(auto& fence: staging_fences) if(fence) glDeleteSync(fence);
+            }
+
+            GpuVector(const GpuVector&) = delete;
+            GpuVector& operator=(const GpuVector&) = delete;
+
+            size_t size() const {return shadow.size();}
+            bool empty() const {return shadow.empty();}
+            size_t getCapacity() const {return capacity;}
+
+            const T& operator[](size_t index) const {return shadow[index];}
+            T& operator[](size_t index){
+                markDirty(index, index + 1);
+                return shadow[index];
+            }
+            const T& at(size_t index) const {return shadow.at(index);}
+            const T* data() const {return shadow.data();}
+
+            void set(size_t index, const T& value){
+                shadow[index] = value;
+                markDirty(index, index + 1);
+            }
+            /*
+                Overwrites count elements starting at index, grows the vector if they reach past the end
+            */
+            void set(size_t index, size_t count, const T* values){
+                size_t old_size = shadow.size();
+                if(index + count > old_size) shadow.resize(index + count);
+                std::copy(values, values + count, shadow.begin() + index);
+                markDirty(std::min(index, old_size), index + count);
+            }
+
+            void push_back(const T& value){
+                shadow.push_back(value);
+                markDirty(shadow.size() - 1, shadow.size());
+            }
+            void pop_back(){
+                shadow.pop_back();
+            }
+
+            /*
+                Removes elements like std::vector, everything after them moves and gets uploaded again
+            */
+            void erase(size_t index, size_t count = 1){
+                if(count == 0) return;
+                shadow.erase(shadow.begin() + index, shadow.begin() + index + count);
+                markDirty(index, shadow.size());
+            }
+            /*
+                Moves the last element into index instead, O(1) and only one element to upload
+            */
+            void swapErase(size_t index){
+                if(index + 1 != shadow.size()){
+                    shadow[index] = shadow.back();
+                    markDirty(index, index + 1);
+                }
+                shadow.pop_back();
+            }
+
+            void resize(size_t size, const T& value = T()){
+                size_t old_size = shadow.size();
+                shadow.resize(size, value);
+                markDirty(old_size, size);
+            }
+            void clear(){
+                shadow.clear();
+                dirty.clear();
+            }
+
+            /*
+                Makes room on the gpu right away instead of growing at the next flush
+            */
+            void reserve(size_t count){
+                shadow.reserve(count);
+                grow(count);
+            }
+
+            /*
+                Uploads every changed range, the buffer is up to date afterwards
+            */
+            void flush(){
+                last_flush_ranges = 0;
+                last_flush_bytes = 0;
+
+                grow(shadow.size());
+
+                // Erasing may have cut ranges short
+                while(!dirty.empty() && dirty.rbegin()->first >= shadow.size()) dirty.erase(std::prev(dirty.end()));
+                if(!dirty.empty()) dirty.rbegin()->second = std::min(dirty.rbegin()->second, shadow.size());
+
+                if(dirty.empty()){
+                    uploaded = std::min(uploaded, shadow.size());
+                    return;
+                }
+
+                HEPTCORE_DEBUG_GROUP("GpuVector::flush");
+
+                for(auto& [begin, end]: dirty) last_flush_bytes += (end - begin) * sizeof(T);
+                last_flush_ranges = dirty.size();
+
+                if(upload == GPU_VECTOR_STAGING) flushStaging();
+                else for(auto& [begin, end]: dirty) buffer->insert(begin, end - begin, shadow.data() + begin);
+
+                dirty.clear();
+                uploaded = shadow.size();
+            }
+
+            /*
+                The gpu copy, replaced when the vector grows so dont hold on to it (or its ID) across a flush
+            */
+            Buffer<T, type>& getBuffer(){
+                if(!buffer) grow(1);
+                return *buffer;
+            }
+            uint getID() {return getBuffer().getID();}
+
+            size_t getDirtyRangeCount() const {return dirty.size();}
+            size_t getLastFlushRangeCount() const {return last_flush_ranges;}
+            size_t getLastFlushBytes() const {return last_flush_bytes;}
+    };
+}
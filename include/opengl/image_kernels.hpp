@@ -0,0 +1,137 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <opengl/buffer.hpp>
+#include <opengl/post_process.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/shader_variants.hpp>
+#include <opengl/shaders.hpp>
+#include <opengl/texture.hpp>
+
+/*
+    Compute kernels working on Texture2D levels through image units.
+
+    Written textures need immutable storage (Texture2D::setup) in a format images can use:
+    GL_RGBA8, GL_RGBA16F, GL_RGBA32F, GL_RG8, GL_RG16F, GL_RG32F, GL_R8, GL_R16F, GL_R32F or GL_R11F_G11F_B10F.
+    Every kernel ends with the barriers needed to sample or render from its results.
+*/
+namespace Heptcore{
+    enum DownsampleMode{
+        DOWNSAMPLE_AVERAGE = 0,
+        DOWNSAMPLE_MIN = 1,
+        DOWNSAMPLE_MAX = 2
+    };
+
+    /*
+        Size and image format of one level of a texture
+    */
+    struct ImageLevel{
+        int width = 0;
+        int height = 0;
+        int internal_format = 0;
+        int levels = 0; // Of the whole texture, 0 for mutable storage
+    };
+    ImageLevel queryImageLevel(const BindableTexture& texture, int level = 0);
+    /*
+        GLSL layout qualifier for an internal format (rgba16f for GL_RGBA16F), throws for formats images cant use
+    */
+    std::string imageFormatQualifier(int internal_format);
+
+    /*
+        Fills the mip chain from level 0 in as few dispatches as possible (like AMD's single pass downsampler).
+
+        Every workgroup reduces a 64x64 tile through shared memory into 6 levels, the last workgroup to
+        finish (found through an atomic counter) carries on with 2 more. That is 8 levels per dispatch,
+        the number of image units every GL 4.5 implementation has, so a 4096 texture takes 2 dispatches
+        instead of the 12 passes of glGenerateMipmap or a fragment shader chain.
+    */
+    class Downsampler{
+        private:
+            ShaderVariantCache& cache;
+            Buffer<uint, GL_SHADER_STORAGE_BUFFER> counter = {};
+
+            static constexpr int levels_per_dispatch = 8;
+        public:
+            Downsampler(ShaderVariantCache& cache);
+
+            /*
+                Overwrites levels first_level + 1 and below.
+
+                Every texel reduces a 2x2 footprint of the level above, so with odd sizes the last row or
+                column of a level is dropped. Min and max only keep conservative bounds (Hi-Z) for power of
+                two sizes and throw for anything else, render the depth into a power of two texture first.
+                The average of an odd sized level is close enough for blurs and bloom and is allowed.
+            */
+            void generate(Texture2D& texture, DownsampleMode mode = DOWNSAMPLE_AVERAGE, int first_level = 0);
+    };
+
+    /*
+        Separable Gaussian blur, one horizontal and one vertical dispatch.
+
+        Each workgroup loads a row (or column) of 256 texels plus the kernel radius on both sides into
+        shared memory once, instead of every texel fetching 2 * radius + 1 neighbors from the texture.
+    */
+    class GaussianBlur{
+        private:
+            ShaderVariantCache& cache;
+            std::unique_ptr<Texture2D> temporary = nullptr;
+            ImageLevel temporary_level = {};
+
+            void ensureTemporary(const ImageLevel& level);
+        public:
+            static constexpr int max_radius = 64;
+
+            GaussianBlur(ShaderVariantCache& cache);
+
+            /*
+                Blurs one level in place, the radius is 3 sigma (clamped to max_radius)
+            */
+            void apply(Texture2D& texture, float sigma, int level = 0);
+    };
+
+    /*
+        Bloom through a half resolution mip pyramid.
+
+        The bright parts of the input go into level 0 (soft threshold), Downsampler fills the levels below,
+        then every level gets the tent filtered level under it added on the way back up. Level 0 ends
+        up holding the bloom, effect() adds it in a PostProcessChain.
+    */
+    class BloomPyramid{
+        private:
+            ShaderVariantCache& cache;
+            Downsampler downsampler;
+            std::unique_ptr<Texture2D> pyramid = nullptr;
+            int pyramid_width = 0;
+            int pyramid_height = 0;
+            int pyramid_levels = 0;
+
+            int max_levels;
+
+            void ensurePyramid(int width, int height);
+        public:
+            float threshold = 1.0f;
+            float knee = 0.5f; // Width of the soft transition around the threshold
+            float radius = 1.0f; // Scale of the upsampling tent filter, in texels of the smaller level
+
+            BloomPyramid(ShaderVariantCache& cache, int max_levels = 6);
+
+            /*
+                width and height are the size of input
+            */
+            void render(BindableTexture& input, int width, int height);
+
+            /*
+                Level 0 holds the result, bilinear filtered and clamped so it can be sampled straight away
+            */
+            Texture2D& getTexture();
+            int getLevels() {return pyramid_levels;}
+
+            /*
+                Adds the bloom to the color, set the texture with PostProcessChain::setTexture("heptcoreBloom", getTexture())
+                and add it before tone mapping
+            */
+            static PostEffect effect(float intensity = 0.05f);
+    };
+}
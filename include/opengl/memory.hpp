@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <atomic>
+#include <string>
+
+#include <core.hpp>
+
+namespace Heptcore{
+    enum MemoryCategory{
+        MEMORY_BUFFER = 0,
+        MEMORY_TEXTURE = 1,
+        MEMORY_RENDERBUFFER = 2,
+        MEMORY_CATEGORY_COUNT = 3
+    };
+
+    /*
+        Keeps count of the bytes every wrapper allocated on the gpu.
+
+        The numbers are what Heptcore asked for, the driver may pad or compress.
+    */
+    class GpuMemoryTracker{
+        private:
+            std::array<std::atomic<size_t>, MEMORY_CATEGORY_COUNT> usage = {};
+            std::array<std::atomic<size_t>, MEMORY_CATEGORY_COUNT> peak = {};
+            std::array<std::atomic<size_t>, MEMORY_CATEGORY_COUNT> allocations = {};
+
+        public:
+            void allocate(MemoryCategory category, size_t bytes);
+            void free(MemoryCategory category, size_t bytes);
+
+            size_t getUsage(MemoryCategory category) const { return usage[category].load(std::memory_order_relaxed); }
+            size_t getPeak(MemoryCategory category) const { return peak[category].load(std::memory_order_relaxed); }
+            size_t getAllocationCount(MemoryCategory category) const { return allocations[category].load(std::memory_order_relaxed); }
+            size_t getTotalUsage() const;
+
+            /*
+                Free video memory in bytes as reported by GL_NVX_gpu_memory_info or GL_ATI_meminfo,
+                returns 0 if neither is supported.
+            */
+            static size_t queryAvailableMemory();
+            /*
+                Total video memory in bytes (GL_NVX_gpu_memory_info only), 0 if unknown
+            */
+            static size_t queryTotalMemory();
+
+            static const char* getCategoryName(MemoryCategory category);
+    };
+
+    extern GpuMemoryTracker memoryTracker;
+
+    /*
+        Bytes per texel of a sized (or the basic unsized) internal format
+    */
+    size_t internalFormatSize(uint internal_format);
+
+    /*
+        Bytes taken by a 2D image and optionally all its mip levels
+    */
+    size_t textureMemorySize(uint internal_format, int width, int height, int levels = 1);
+
+    bool isExtensionSupported(const std::string& name);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opengl/framebuffer.hpp>
+#include <opengl/quad.hpp>
+#include <opengl/shader_variants.hpp>
+#include <opengl/shaders.hpp>
+#include <opengl/texture.hpp>
+
+namespace Heptcore{
+    /*
+        One full screen effect as a GLSL snippet.
+
+        Per pixel effects define    vec4 apply(vec4 color, vec2 uv)
+        Neighborhood effects define vec4 apply(sampler2D source, vec2 uv)
+        and may use postTexelSize (1 / source size). Helpers in the snippet should be prefixed with
+        something unique since fused snippets share one shader. Uniforms with the same name are shared
+        on purpose (set them with Uniform<T> as usual), their one line declarations are hoisted and
+        merged when snippets are fused, declaring the same name with a different type throws.
+    */
+    struct PostEffect{
+        std::string name;
+        std::string code;
+        bool neighborhood = false;
+        // Extra sampler2D uniforms the snippet reads (a LUT, a bloom texture), bound with PostProcessChain::setTexture
+        std::vector<std::string> textures = {};
+        bool enabled = true;
+
+        static PostEffect toneMapACES();
+        static PostEffect gamma(float gamma = 2.2f);
+        static PostEffect vignette(float strength = 0.5f);
+        static PostEffect fxaa();
+    };
+
+    /*
+        Runs a list of effects with as few full screen passes as possible.
+
+        A pass starts at the first effect and at every neighborhood effect (those need their
+        input in a texture), every per pixel effect after it is fused into the same generated shader.
+        Programs come from a ShaderVariantCache so identical passes share a program.
+    */
+    class PostProcessChain{
+        public:
+            struct Pass{
+                ShaderProgram* program = nullptr;
+                std::vector<std::string> effects = {};
+                std::vector<std::string> textures = {};
+                int texel_size_location = -1;
+            };
+
+        private:
+            ShaderVariantCache& cache;
+            std::vector<PostEffect> effects = {};
+            std::vector<std::pair<std::string, BindableTexture*>> textures = {};
+
+            std::vector<Pass> passes = {};
+            bool dirty = true;
+
+            FullscreenQuad quad = {};
+            std::unique_ptr<Framebuffer> intermediates[2] = {};
+            uint intermediate_format;
+            int intermediate_width = 0;
+            int intermediate_height = 0;
+
+            void build();
+            std::string generate(const std::vector<const PostEffect*>& fused, std::vector<std::string>& pass_textures);
+            void ensureIntermediates(int width, int height);
+            BindableTexture* findTexture(const std::string& name);
+        public:
+            /*
+                intermediate_format is used between passes, has to be sized
+            */
+            PostProcessChain(ShaderVariantCache& cache, uint intermediate_format = GL_RGBA16F);
+
+            size_t add(const PostEffect& effect);
+            void setEnabled(const std::string& name, bool enabled);
+            void setTexture(const std::string& name, BindableTexture& texture);
+
+            /*
+                Applies the chain to input and writes to output, nullptr is the window framebuffer.
+                width and height are the size of the output, the input may differ (postTexelSize follows it).
+                Depth test, blending and the viewport are restored afterwards.
+            */
+            void render(BindableTexture& input, int width, int height, Framebuffer* output = nullptr);
+
+            const std::vector<Pass>& getPasses();
+    };
+}
@@ -11,6 +11,13 @@ namespace Heptcore{
             Buffer<float, GL_ARRAY_BUFFER> quad_buffer = {};
         public:
             FullscreenQuad();
+
+            /*
+                The vao keeps a pointer to quad_buffer, moving has to point it at the new one
+            */
+            FullscreenQuad(FullscreenQuad&& other) noexcept;
+            FullscreenQuad& operator=(FullscreenQuad&& other) noexcept;
+
             void render();
     };
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <core.hpp>
+
+namespace Heptcore{
+    /*
+        32 bit handle into a ResourcePool, 20 bits slot and 12 bits generation.
+        Destroying a resource bumps the generation of its slot so old handles stop resolving
+        instead of pointing at whatever reuses the slot. The zero handle is never valid.
+    */
+    template <typename T>
+    struct Handle{
+        static constexpr uint32_t INDEX_BITS = 20;
+        static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+        static constexpr uint32_t MAX_GENERATION = (1u << (32 - INDEX_BITS)) - 1;
+
+        uint32_t value = 0;
+
+        uint32_t index() const {return value & INDEX_MASK;}
+        uint32_t generation() const {return value >> INDEX_BITS;}
+
+        explicit operator bool() const {return value != 0;}
+        bool operator==(const Handle& other) const = default;
+    };
+
+    /*
+        Owns move only GL wrappers (Buffer, Texture2D, Framebuffer...) in one contiguous array and hands out Handles.
+
+        Alive resources are kept packed, destroying one moves the last one into its place, so iterating
+        the pool touches nothing but live resources. Pointers from get() are only good until the next
+        create or destroy, hold on to the handle instead.
+
+        Destroyed resources are only invalidated right away, the objects themselves are kept until the
+        fence of the frame they were destroyed in retires (see endFrame), so their GL names arent deleted
+        and reused while the gpu may still read them and mapped memory stays valid.
+
+        Not thread safe, a pool belongs to the context that creates its resources.
+    */
+    template <typename T>
+    class ResourcePool{
+        private:
+            struct Slot{
+                uint32_t dense = 0; // Position in resources while alive
+                uint32_t generation = 1;
+                bool alive = false;
+            };
+
+            struct Retiring{
+                GLsync fence;
+                std::vector<T> resources;
+            };
+
+            std::vector<T> resources = {};
+            std::vector<uint32_t> owners = {}; // Slot of every resource
+            std::vector<Slot> slots = {};
+            std::vector<uint32_t> free_slots = {};
+
+            std::vector<T> destroyed = {}; // Since the last endFrame
+            std::deque<Retiring> retiring = {};
+
+            /*
+                Everything that can throw happens here, before the resource is added,
+                so a failed create leaves nothing behind without an owner
+            */
+            uint32_t reserveSlot(){
+                owners.reserve(resources.size() + 1);
+                if(free_slots.empty()){
+                    if(slots.size() > Handle<T>::INDEX_MASK) throw std::runtime_error("ResourcePool is out of handles.");
+                    slots.push_back({});
+                    free_slots.push_back(slots.size() - 1);
+                }
+
+                uint32_t index = free_slots.back();
+                free_slots.pop_back();
+                return index;
+            }
+
+            Handle<T> activateSlot(uint32_t index){
+                Slot& slot = slots[index];
+                slot.dense = resources.size() - 1;
+                slot.alive = true;
+                owners.push_back(index); // Reserved, doesnt allocate
+
+                return {index | (slot.generation << Handle<T>::INDEX_BITS)};
+            }
+
+            Slot* resolve(Handle<T> handle){
+                if(handle.index() >= slots.size()) return nullptr;
+
+                Slot& slot = slots[handle.index()];
+                if(!slot.alive || slot.generation != handle.generation()) return nullptr;
+                return &slot;
+            }
+
+            static bool signaled(GLsync fence, bool wait){
+                if(!wait){
+                    GLenum status = glClientWaitSync(fence, 0, 0);
+                    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+                }
+
+                while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+                return true;
+            }
+        public:
+            ResourcePool() = default;
+            ~ResourcePool(){
+                for(auto& entry: retiring) glDeleteSync(entry.fence);
+            }
+
+            ResourcePool(const ResourcePool&) = delete;
+            ResourcePool& operator=(const ResourcePool&) = delete;
+
+            /*
+                Constructs the resource in place
+            */
+            template <typename... Args>
+            Handle<T> create(Args&&... args){
+                uint32_t index = reserveSlot();
+                try{
+                    resources.emplace_back(std::forward<Args>(args)...);
+                }
+                catch(...){
+                    free_slots.push_back(index); // Just popped, fits without allocating
+                    throw;
+                }
+                return activateSlot(index);
+            }
+            Handle<T> insert(T&& resource){
+                return create(std::move(resource));
+            }
+
+            /*
+                nullptr for destroyed (or never created) resources
+            */
+            T* get(Handle<T> handle){
+                Slot* slot = resolve(handle);
+                return slot ? &resources[slot->dense] : nullptr;
+            }
+            bool contains(Handle<T> handle){return resolve(handle) != nullptr;}
+
+            /*
+                Invalidates the handle now, the resource itself is deleted once the gpu is done with this frame
+            */
+            bool destroy(Handle<T> handle){
+                Slot* slot = resolve(handle);
+                if(!slot) return false;
+
+                uint32_t dense = slot->dense;
+                destroyed.push_back(std::move(resources[dense]));
+
+                // Keep the array packed
+                if(dense + 1 != resources.size()){
+                    resources[dense] = std::move(resources.back());
+                    owners[dense] = owners.back();
+                    slots[owners[dense]].dense = dense;
+                }
+                resources.pop_back();
+                owners.pop_back();
+
+                slot->alive = false;
+                slot->generation = slot->generation == Handle<T>::MAX_GENERATION ? 1 : slot->generation + 1;
+                free_slots.push_back(handle.index());
+
+                return true;
+            }
+
+            /*
+                Call once the frame is submitted, fences everything destroyed during it
+                and deletes what earlier frames destroyed if the gpu is done with them
+            */
+            void endFrame(){
+                if(!destroyed.empty()){
+                    retiring.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(destroyed)});
+                    destroyed.clear();
+                }
+
+                collect();
+            }
+
+            /*
+                Deletes destroyed resources whose frame retired, with wait it blocks until all of them have
+            */
+            void collect(bool wait = false){
+                while(!retiring.empty() && signaled(retiring.front().fence, wait)){
+                    glDeleteSync(retiring.front().fence);
+                    retiring.pop_front();
+                }
+            }
+
+            /*
+                Destroys every resource, they are still deferred until endFrame
+            */
+            void clear(){
+                for(auto& resource: resources) destroyed.push_back(std::move(resource));
+                resources.clear();
+                owners.clear();
+
+                for(uint32_t i = 0; i < slots.size(); i++){
+                    if(!slots[i].alive) continue;
+                    slots[i].alive = false;
+                    slots[i].generation = slots[i].generation == Handle<T>::MAX_GENERATION ? 1 : slots[i].generation + 1;
+                    free_slots.push_back(i);
+                }
+            }
+
+            /*
+                The packed resources, in no particular order
+            */
+            auto begin() {return resources.begin();}
+            auto end() {return resources.end();}
+            T* data() {return resources.data();}
+            size_t size() const {return resources.size();}
+            bool empty() const {return resources.empty();}
+
+            /*
+                Handle of the resource at a position of the packed array
+            */
+            Handle<T> handleAt(size_t index){
+                uint32_t slot = owners[index];
+                return {slot | (slots[slot].generation << Handle<T>::INDEX_BITS)};
+            }
+
+            /*
+                Destroyed resources still waiting for their frame to retire
+            */
+            size_t getPendingCount() const {
+                size_t count = destroyed.size();
+                for(auto& entry: retiring) count += entry.resources.size();
+                return count;
+            }
+    };
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <core.hpp>
+
+namespace Heptcore{
+    /*
+        Everything about how a texture is sampled, independent of the texture itself
+    */
+    struct SamplerDescription{
+        int min_filter = GL_LINEAR_MIPMAP_LINEAR;
+        int mag_filter = GL_LINEAR;
+        int wrap_s = GL_REPEAT;
+        int wrap_t = GL_REPEAT;
+        int wrap_r = GL_REPEAT;
+        float anisotropy = 1.0f; // Maximum, 1 is off, clamped by SamplerCache::setAnisotropyLimit
+        float lod_bias = 0.0f;
+        float min_lod = -1000.0f;
+        float max_lod = 1000.0f;
+        int compare_mode = GL_NONE; // GL_COMPARE_REF_TO_TEXTURE for shadow samplers
+        int compare_function = GL_LEQUAL;
+
+        bool operator==(const SamplerDescription& other) const = default;
+
+        static SamplerDescription nearest(int wrap = GL_CLAMP_TO_EDGE);
+        static SamplerDescription linear(int wrap = GL_CLAMP_TO_EDGE);
+        static SamplerDescription trilinear(int wrap = GL_REPEAT, float anisotropy = 16.0f);
+        static SamplerDescription shadow();
+    };
+
+    struct SamplerDescriptionHash{
+        size_t operator()(const SamplerDescription& description) const;
+    };
+
+    class Sampler{
+        private:
+            uint sampler = 0;
+            SamplerDescription description;
+
+            void apply(float anisotropy_limit);
+
+            friend class SamplerCache;
+        public:
+            Sampler(const SamplerDescription& description, float anisotropy_limit);
+            ~Sampler();
+
+            Sampler(const Sampler&) = delete;
+            Sampler& operator=(const Sampler&) = delete;
+            Sampler(Sampler&& other) noexcept;
+            Sampler& operator=(Sampler&& other) noexcept;
+
+            /*
+                Binds to a texture unit, skipped if it already is bound there
+            */
+            void bind(int unit) const;
+            void unbind(int unit) const;
+
+            uint getID() const {return sampler;}
+            const SamplerDescription& getDescription() const {return description;}
+    };
+
+    /*
+        Hands out one shared sampler object per distinct description.
+
+        Sampler objects are shared between contexts like textures, so there is one cache per group of
+        contexts that share objects (a Window and its workers, a RenderFarm), kept in their ContextStates.
+        They are GL objects, clear() has to run while a context of the group is still current
+        (Window and RenderFarm do that on destruction).
+    */
+    class SamplerCache{
+        private:
+            std::unordered_map<SamplerDescription, std::unique_ptr<Sampler>, SamplerDescriptionHash> samplers = {};
+            std::mutex mutex; // Used from every thread with a shared context
+            float anisotropy_limit = 16.0f;
+            float hardware_anisotropy = 0.0f; // Queried on first use, stays 0 without anisotropic filtering
+            bool anisotropy_queried = false;
+
+            float effectiveLimit();
+        public:
+            Sampler& get(const SamplerDescription& description);
+
+            /*
+                Caps anisotropy of every sampler, 1 turns it off everywhere without touching any texture
+            */
+            void setAnisotropyLimit(float limit);
+            float getAnisotropyLimit() {return anisotropy_limit;}
+
+            size_t size(){
+                std::lock_guard<std::mutex> lock(mutex);
+                return samplers.size();
+            }
+            void clear();
+    };
+
+    /*
+        Cache of the context current on the calling thread
+    */
+    SamplerCache& samplerCache();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Heptcore{
+    /*
+        Define name to value, ordered so equal sets always produce the same source and key
+    */
+    using ShaderDefines = std::map<std::string, std::string>;
+
+    uint64_t hashString(const std::string& text, uint64_t seed = 14695981039346656037ull);
+
+    /*
+        Shader source with every #include resolved, doesnt depend on defines so it is cached per file
+    */
+    struct ExpandedShader{
+        std::string source = "";
+        uint64_t hash = 0;
+        std::vector<std::string> files = {}; // Indexed by the source string number used in #line
+        std::unordered_set<std::string> identifiers = {}; // Every identifier in the source, to drop defines nothing uses
+    };
+
+    /*
+        Resolves #include "file" (relative to the including file, then the include directories, then
+        named sources) and injects #define blocks right after #version.
+
+        Files containing #pragma once are only included once per shader, classic #ifndef guards work
+        too since the result goes through the regular GLSL preprocessor. #line directives keep
+        compiler errors pointing at the right file and line.
+    */
+    class ShaderPreprocessor{
+        private:
+            std::vector<std::string> include_directories = {};
+            std::unordered_map<std::string, std::string> named_sources = {};
+            struct CachedShader{
+                std::shared_ptr<const ExpandedShader> shader; // Swapped, never changed, so holders can read it unlocked
+                std::vector<std::filesystem::file_time_type> modified; // Of every file in shader.files when it was read
+            };
+            std::unordered_map<std::string, CachedShader> cache = {};
+            std::mutex mutex;
+
+            std::string readFile(const std::string& path);
+            std::string resolve(const std::string& name, const std::string& including_file, std::string& source);
+            void expandInto(const std::string& source, const std::string& filename, ExpandedShader& result, std::vector<std::string>& stack, std::unordered_set<std::string>& once);
+            ExpandedShader expandSource(const std::string& source, const std::string& filename);
+        public:
+            void addIncludeDirectory(const std::string& directory);
+            /*
+                Makes source includable as name without a file, for shaders embedded in the binary
+            */
+            void addSource(const std::string& name, const std::string& source);
+
+            /*
+                Loads and expands a file, cached until invalidate. check_modified reads it again if it or one
+                of its includes changed on disk since. A reload or invalidate replaces the cache entry,
+                the returned shader stays as it is for as long as it is held, so any thread may read it.
+            */
+            std::shared_ptr<const ExpandedShader> load(const std::string& filename, bool check_modified = false);
+            ExpandedShader expand(const std::string& source, const std::string& name = "source");
+
+            /*
+                Final source with defines inserted after #version, skip_unused leaves out defines the source never mentions
+            */
+            static std::string inject(const ExpandedShader& shader, const ShaderDefines& defines, bool skip_unused = false);
+
+            /*
+                Forgets cached files, for shader hot reloading
+            */
+            void invalidate();
+    };
+
+    extern ShaderPreprocessor shaderPreprocessor;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opengl/shader_preprocessor.hpp>
+#include <opengl/shaders.hpp>
+
+namespace Heptcore{
+    struct ShaderStage{
+        std::string path;
+        int type; // GL_VERTEX_SHADER, GL_FRAGMENT_SHADER...
+    };
+
+    /*
+        Compiles specialized shader permutations the first time they are asked for.
+
+        Variants are looked up by (hash of the expanded sources, define set). Defines the sources never
+        mention are dropped before compiling, so variants that only differ in those share one program.
+        Lookups are locked, so contexts sharing objects (workers, RenderFarm contexts) can use one cache.
+    */
+    class ShaderVariantCache{
+        private:
+            ShaderPreprocessor& preprocessor;
+
+            // Final injected sources hash to program, the actual deduplication
+            std::unordered_map<uint64_t, std::unique_ptr<ShaderProgram>> programs = {};
+            // (source hash, define set) to program, so repeated lookups skip injecting and hashing
+            std::unordered_map<std::string, ShaderProgram*> variants = {};
+            // Embedded sources by raw source hash, so getFromSources only expands them once
+            std::unordered_map<uint64_t, ExpandedShader> embedded = {};
+
+            size_t compiled = 0;
+            size_t requests = 0;
+
+            std::mutex mutex; // Held while compiling too, so a variant is only ever built once
+
+            static std::string variantKey(const std::vector<uint64_t>& hashes, const ShaderDefines& defines);
+            ShaderProgram& build(const std::vector<std::pair<const ExpandedShader*, int>>& stages, const ShaderDefines& defines, const std::string& key);
+        public:
+            ShaderVariantCache(ShaderPreprocessor& preprocessor = shaderPreprocessor): preprocessor(preprocessor) {}
+
+            ShaderVariantCache(const ShaderVariantCache&) = delete;
+            ShaderVariantCache& operator=(const ShaderVariantCache&) = delete;
+
+            /*
+                Returns the program for these files and defines, compiles it if it doesnt exist yet
+            */
+            ShaderProgram& get(const std::vector<ShaderStage>& stages, const ShaderDefines& defines = {});
+            ShaderProgram& get(const std::string& vertex_path, const std::string& fragment_path, const ShaderDefines& defines = {}){
+                return get({{vertex_path, GL_VERTEX_SHADER}, {fragment_path, GL_FRAGMENT_SHADER}}, defines);
+            }
+
+            /*
+                Same for sources that arent files (embedded shaders), each pair is (source, type)
+            */
+            ShaderProgram& getFromSources(const std::vector<std::pair<std::string, int>>& sources, const ShaderDefines& defines = {});
+
+            size_t getProgramCount(){
+                std::lock_guard<std::mutex> lock(mutex);
+                return programs.size();
+            }
+            size_t getVariantCount(){
+                std::lock_guard<std::mutex> lock(mutex);
+                return variants.size();
+            }
+            size_t getCompileCount(){
+                std::lock_guard<std::mutex> lock(mutex);
+                return compiled;
+            }
+            size_t getRequestCount(){
+                std::lock_guard<std::mutex> lock(mutex);
+                return requests;
+            }
+
+            /*
+                Deletes every program, references handed out before become invalid
+            */
+            void clear();
+    };
+}
@@ -10,6 +10,15 @@
 #include <fstream>
 #include <sstream>
 #include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <opengl/capture.hpp>
+#include <opengl/context_state.hpp>
+#include <opengl/debug.hpp>
+#include <opengl/shader_preprocessor.hpp>
+#include <opengl/stats.hpp>
 
 namespace Heptcore{
     class ShaderProgram;
@@ -22,23 +31,20 @@ namespace Heptcore{
             virtual std::string getName() = 0;
     };
 
+    /*
+        Uniform objects by name, applied to every program that has a uniform of that name.
+        One per ContextState (shared by default), see ContextState.
+    */
     class ShaderUniformLinker{
         private:
             std::unordered_set<std::string> ignored_uniforms; // Usually uniforms reserver for texture bindings
-            struct LinkedProgram{
-                // Uniforms and their location in the program
-                std::unordered_map<std::string, size_t> uniforms;
-            };
-
-            std::unordered_map<ShaderProgram*, LinkedProgram> shaderPrograms;
             std::unordered_map<std::string, UniformBase*> uniforms;
 
+            std::mutex mutex; // Uniforms can be created and programs updated from worker contexts
+
             void updateUniforms(ShaderProgram* program);
 
             void addUniform(UniformBase* uniform);
-            void addProgram(ShaderProgram* program);
-
-            void removeProgram(ShaderProgram* program);
             void removeUniform(UniformBase* uniform);
 
             friend class ShaderProgram;
@@ -46,26 +52,46 @@ namespace Heptcore{
             friend class Uniform;
         public:
             void ignore(std::string name){
+                std::lock_guard<std::mutex> lock(mutex);
                 ignored_uniforms.emplace(name);
             }
     };
 
-    extern ShaderUniformLinker uniformLinker;
+    /*
+        Linker of the context current on the calling thread
+    */
+    ShaderUniformLinker& uniformLinker();
 
-    static int programInUse = -1;
     class ShaderProgram{
         private:
             int program = -1;
             std::vector<int> shaders = {};
+            std::unordered_map<std::string, size_t> linked_uniforms = {}; // Name and location of every plain uniform
+
+            void linkUniforms();
+
+            friend class ShaderUniformLinker;
+#if HEPTCORE_CAPTURE
+            std::vector<std::pair<int, std::string>> sources = {}; // Type and source, captures recompile from them
+#endif
 
         public:
             ShaderProgram(){
                 this->program = glCreateProgram();
             }
             ~ShaderProgram(){
-                glDeleteProgram(this->program);
-                uniformLinker.removeProgram(this);
+                glDeleteProgram(this->program); // 0 after a move, deleting it is ignored
             }
+
+            ShaderProgram(const ShaderProgram&) = delete;
+            ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+            /*
+                Moving hands over the GL program and its linked uniforms
+            */
+            ShaderProgram(ShaderProgram&& other) noexcept;
+            ShaderProgram& operator=(ShaderProgram&& other) noexcept;
+
             ShaderProgram(std::string vertex_shader_path, std::string fragment_shader_path): ShaderProgram() {
                 addShader(vertex_shader_path, GL_VERTEX_SHADER);
                 addShader(fragment_shader_path, GL_FRAGMENT_SHADER);
@@ -83,23 +109,46 @@ namespace Heptcore{
                     std::cerr << "No sample under name '" << name << "' found." << std::endl;
                     return;
                 }
-                uniformLinker.ignore(name);
+                uniformLinker().ignore(name);
+                HEPTCORE_RECORD(uniform(name, GL_INT, 1, &slot));
+                HEPTCORE_RECORD_SUPPRESS();
                 glUniform1i(location,slot);
-            }
-            void addShader(std::string filename, int type);
-            void addShaderSource(std::string source, int type);
+                HEPTCORE_COUNT(uniform_uploads, 1);
+            }
+            /*
+                Loads through shaderPreprocessor, so #include works in shader files
+            */
+            void addShader(std::string filename, int type, const ShaderDefines& defines = {});
+            void addShaderSource(std::string source, int type, std::string name = "");
+            /*
+                Compiles an include-expanded shader with defines injected after #version
+            */
+            void addShaderSource(const ExpandedShader& shader, int type, const ShaderDefines& defines = {});
             void compile();
             void use(){
-                if(programInUse == program) return;
-                programInUse = program;
+                HEPTCORE_RECORD(useProgram(*this));
+                int& program_in_use = ContextState::current().program;
+                if(program_in_use == program){
+                    HEPTCORE_COUNT(redundant_binds_skipped, 1);
+                    return;
+                }
+                program_in_use = program;
+                HEPTCORE_COUNT(program_binds, 1);
                 //if(!glIsProgram(this->program)) std::cout << "Invalid program?" << std::endl;
                 glUseProgram(this->program);
             }
+            /*
+                Uploads the value of every Uniform of the current contexts linker this program uses
+            */
             void updateUniforms();
 
             int getUniformLocation(std::string name);
 
             int getID() {return program;};
+#if HEPTCORE_CAPTURE
+            const std::vector<std::pair<int, std::string>>& getSources() {return sources;}
+#endif
+            void label(const std::string& name) {labelObject(GL_PROGRAM, program, name);}
     };
 
     template <typename T>
@@ -107,16 +156,20 @@ namespace Heptcore{
         private:
             T value;
             std::string name;
+            std::shared_ptr<ShaderUniformLinker> linker; // Of the context current at creation, kept alive for the destructor
 
         public:
-            Uniform(const std::string& uniformName){
+            Uniform(const std::string& uniformName): linker(ContextState::current().getUniformLinker()){
                 this->name = uniformName;
-                uniformLinker.addUniform(reinterpret_cast<UniformBase*>(this));
+                linker->addUniform(reinterpret_cast<UniformBase*>(this));
             };
             ~Uniform(){
-                uniformLinker.removeUniform(reinterpret_cast<UniformBase*>(this));
+                linker->removeUniform(reinterpret_cast<UniformBase*>(this));
             }
 
+            Uniform(const Uniform&) = delete;
+            Uniform& operator=(const Uniform&) = delete;
+
             T& operator=(T newValue) {
                 value = newValue; 
                 return value;
@@ -133,27 +186,56 @@ namespace Heptcore{
             void update(uint location){
                 //std::cout << "Updating uniform: " << name << " at: " << programID << std::endl;
                 setUniformValue(value,  location);
+                HEPTCORE_COUNT(uniform_uploads, 1);
             }
 
             std::string getName() {return name; };
         private:
             void setUniformValue(const glm::mat4& mat, int32_t location) {
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_MAT4, 1, glm::value_ptr(mat)));
+                HEPTCORE_RECORD_SUPPRESS();
                 glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
             }
 
+            void setUniformValue(float value, int32_t location) {
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT, 1, &value));
+                HEPTCORE_RECORD_SUPPRESS();
+                glUniform1f(location, value);
+            }
+
+            void setUniformValue(const glm::vec2& vec, int32_t location) {
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_VEC2, 1, glm::value_ptr(vec)));
+                HEPTCORE_RECORD_SUPPRESS();
+                glUniform2fv(location, 1, glm::value_ptr(vec));
+            }
+
             void setUniformValue(const glm::vec3& vec, int32_t location) {
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_VEC3, 1, glm::value_ptr(vec)));
+                HEPTCORE_RECORD_SUPPRESS();
                 glUniform3fv(location, 1, glm::value_ptr(vec));
             }
 
+            void setUniformValue(const glm::vec4& vec, int32_t location) {
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_VEC4, 1, glm::value_ptr(vec)));
+                HEPTCORE_RECORD_SUPPRESS();
+                glUniform4fv(location, 1, glm::value_ptr(vec));
+            }
+
             void setUniformValue(const std::vector<glm::vec3>& vectors, int32_t location){
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_VEC3, (int) vectors.size(), glm::value_ptr(vectors[0])));
+                HEPTCORE_RECORD_SUPPRESS();
                 glUniform3fv(location, static_cast<GLsizei>(vectors.size()), glm::value_ptr(vectors[0]));
             }
 
             void setUniformValue(const std::vector<glm::mat4>& mats, int32_t location){
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_MAT4, (int) mats.size(), glm::value_ptr(mats[0])));
+                HEPTCORE_RECORD_SUPPRESS();
                 glUniformMatrix4fv(location, static_cast<GLsizei>(mats.size()), GL_FALSE, glm::value_ptr(mats[0]));
             }
 
             void setUniformValue(const std::vector<glm::mat3>& mats, int32_t location){
+                HEPTCORE_RECORD(uniform(name, GL_FLOAT_MAT3, (int) mats.size(), glm::value_ptr(mats[0])));
+                HEPTCORE_RECORD_SUPPRESS();
                 glUniformMatrix3fv(location, static_cast<GLsizei>(mats.size()), GL_FALSE, glm::value_ptr(mats[0]));
             }
     };
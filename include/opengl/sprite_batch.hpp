@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <opengl/buffer.hpp>
+#include <opengl/shaders.hpp>
+#include <opengl/texture.hpp>
+#include <opengl/vao.hpp>
+
+namespace Heptcore{
+    enum SpriteBlendMode{
+        SPRITE_BLEND_OPAQUE = 0,
+        SPRITE_BLEND_ALPHA = 1,
+        SPRITE_BLEND_PREMULTIPLIED = 2,
+        SPRITE_BLEND_ADDITIVE = 3
+    };
+
+    struct Sprite{
+        glm::vec2 position = glm::vec2(0.0f); // Center
+        glm::vec2 size = glm::vec2(1.0f);
+        float rotation = 0; // Radians around the center
+        glm::vec4 uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // Min and max corner
+        int texture_layer = 0;
+        glm::vec4 tint = glm::vec4(1.0f);
+
+        int layer = 0; // Draw order, lower first
+        SpriteBlendMode blend = SPRITE_BLEND_ALPHA;
+    };
+
+    /*
+        Draws large amounts of sprites from one TextureArray2D with a draw call per (layer, blend mode).
+
+        Sprites are binned by layer and blend mode as they are added so nothing has to be sorted,
+        each one is a single instance (14 floats) streamed through a persistently mapped ring buffer
+        and expanded into a quad in the vertex shader.
+    */
+    class SpriteBatch{
+        private:
+            struct Instance{
+                float position[2];
+                float size[2];
+                float uv[4];
+                float tint[4];
+                float rotation;
+                float texture_layer;
+            };
+            static_assert(sizeof(Instance) == 14 * sizeof(float), "Sprite instances have to be tightly packed.");
+
+            // Sprites in the same bin keep the order they were added in
+            std::map<uint32_t, std::vector<Instance>> bins = {};
+            uint32_t last_key = UINT32_MAX;
+            std::vector<Instance>* last_bin = nullptr;
+
+            size_t section_capacity;
+            static constexpr int SECTIONS = 3;
+            PersistentBuffer<Instance> instances;
+            GLsync section_fences[SECTIONS] = {};
+            int section = 0;
+            size_t section_used = 0;
+
+            uint vao = 0;
+            ShaderProgram program = {};
+            int view_projection_location = -1;
+
+            TextureArray2D* texture = nullptr;
+            glm::mat4 view_projection = glm::mat4(1.0f);
+            bool begun = false;
+
+            static uint32_t sortKey(int layer, SpriteBlendMode blend);
+            void applyBlendMode(SpriteBlendMode blend);
+            void nextSection();
+            void drawBin(const std::vector<Instance>& bin);
+        public:
+            /*
+                section_capacity is how many sprites fit into one of the three ring sections,
+                bigger bins are split into multiple draws
+            */
+            SpriteBatch(size_t section_capacity = 1 << 17);
+            ~SpriteBatch();
+
+            SpriteBatch(const SpriteBatch&) = delete;
+            SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+            void begin(TextureArray2D& texture, const glm::mat4& view_projection);
+            void draw(const Sprite& sprite);
+            /*
+                Draws everything added since begin, restores the blend state it changes
+            */
+            void end();
+
+            size_t getSectionCapacity() {return section_capacity;}
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <core.hpp>
+
+/*
+    Set by the HEPTCORE_ENABLE_STATS cmake option, with 0 every counter compiles to nothing
+*/
+#ifndef HEPTCORE_STATS
+#define HEPTCORE_STATS 1
+#endif
+
+#if HEPTCORE_STATS
+    #define HEPTCORE_COUNT(counter, amount) (Heptcore::renderStatistics.counters().counter += (amount))
+#else
+    #define HEPTCORE_COUNT(counter, amount) ((void)0)
+#endif
+
+namespace Heptcore{
+    struct RenderStatistics{
+        uint64_t draw_calls = 0;
+        uint64_t vertices = 0;
+        uint64_t instances = 0;
+        uint64_t dispatches = 0; // Compute
+
+        uint64_t program_binds = 0;
+        uint64_t vao_binds = 0;
+        uint64_t texture_binds = 0;
+        uint64_t sampler_binds = 0;
+        uint64_t framebuffer_binds = 0;
+        uint64_t redundant_binds_skipped = 0;
+
+        uint64_t uniform_uploads = 0;
+        uint64_t buffer_upload_bytes = 0;
+        uint64_t texture_upload_bytes = 0;
+
+        double cpu_frame_time = 0; // Milliseconds between the last two endFrame calls
+    };
+
+    /*
+        Per thread (and so per context) counters, Window::swapBuffers ends the frame.
+    */
+    class RenderStatisticsCollector{
+        private:
+            RenderStatistics current = {};
+            RenderStatistics last_frame = {};
+
+            bool record_history = false;
+            std::vector<RenderStatistics> history = {};
+
+            uint64_t frame = 0;
+            std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
+        public:
+            RenderStatistics& counters() {return current;}
+
+            /*
+                Snapshots the counters of the frame and resets them
+            */
+            void endFrame();
+
+            const RenderStatistics& getLastFrame() const {return last_frame;}
+            uint64_t getFrameCount() const {return frame;}
+
+            /*
+                Keeps every frame snapshot for writeCSV
+            */
+            void setHistoryEnabled(bool enabled) {record_history = enabled;}
+            const std::vector<RenderStatistics>& getHistory() const {return history;}
+            void clearHistory() {history.clear();}
+
+            static void writeCSVHeader(std::ostream& stream);
+            static void writeCSVRow(std::ostream& stream, const RenderStatistics& statistics);
+            void writeCSV(std::ostream& stream) const;
+            bool writeCSV(const std::string& filename) const;
+    };
+
+    extern thread_local RenderStatisticsCollector renderStatistics;
+}
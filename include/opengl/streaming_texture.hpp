@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+
+#include <core.hpp>
+#include <opengl/texture.hpp>
+
+namespace Heptcore{
+    /*
+        RGBA8 texture whose mip levels arrive over time, coarsest first.
+
+        Storage for the whole chain is allocated up front (immutable), the small levels are uploaded
+        right away so the texture is usable immediately at low detail. Finer levels are uploaded by a
+        TextureStreamer within its per frame budget, up to the level the texture was requested at.
+        GL_TEXTURE_BASE_LEVEL always points at the finest uploaded level so nothing samples levels
+        that arent there yet (it is texture state, a bound Sampler doesnt override it like MIN_LOD).
+
+        With ARB_sparse_texture only the resident levels have memory committed, levels that stay
+        unrequested for a while are decommitted again. The cpu copy of every level above the mip tail
+        is kept for that, about 4/3 of the image in system memory for the life of the texture.
+        Without sparse storage the uploaded levels stay and their cpu copies are freed.
+
+        If the file cant be loaded the texture has no levels, requests and the streamer ignore it.
+    */
+    class StreamingTexture2D: public BindableTexture{
+        private:
+            int width = 0;
+            int height = 0;
+            int levels = 0;
+            std::vector<std::vector<unsigned char>> chain = {}; // Cpu copies of the levels
+
+            int resident_level = 0; // Finest uploaded level, every coarser one is resident too
+            int requested_level = 0; // Finest level requested since the last update
+            int wanted_level = 0; // What the requests of the last frame settled on
+            int unneeded_frames = 0; // Frames the finest resident level wasnt wanted
+
+            bool sparse = false;
+            int tail_level = 0; // First level of the mip tail, sparse levels from here on are committed together
+
+            void load(const unsigned char* data, int width, int height, bool allow_sparse);
+            bool setupSparse();
+            void commit(int level, bool commit);
+            void setResidentLevel(int level);
+            void updateMemorySize();
+
+            size_t getLevelSize(int level) const;
+            /*
+                Resolves the requests of the frame, decommits long unneeded levels
+            */
+            void endFrame(int drop_delay);
+            /*
+                Uploads the next finer level, returns its size
+            */
+            size_t uploadNextLevel();
+
+            friend class TextureStreamer;
+        public:
+            /*
+                Levels up to initial_size texels wide and high are uploaded by the constructor
+            */
+            StreamingTexture2D(const char* filename, bool allow_sparse = true, int initial_size = 64);
+            StreamingTexture2D(const unsigned char* data, int width, int height, bool allow_sparse = true, int initial_size = 64);
+
+            /*
+                Asks for a level this frame, the finest request of a frame wins.
+                Not requesting a texture for a frame lets it drop detail (sparse only).
+            */
+            void requestLevel(int level);
+            /*
+                Requests the level matching how many pixels the whole texture (uv 0 to 1) covers on screen,
+                one texel per pixel
+            */
+            void requestScreenSize(float pixels_wide, float pixels_high);
+
+            int getWidth() const {return width;}
+            int getHeight() const {return height;}
+            int getLevelCount() const {return levels;}
+            bool isLoaded() const {return levels > 0;}
+            int getResidentLevel() const {return resident_level;}
+            int getWantedLevel() const {return wanted_level;}
+            bool isSparse() const {return sparse;}
+            bool isStreamed() const {return resident_level <= wanted_level;}
+    };
+
+    /*
+        Uploads the levels StreamingTexture2Ds are missing, call update() once per frame after the requests.
+
+        The textures furthest from the level they want go first, one level at a time, so everything
+        gets usable detail before anything gets full detail.
+    */
+    class TextureStreamer{
+        private:
+            std::vector<StreamingTexture2D*> textures = {};
+
+            size_t upload_budget = 16 * 1024 * 1024;
+            int drop_delay = 120;
+            size_t last_upload = 0;
+        public:
+            /*
+                Not owned, remove before destroying the texture
+            */
+            void add(StreamingTexture2D* texture);
+            void remove(StreamingTexture2D* texture);
+
+            void update();
+
+            void setUploadBudget(size_t bytes) {upload_budget = bytes;}
+            /*
+                Frames a sparse level has to go unrequested before its memory is decommitted
+            */
+            void setDropDelay(int frames) {drop_delay = frames;}
+            /*
+                Bytes the last update uploaded
+            */
+            size_t getLastUploadSize() {return last_upload;}
+            size_t getTextureCount() {return textures.size();}
+    };
+}
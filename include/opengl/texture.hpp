@@ -5,24 +5,71 @@
 #include <string>
 #include <iostream>
 #include <array>
+#include <utility>
 #include <unordered_map>
 #include <glm/glm.hpp>
 
 #include <core.hpp>
+#include <opengl/capture.hpp>
+#include <opengl/context_state.hpp>
+#include <opengl/debug.hpp>
+#include <opengl/memory.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/stats.hpp>
 
 namespace Heptcore{
+    /*
+        Samplers per texture unit go through the same bind cache as textures, 0 unbinds
+    */
+    void bindSampler(int unit, uint sampler);
+    uint getBoundSampler(int unit);
+    /*
+        Unbinds every texture and sampler in the bind cache of the current context
+    */
+    void unbindAllTextures();
+
+    /*
+        Every mip level of an RGBA8 image (2x2 box filter), [0] is a copy of the image itself
+    */
+    std::vector<std::vector<unsigned char>> buildMipChain(const unsigned char* data, int width, int height);
+
     class BindableTexture{
         protected: 
             uint texture = 0;
             uint TYPE = GL_TEXTURE_2D;
+            size_t memory_size = 0;
+
             BindableTexture();
             virtual ~BindableTexture();
+
+            /*
+                Moving hands over the GL name, the moved from texture is left without one
+            */
+            BindableTexture(BindableTexture&& other) noexcept;
+            BindableTexture& operator=(BindableTexture&& other) noexcept;
+
+            /*
+                Reports the size of the current storage to the memory tracker
+            */
+            void setMemorySize(size_t bytes);
         public:
+            BindableTexture(const BindableTexture&) = delete;
+            BindableTexture& operator=(const BindableTexture&) = delete;
+
+            /*
+                Binds with the textures own parameters, a sampler left on the unit is unbound
+            */
             void bind(int unit) const;
+            /*
+                Binds with sampler overriding the textures parameters
+            */
+            void bind(int unit, const Sampler& sampler) const;
             void unbind(int unit) const;
             void parameter(int identifier, int value);
             uint getType() const;
             uint getID() const;
+            void label(const std::string& name) {labelObject(GL_TEXTURE, texture, name);}
+            size_t getMemorySize() const {return memory_size;}
     };
 
     class Texture2D: public BindableTexture{
@@ -35,6 +82,14 @@ namespace Heptcore{
             Texture2D(const char* filename);
             Texture2D(unsigned char* data, int width, int height);
             void configure(int internal_format, int format, int data_type, int width, int height, void* data = nullptr);
+            /*
+                Allocates immutable storage for the given amount of mip levels
+            */
+            void setup(int width, int height, int levels = 1, int internal_format = GL_RGBA8);
+            /*
+                Uploads a whole mip level into storage created by setup
+            */
+            void upload(int level, int width, int height, const void* data, int format = GL_RGBA, int data_type = GL_UNSIGNED_BYTE);
             void reset();
     };
 
@@ -44,18 +99,25 @@ namespace Heptcore{
             void setup(int width, int height, int layers){
                 bind(0);
                 glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, width, height,  layers);
+                setMemorySize(textureMemorySize(GL_RGBA8, width, height) * layers);
+                HEPTCORE_RECORD(textureData(texture, TYPE));
             }
             void loadFromFiles(std::vector<std::string>& filenames, int layerWidth, int layerHeight);
     };
 
     class Skybox: public BindableTexture{
         private:
-            uint vertexBufferID;
-            uint vao;
+            uint vertexBufferID = 0;
+            uint vao = 0;
         public:
-            void load(std::array<std::string, 6> filenames);
+            Skybox() = default;
             ~Skybox();
 
+            Skybox(Skybox&& other) noexcept;
+            Skybox& operator=(Skybox&& other) noexcept;
+
+            void load(std::array<std::string, 6> filenames);
+
             void draw();
     };
 }
\ No newline at end of file
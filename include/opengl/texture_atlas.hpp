@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <opengl/texture.hpp>
+
+namespace Heptcore{
+    /*
+        A texture that hands out rectangular regions (shelf packing) and grows when it runs out of space.
+
+        Regions are in pixels and stay valid when the atlas grows, normalize them with the
+        current size (or textureSize in a shader) at the time of use.
+    */
+    class TextureAtlas{
+        public:
+            struct Region{
+                int x = 0;
+                int y = 0;
+                int width = 0;
+                int height = 0;
+            };
+
+        private:
+            struct Shelf{
+                int y;
+                int height;
+                int x; // Next free column
+            };
+
+            std::unique_ptr<Texture2D> texture = nullptr;
+            int width;
+            int height;
+            int internal_format;
+            int format;
+            int padding = 1;
+
+            std::vector<Shelf> shelves = {};
+            uint64_t generation = 0;
+
+            void grow();
+        public:
+            TextureAtlas(int width = 512, int height = 512, int internal_format = GL_R8, int format = GL_RED);
+
+            /*
+                Finds space for a width x height region, grows the atlas if there is none
+            */
+            Region allocate(int width, int height);
+            void upload(const Region& region, const void* data, int data_type = GL_UNSIGNED_BYTE);
+
+            /*
+                Forgets all regions, the texture keeps its size
+            */
+            void clear();
+
+            Texture2D& getTexture() {return *texture;}
+            int getWidth() {return width;}
+            int getHeight() {return height;}
+            /*
+                Changes every time the atlas grows (and so the texture object changes)
+            */
+            uint64_t getGeneration() {return generation;}
+    };
+}
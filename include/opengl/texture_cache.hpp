@@ -0,0 +1,91 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <opengl/texture.hpp>
+
+namespace Heptcore{
+    /*
+        Keeps file backed textures resident within a video memory budget.
+
+        Least recently used textures get evicted when a new one doesnt fit, they are loaded from
+        disk again the next time they are requested. Loads upload the small mip levels first, the
+        full resolution arrives over the following frames within the per frame upload budget.
+
+        Pointers returned by get() are only valid until the next call to get() or update(),
+        request the texture again every frame you use it.
+    */
+    class TextureCache{
+        private:
+            struct Entry{
+                std::unique_ptr<Texture2D> texture = nullptr;
+                size_t memory = 0;
+                uint64_t last_used = 0;
+                std::list<std::string>::iterator lru_position;
+
+                int width = 0;
+                int height = 0;
+                int resident_level = 0; // Finest level uploaded so far, everything coarser is resident too
+                std::vector<std::vector<unsigned char>> pending_levels = {}; // Cpu copies of the levels not uploaded yet
+            };
+
+            // Only resident textures have an entry, evicting one forgets it completely
+            std::unordered_map<std::string, Entry> entries = {};
+            std::list<std::string> lru = {}; // Front is the most recently used
+
+            std::unordered_set<std::string> failed = {}; // Files that couldnt be loaded, not tried again until evicted
+            size_t max_failed = 1024; // Forgotten all at once beyond this, a retry then costs one more load
+
+            size_t budget;
+            size_t resident_memory = 0;
+            size_t upload_budget = 16 * 1024 * 1024;
+            int initial_skip_levels = 2;
+            uint64_t frame = 1;
+
+            bool load(const std::string& path, Entry& entry);
+            void unload(Entry& entry);
+            void erase(std::unordered_map<std::string, Entry>::iterator iterator);
+            void makeRoom(size_t bytes);
+        public:
+            TextureCache(size_t budget);
+
+            /*
+                nullptr if the file cant be loaded, that is remembered (and reported once) until evict(path)
+                or until too many other files failed as well
+            */
+            Texture2D* get(const std::string& path);
+
+            /*
+                Call once per frame, uploads pending mip levels and ends the frame (textures used in the
+                current frame are never evicted)
+            */
+            void update();
+
+            void evict(const std::string& path);
+            void clear();
+
+            void setBudget(size_t bytes);
+            size_t getBudget() {return budget;}
+            size_t getResidentMemory() {return resident_memory;}
+
+            void setUploadBudget(size_t bytes) {upload_budget = bytes;}
+            /*
+                How many of the largest mip levels get deferred when a texture is loaded
+            */
+            void setInitialSkipLevels(int levels) {initial_skip_levels = levels;}
+
+            bool isResident(const std::string& path);
+            bool isFullyResident(const std::string& path);
+
+            /*
+                A fraction of the currently free video memory plus what the cache already holds,
+                fallback is used when the driver doesnt report memory.
+            */
+            size_t recommendedBudget(float fraction = 0.75f, size_t fallback = 1024ull * 1024 * 1024);
+    };
+}
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <initializer_list>
+#include <utility>
 
 #include <opengl/buffer.hpp>
 
@@ -20,8 +21,11 @@ namespace Heptcore{
             bool per_instance = false;
         public:
             VertexFormat(std::initializer_list<VertexBindingType> bindings, bool per_instance = false);
+            VertexFormat(const std::vector<VertexBindingType>& bindings, bool per_instance = false);
             void apply(uint& slot);
-            uint getVertexSize(){return totalSize;}
+            uint getVertexSize() const {return totalSize;}
+            const std::vector<VertexBindingType>& getBindings() const {return bindings;}
+            bool isPerInstance() const {return per_instance;}
     };
 
     /*
@@ -42,7 +46,19 @@ namespace Heptcore{
                 glGenVertexArrays(1,  &vao_id);
             }
             ~VertexArrayObject(){
-                glDeleteVertexArrays(1,  &vao_id);
+                glDeleteVertexArrays(1,  &vao_id); // 0 after a move, deleting it is ignored
+            }
+
+            VertexArrayObject(const VertexArrayObject&) = delete;
+            VertexArrayObject& operator=(const VertexArrayObject&) = delete;
+
+            VertexArrayObject(VertexArrayObject&& other) noexcept:
+                vao_id(std::exchange(other.vao_id, 0)),
+                buffers(std::move(other.buffers)){}
+            VertexArrayObject& operator=(VertexArrayObject&& other) noexcept{
+                std::swap(vao_id, other.vao_id);
+                std::swap(buffers, other.buffers);
+                return *this;
             }
 
             size_t attachBuffer(Buffer<float, GL_ARRAY_BUFFER>* buffer_pointer, VertexFormat format){
@@ -53,10 +69,19 @@ namespace Heptcore{
                 return format.getVertexSize();
             }
 
+            /*
+                Points an attached buffer at its new address after the owner moved it, the gl state is
+                unchanged since the buffer name moves with it
+            */
+            void replaceBuffer(const Buffer<float, GL_ARRAY_BUFFER>* old_pointer, Buffer<float, GL_ARRAY_BUFFER>* buffer_pointer){
+                for(auto& buffer: buffers) if(buffer.buffer_pointer == old_pointer) buffer.buffer_pointer = buffer_pointer;
+            }
+
             void attachBuffer(Buffer<uint, GL_ELEMENT_ARRAY_BUFFER>* buffer){
                 bind();
                 buffer->bind();
                 unbind();
+                HEPTCORE_RECORD(vertexArrayChanged(vao_id));
             }
 
             /*
@@ -73,12 +98,27 @@ namespace Heptcore{
                 }
 
                 unbind();
+                HEPTCORE_RECORD(vertexArrayChanged(vao_id));
             }
             void bind() const {
+                HEPTCORE_RECORD(bindVertexArray(vao_id));
+                HEPTCORE_COUNT(vao_binds, 1);
                 glBindVertexArray(vao_id);
             }
             void unbind() const {
                 glBindVertexArray(0);
             }
+
+            /*
+                Binds the vao and draws, leaves it bound. Going through these instead of glDraw* lets captures see the draw
+            */
+            void draw(uint mode, int first, int count, int instances = 1);
+            /*
+                offset is in bytes into the element buffer
+            */
+            void drawIndexed(uint mode, int count, uint index_type = GL_UNSIGNED_INT, size_t offset = 0, int instances = 1);
+
+            uint getID() const {return vao_id;}
+            void label(const std::string& name) {labelObject(GL_VERTEX_ARRAY, vao_id, name);}
     };
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include <window.hpp>
+#include <opengl/context_state.hpp>
+#include <opengl/framebuffer.hpp>
+#include <opengl/shader_variants.hpp>
+
+namespace Heptcore
+{
+    struct RenderFarmSettings{
+        size_t contexts = 0; // 0 is one per hardware thread
+        int samples = 0; // Of the render targets, resolved before the readback
+        FramebufferDepth depth = DEPTH_24;
+        bool debug = false;
+
+        // Mesa llvmpipe only goes up to 4.5
+        int version_major = 4;
+        int version_minor = 5;
+
+        size_t readbacks_in_flight = 3; // Per context, rendering the next job overlaps with reading these back
+    };
+
+    /*
+        RGBA8 pixels, rows bottom to top like glReadPixels
+    */
+    struct RenderImage{
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels = {};
+    };
+
+    class RenderFarmContext;
+
+    class RenderJob{
+        private:
+            std::function<void(RenderFarmContext&)> function;
+            std::function<void(RenderImage&)> on_complete;
+            RenderImage image = {};
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::atomic<bool> complete = false;
+            std::exception_ptr error = nullptr;
+
+            void finish(std::exception_ptr error = nullptr);
+
+            friend class RenderFarm;
+        public:
+            RenderJob(int width, int height, std::function<void(RenderFarmContext&)> function, std::function<void(RenderImage&)> on_complete):
+                function(std::move(function)), on_complete(std::move(on_complete)), image{width, height} {}
+
+            RenderJob(const RenderJob&) = delete;
+            RenderJob& operator=(const RenderJob&) = delete;
+
+            /*
+                Doesnt need a GL context, true once the pixels are read back (or the job threw)
+            */
+            bool isComplete() const {return complete.load(std::memory_order_acquire);}
+            /*
+                Blocks until complete, rethrows what the job threw
+            */
+            void wait();
+            /*
+                Waits, the image stays valid as long as the job does
+            */
+            RenderImage& getImage();
+    };
+
+    /*
+        One of the contexts of a RenderFarm, what a job gets to render with
+    */
+    class RenderFarmContext{
+        private:
+            struct Readback{
+                std::shared_ptr<RenderJob> job;
+                uint buffer;
+                size_t bytes;
+                GLsync fence;
+            };
+
+            size_t index;
+            GLFWwindow* context;
+            ContextState state;
+            std::thread thread;
+
+            std::unique_ptr<Framebuffer> target = nullptr;
+            std::deque<Readback> readbacks = {};
+            std::vector<std::pair<uint, size_t>> free_buffers = {}; // Pixel pack buffers and their size
+
+            std::unordered_map<std::type_index, std::shared_ptr<void>> locals = {};
+            ShaderVariantCache programs = {};
+
+            friend class RenderFarm;
+        public:
+            RenderFarmContext(size_t index, GLFWwindow* context, std::shared_ptr<ShaderUniformLinker> linker, std::shared_ptr<SamplerCache> samplers):
+                index(index), context(context), state(std::move(linker), std::move(samplers)) {}
+
+            RenderFarmContext(const RenderFarmContext&) = delete;
+            RenderFarmContext& operator=(const RenderFarmContext&) = delete;
+
+            size_t getIndex() {return index;}
+            /*
+                Bound with the viewport set and cleared before the job runs, read back after
+            */
+            Framebuffer& getTarget() {return *target;}
+            ContextState& getState() {return state;}
+            /*
+                Programs of this context only. Uniform values belong to the program object, every context
+                drawing with one shared program would overwrite the uniforms of the jobs running beside it.
+            */
+            ShaderVariantCache& getPrograms() {return programs;}
+
+            /*
+                A T owned by this context, constructed from args the first time it is asked for.
+                For the objects that arent shared between contexts (VertexArrayObject, Framebuffer)
+                and for anything a job wants to keep between jobs, like Uniforms.
+            */
+            template <typename T, typename... Args>
+            T& getLocal(Args&&... args){
+                auto& local = locals[std::type_index(typeid(T))];
+                if(!local) local = std::make_shared<T>(std::forward<Args>(args)...);
+                return *static_cast<T*>(local.get());
+            }
+    };
+
+    /*
+        Renders independent jobs on several headless contexts at once, one thread each.
+
+        All contexts share objects with each other (and with the Window if given one), so meshes and
+        textures made in load() are there for every job. Programs are shared too, but their uniform
+        values are part of the program, so jobs get theirs from RenderFarmContext::getPrograms (built
+        once per context, the sources are only expanded once). Every context has its own ContextState
+        and uniform linker, Uniforms made inside a job only reach the programs updated on that context.
+
+        Jobs go to whichever context is free next. Each renders into the target of its context, the
+        pixels are read back through a pixel pack buffer and collected once the gpu is done, while
+        the context moves on to the next job. With llvmpipe every context rasterizes on its own core.
+    */
+    class RenderFarm{
+        private:
+            RenderFarmSettings settings;
+            bool owns_glfw;
+
+            GLFWwindow* loader; // Hidden context every other one shares with, current during load()
+            ContextState loader_state;
+            std::vector<std::unique_ptr<RenderFarmContext>> contexts = {};
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<std::shared_ptr<RenderJob>> jobs = {};
+            size_t outstanding = 0; // Submitted and not complete yet
+            std::condition_variable idle;
+            bool running = true;
+
+            GLFWwindow* createContext(GLFWwindow* share);
+            void start();
+
+            void run(RenderFarmContext& context);
+            void render(RenderFarmContext& context, std::shared_ptr<RenderJob> job);
+            void complete(const std::shared_ptr<RenderJob>& job, std::exception_ptr error);
+            /*
+                Collects every finished readback, or waits for the oldest one
+            */
+            void collectReadbacks(RenderFarmContext& context, bool wait);
+            void releaseResources(RenderFarmContext& context);
+        public:
+            /*
+                Without a Window, initializes (and on destruction terminates) glfw itself,
+                dont create Windows while it lives
+            */
+            RenderFarm(RenderFarmSettings settings = {});
+            /*
+                Shares objects with window, has to be destroyed before it
+            */
+            RenderFarm(Window& window, RenderFarmSettings settings = {});
+            /*
+                Finishes every submitted job first, has to be called on the thread that created the farm
+            */
+            ~RenderFarm();
+
+            RenderFarm(const RenderFarm&) = delete;
+            RenderFarm& operator=(const RenderFarm&) = delete;
+
+            /*
+                Runs function with the loader context current on the calling thread and waits for the gpu,
+                for creating the shared read only resources jobs use. Not while jobs that use them are running.
+            */
+            void load(const std::function<void()>& function);
+
+            /*
+                Queues a job rendering a width x height image, callable from any thread.
+                on_complete runs on the farm thread with the pixels, before the job counts as complete.
+            */
+            std::shared_ptr<RenderJob> submit(int width, int height, std::function<void(RenderFarmContext&)> function,
+                std::function<void(RenderImage&)> on_complete = nullptr);
+
+            /*
+                Waits until every job submitted so far is complete
+            */
+            void finish();
+
+            size_t getContextCount() {return contexts.size();}
+            size_t pending();
+    };
+}
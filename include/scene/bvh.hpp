@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <core.hpp>
+#include <scene/frustum.hpp>
+#include <thread_pool.hpp>
+
+namespace Heptcore{
+    /*
+        Four children of a Bvh node, structure of arrays so one SIMD register holds the same bound
+        of all four (bounds[BVH_MIN_X] are the min x of children 0 to 3)
+    */
+    struct alignas(16) BvhNode{
+        float bounds[6][4];
+        int32_t child[4];  // Node index, -1 when the slot is a leaf
+        uint32_t first[4]; // Everything under the slot is this range of Bvh::getObjectOrder()
+        uint32_t count[4]; // 0 for an unused slot
+    };
+
+    enum BvhBound{
+        BVH_MIN_X = 0,
+        BVH_MIN_Y = 1,
+        BVH_MIN_Z = 2,
+        BVH_MAX_X = 3,
+        BVH_MAX_Y = 4,
+        BVH_MAX_Z = 5
+    };
+
+    static_assert(sizeof(BvhNode) == 144, "BvhNode layout changed.");
+
+    /*
+        Bounding volume hierarchy over the objects of a scene for frustum culling.
+
+        Built top down with a binned surface area heuristic, then collapsed into a 4 wide tree stored
+        as one flat array (children always come after their parent). Each node tests all four of its
+        children against a plane at once (SSE), and subtrees completely inside the frustum are
+        accepted without testing anything below them, their objects are one contiguous range.
+
+        Objects are indices into the bounds passed to build. Moving objects only need update and a
+        refit before the next cull, which regrows the boxes of the nodes above them. The tree keeps
+        its shape so it slowly gets worse as objects move far, rebuild when getSahCost grew a lot
+        (or every few hundred frames). Adding or removing objects needs a rebuild.
+    */
+    class Bvh{
+        private:
+            struct CullPlanes;
+
+            std::vector<BvhNode> nodes = {};
+            std::vector<uint32_t> parents = {};
+
+            std::vector<uint32_t> order = {}; // Objects in leaf order
+            std::vector<Aabb> ordered_bounds = {}; // Bounds in the same order, leaves read them contiguously
+            std::vector<uint32_t> positions = {}; // Of every object in order
+            std::vector<uint32_t> object_nodes = {}; // Node whose leaf slot holds the object
+
+            std::vector<uint32_t> dirty = {};
+            std::vector<uint8_t> node_dirty = {};
+
+            size_t max_leaf_size;
+
+            /*
+                Tests the children of a node, visible objects go into visible and
+                children that still need testing into descend, returns how many
+            */
+            int visitNode(uint32_t index, const CullPlanes& planes, std::vector<uint>& visible, uint32_t descend[4]) const;
+            void cullSubtree(uint32_t root, const CullPlanes& planes, std::vector<uint>& visible) const;
+        public:
+            /*
+                max_leaf_size is how many objects a leaf can hold before the build has to split it
+            */
+            Bvh(size_t max_leaf_size = 4): max_leaf_size(max_leaf_size){}
+
+            void build(const std::vector<Aabb>& bounds);
+
+            /*
+                New bounds for an object, applied to the tree by the next refit
+            */
+            void update(uint object, const Aabb& bounds);
+            /*
+                Regrows every node above an updated object, children first
+            */
+            void refit();
+
+            /*
+                Clears visible and fills it with every object whose box intersects the frustum (conservative)
+            */
+            void cull(const Frustum& frustum, std::vector<uint>& visible) const;
+            /*
+                Same, with the subtrees spread over the pool. The order of visible differs from the single threaded cull.
+            */
+            void cull(const Frustum& frustum, std::vector<uint>& visible, ThreadPool& pool) const;
+
+            /*
+                Sum of the surface areas of all boxes weighted like the heuristic does,
+                relative to the root box, lower is better
+            */
+            float getSahCost() const;
+
+            size_t getNodeCount() const {return nodes.size();}
+            size_t getObjectCount() const {return order.size();}
+            size_t getDirtyCount() const {return dirty.size();}
+            const Aabb& getBounds(uint object) const {return ordered_bounds[positions[object]];}
+            const std::vector<uint32_t>& getObjectOrder() const {return order;}
+            const std::vector<BvhNode>& getNodes() const {return nodes;}
+    };
+
+    /*
+        One draw worth of visible objects sharing a key (usually the mesh they are an instance of)
+    */
+    struct VisibleBatch{
+        uint key;
+        uint first; // Into the grouped objects, the base instance
+        uint count; // Instance count
+    };
+
+    /*
+        Layout of one glMultiDrawElementsIndirect command
+    */
+    struct DrawElementsIndirectCommand{
+        uint count = 0;
+        uint instance_count = 0;
+        uint first_index = 0;
+        int base_vertex = 0;
+        uint base_instance = 0;
+    };
+
+    /*
+        Sorts visible objects by object_keys[object] (a counting sort, keys below key_count) into grouped,
+        one batch per key that has visible objects. Uploaded as an instance buffer, grouped[base_instance + gl_InstanceID]
+        is the object an instance draws.
+    */
+    void groupVisible(const std::vector<uint>& visible, const std::vector<uint>& object_keys, uint key_count,
+        std::vector<uint>& grouped, std::vector<VisibleBatch>& batches);
+
+    /*
+        One indirect command per batch, count, first_index and base_vertex come from key_commands[batch.key]
+    */
+    void buildIndirectCommands(const std::vector<VisibleBatch>& batches, const std::vector<DrawElementsIndirectCommand>& key_commands,
+        std::vector<DrawElementsIndirectCommand>& commands);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Heptcore{
+    /*
+        Axis aligned bounding box in world space
+    */
+    struct Aabb{
+        glm::vec3 min = {0,0,0};
+        glm::vec3 max = {0,0,0};
+
+        glm::vec3 center() const {return (min + max) * 0.5f;}
+        glm::vec3 extent() const {return max - min;}
+        float surfaceArea() const {
+            glm::vec3 size = max - min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        void grow(const Aabb& other){
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+        void grow(const glm::vec3& point){
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        // Grows into anything, the identity for grow
+        static Aabb empty(){
+            return {glm::vec3(1e30f), glm::vec3(-1e30f)};
+        }
+    };
+
+    /*
+        Six planes facing into the frustum, xyz is the normal and w the distance (dot(normal, point) + w >= 0 is inside)
+    */
+    struct Frustum{
+        glm::vec4 planes[6] = {};
+
+        /*
+            Extracts the planes from projection * view (OpenGL clip space, -w <= z <= w)
+        */
+        static Frustum fromMatrix(const glm::mat4& view_projection){
+            auto row = [&](int i){
+                return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+            };
+            glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+            Frustum frustum = {};
+            frustum.planes[0] = w + x; // Left
+            frustum.planes[1] = w - x; // Right
+            frustum.planes[2] = w + y; // Bottom
+            frustum.planes[3] = w - y; // Top
+            frustum.planes[4] = w + z; // Near
+            frustum.planes[5] = w - z; // Far
+
+            for(auto& plane: frustum.planes) plane = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+            return frustum;
+        }
+
+        /*
+            Conservative, boxes near a frustum corner can pass without being visible
+        */
+        bool intersects(const Aabb& box) const {
+            for(auto& plane: planes){
+                // The corner furthest along the normal
+                glm::vec3 positive = {
+                    plane.x > 0 ? box.max.x : box.min.x,
+                    plane.y > 0 ? box.max.y : box.min.y,
+                    plane.z > 0 ? box.max.z : box.min.z
+                };
+                if(plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0) return false;
+            }
+            return true;
+        }
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Heptcore
+{
+    /*
+        Lock free ring buffer for exactly one producer thread and one consumer thread.
+
+        push and pop never block or allocate, a full queue rejects the element instead.
+        Each side keeps a copy of the other sides index and only rereads the atomic
+        when that copy says full (or empty), so the two threads rarely touch the same cache line.
+    */
+    template <typename T>
+    class SpscQueue{
+        private:
+            static constexpr size_t CACHE_LINE = 64;
+
+            std::unique_ptr<T[]> elements;
+            size_t mask;
+
+            alignas(CACHE_LINE) std::atomic<size_t> head = 0; // Next to pop, written by the consumer
+            size_t cached_tail = 0; // Consumer only
+
+            alignas(CACHE_LINE) std::atomic<size_t> tail = 0; // Next to push, written by the producer
+            size_t cached_head = 0; // Producer only
+
+            static size_t roundUp(size_t capacity){
+                size_t rounded = 2;
+                while(rounded < capacity) rounded *= 2;
+                return rounded;
+            }
+        public:
+            /*
+                Capacity is rounded up to a power of two
+            */
+            SpscQueue(size_t capacity): elements(std::make_unique<T[]>(roundUp(capacity))), mask(roundUp(capacity) - 1){}
+
+            SpscQueue(const SpscQueue&) = delete;
+            SpscQueue& operator=(const SpscQueue&) = delete;
+
+            /*
+                Producer thread only, false when the queue is full
+            */
+            bool push(const T& element){
+                size_t position = tail.load(std::memory_order_relaxed);
+                if(position - cached_head > mask){
+                    cached_head = head.load(std::memory_order_acquire);
+                    if(position - cached_head > mask) return false;
+                }
+
+                elements[position & mask] = element;
+                tail.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            /*
+                Consumer thread only, false when the queue is empty
+            */
+            bool pop(T& element){
+                size_t position = head.load(std::memory_order_relaxed);
+                if(position == cached_tail){
+                    cached_tail = tail.load(std::memory_order_acquire);
+                    if(position == cached_tail) return false;
+                }
+
+                element = elements[position & mask];
+                head.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            /*
+                Only a snapshot when the other thread is active
+            */
+            size_t size() const {return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);}
+            bool empty() const {return size() == 0;}
+            size_t capacity() const {return mask + 1;}
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include <opengl/texture_atlas.hpp>
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+namespace Heptcore{
+    /*
+        A FreeType face rasterized on demand into a shared TextureAtlas.
+
+        Glyphs are rendered once at base_size as signed distance fields (when the FreeType
+        build supports it) so the same atlas entry works at any size.
+    */
+    class Font{
+        public:
+            struct Glyph{
+                TextureAtlas::Region region = {};
+                float bearing_x = 0; // Base size pixels
+                float bearing_y = 0;
+                float advance = 0;
+            };
+
+            struct ShapedGlyph{
+                uint32_t codepoint;
+                float x; // Pen position in base size pixels, y grows down from the first baseline
+                float y;
+            };
+
+            struct ShapedRun{
+                std::vector<ShapedGlyph> glyphs = {};
+                float width = 0;
+                float height = 0;
+            };
+
+        private:
+            FT_LibraryRec_* library = nullptr;
+            FT_FaceRec_* face = nullptr;
+
+            TextureAtlas& atlas;
+            int base_size;
+            int spread;
+            bool sdf = true;
+
+            std::unordered_map<uint32_t, Glyph> glyphs = {};
+            std::unordered_map<std::string, ShapedRun> runs = {};
+            size_t max_cached_runs = 4096;
+
+            Glyph rasterize(uint32_t codepoint);
+        public:
+            Font(const std::string& filename, TextureAtlas& atlas, int base_size = 48, int spread = 8);
+            ~Font();
+
+            Font(const Font&) = delete;
+            Font& operator=(const Font&) = delete;
+
+            const Glyph& getGlyph(uint32_t codepoint);
+
+            /*
+                Lays out a utf-8 string (kerning, newlines), the result is cached by the string.
+                The reference is only valid until the next call to shape, a full cache gets cleared to make room.
+            */
+            const ShapedRun& shape(const std::string& text);
+
+            int getBaseSize() {return base_size;}
+            /*
+                Distance field range in base size pixels, 0 if glyphs are plain coverage
+            */
+            float getSpread() {return sdf ? (float) spread : 0.0f;}
+            bool isSDF() {return sdf;}
+            float getLineHeight();
+            float getAscender();
+
+            void setMaxCachedRuns(size_t count) {max_cached_runs = count;}
+    };
+}
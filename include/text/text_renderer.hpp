@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <opengl/buffer.hpp>
+#include <opengl/shaders.hpp>
+#include <opengl/texture_atlas.hpp>
+#include <opengl/vao.hpp>
+#include <text/font.hpp>
+
+namespace Heptcore{
+    /*
+        Collects text for a frame and draws all of it with a single draw call.
+
+        All fonts share one glyph atlas, texture coordinates are kept in atlas pixels so
+        glyphs added after the atlas grew in the same frame still line up.
+    */
+    class TextRenderer{
+        private:
+            TextureAtlas atlas = {};
+            std::vector<std::unique_ptr<Font>> fonts = {};
+
+            ShaderProgram program = {};
+            VertexArrayObject vao = {};
+            Buffer<float, GL_ARRAY_BUFFER> vertex_buffer = {};
+            std::vector<float> vertices = {};
+
+            int screen_size_location = -1;
+
+            void pushVertex(float x, float y, float u, float v, const glm::vec4& color, float sdf);
+        public:
+            TextRenderer();
+
+            // Fonts hold a reference to the atlas and the vao a pointer to vertex_buffer
+            TextRenderer(const TextRenderer&) = delete;
+            TextRenderer& operator=(const TextRenderer&) = delete;
+
+            /*
+                Loads a font that renders into the shared atlas, the reference stays valid as long as the renderer
+            */
+            Font& loadFont(const std::string& filename, int base_size = 48);
+
+            /*
+                Queues text with its top left corner at position (pixels, y down), size is the pixel height of a line
+            */
+            void add(Font& font, const std::string& text, glm::vec2 position, float size, glm::vec4 color = glm::vec4(1.0f));
+
+            /*
+                Draws everything queued since the last render and clears the queue
+            */
+            void render(int screen_width, int screen_height);
+            void clear() {vertices.clear();}
+
+            TextureAtlas& getAtlas() {return atlas;}
+    };
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Heptcore
+{
+    /*
+        Tasks that are waited on together, see ThreadPool::run and ThreadPool::wait
+    */
+    class TaskGroup{
+        private:
+            std::atomic<size_t> pending = 0;
+
+            std::mutex mutex;
+            std::exception_ptr error = nullptr; // First exception thrown by one of the tasks
+
+            friend class ThreadPool;
+        public:
+            TaskGroup() = default;
+
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+
+            bool isDone() const {return pending.load(std::memory_order_acquire) == 0;}
+    };
+
+    /*
+        Cpu worker threads (no GL contexts, use ContextWorker for that) with work stealing.
+
+        Every worker has its own deque, tasks a worker submits go to the back of its own deque and it
+        takes them from the back again (newest first, still hot in cache). A worker that runs dry steals
+        from the front of another one, where the oldest and usually biggest tasks are, so uneven work
+        like traversing unbalanced subtrees spreads out by itself. Tasks from outside the pool go into
+        a separate queue every worker steals from.
+
+        The thread calling wait runs tasks too, so a pool with 0 threads still works (everything
+        runs on the waiting thread).
+    */
+    class ThreadPool{
+        private:
+            struct Task{
+                std::function<void()> function;
+                TaskGroup* group;
+            };
+
+            struct Queue{
+                std::mutex mutex;
+                std::deque<Task> tasks = {};
+            };
+
+            std::vector<std::thread> threads = {};
+            std::vector<std::unique_ptr<Queue>> queues = {}; // One per worker, the last one for outside submissions
+
+            std::atomic<size_t> queued = 0;
+            std::atomic<bool> running = true;
+            std::mutex sleep_mutex;
+            std::condition_variable sleep;
+
+            void workerLoop(size_t index);
+            /*
+                The own queue from the back first, then steals from the front of the others
+            */
+            bool take(size_t index, Task& task);
+            void execute(Task& task);
+            size_t currentQueue();
+        public:
+            /*
+                threads defaults to one less than the hardware threads, the waiting thread makes up for it
+            */
+            ThreadPool(size_t threads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /*
+                Queues a task, callable from any thread including from inside tasks
+            */
+            void run(TaskGroup& group, std::function<void()> function);
+            /*
+                Runs queued tasks until every task of the group is done,
+                then rethrows the first exception one of them threw
+            */
+            void wait(TaskGroup& group);
+
+            /*
+                Calls function(begin, end) over [0, count) in chunks of at most grain and waits for all of them
+            */
+            template <typename F>
+            void parallelFor(size_t count, size_t grain, F&& function){
+                if(count == 0) return;
+                if(grain == 0) grain = 1;
+
+                TaskGroup group = {};
+                for(size_t begin = 0; begin < count; begin += grain){
+                    size_t end = std::min(begin + grain, count);
+                    run(group, [&function, begin, end]{ function(begin, end); });
+                }
+                wait(group);
+            }
+
+            /*
+                Worker threads, not counting whoever waits
+            */
+            size_t getThreadCount() const {return threads.size();}
+    };
+}
@@ -2,20 +2,113 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <input.hpp>
+#include <spsc_queue.hpp>
+#include <worker.hpp>
+#include <opengl/debug.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/stats.hpp>
 
 namespace Heptcore
 {
+    struct WindowSettings{
+        bool visible = true;
+        // Only the default framebuffer, with MSAA Framebuffers for the 3d passes this can be 0
+        int samples = 4;
+        bool vsync = false;
+        // Creates debug contexts and installs debugOutput on them (slower, driver validates more)
+        bool debug = false;
+
+        // Falls back to 4.5 if the driver cant create a 4.6 context (Mesa llvmpipe only goes up to 4.5)
+        int version_major = 4;
+        int version_minor = 6;
+
+        size_t input_queue_size = 4096; // Events that can wait for the render thread, more are dropped
+    };
+
     class Window{
         private:
             GLFWwindow* window;
+            WindowSettings settings;
+            ContextState state = {nullptr, std::make_shared<SamplerCache>()}; // Samplers of its own, shared with its workers
+
+            std::vector<std::unique_ptr<ContextWorker>> workers = {};
+            size_t next_worker = 0;
+
+            // Filled by the glfw callbacks on the event thread, drained by whoever renders
+            SpscQueue<InputEvent> input_queue;
+            InputState input = {};
+            std::atomic<size_t> dropped_input = 0;
+
+            std::thread::id event_thread;
+            std::atomic<bool> rendering = false;
+
+            void applyContextHints();
+            void installCallbacks();
+            void queueInput(const InputEvent& event);
+            /*
+                Flushes and releases the context (and its state) so another thread can take it over
+            */
+            void releaseContext();
         public:
-            Window(int width, int height, std::string title);
+            Window(int width, int height, std::string title, WindowSettings settings = {});
+
+            /*
+                Creates a hidden context shared with this window and a thread that owns it,
+                has to be called from the thread that created the window.
+            */
+            ContextWorker& createWorker();
+            /*
+                Submits to the workers in turns, creates one if there are none
+            */
+            std::shared_ptr<WorkerTask> submit(std::function<void()> function);
+            size_t getWorkerCount() {return workers.size();}
+            ContextWorker& getWorker(size_t index) {return *workers.at(index);}
             
+            GLFWwindow* getHandle() {return window;}
+            ContextState& getContextState() {return state;}
+
             bool shouldClose();
             void swapBuffers();
+            /*
+                Processes events, does nothing while run() handles them
+            */
             void pollEvents();
 
+            /*
+                Runs the glfw event loop on this (the main) thread and frame on a render thread that owns
+                the context, every frame is followed by swapBuffers. Returns once the window should close.
+
+                A long frame or a blocking swap no longer holds up events, and dragging or resizing the
+                window no longer stops rendering. The context takes its ContextState along to the render thread,
+                so bindings made before still hold. Workers have to be created before, exceptions thrown
+                by frame end the loop and are rethrown here.
+            */
+            void run(std::function<void(Window&)> frame);
+
+            /*
+                Applies everything the event thread queued so far, call right before submitting
+                so the frame uses the newest input. Only from the thread that renders.
+            */
+            InputState& sampleInput();
+            /*
+                Takes the next queued event (and applies it), for text input and such
+            */
+            bool pollInput(InputEvent& event);
+            InputState& getInput() {return input;}
+            /*
+                Events lost to a full queue, the render thread didnt sample input for too long
+            */
+            size_t getDroppedInputCount() {return dropped_input.load(std::memory_order_relaxed);}
+
             ~Window();
     };
 } 
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opengl/context_state.hpp>
+
+namespace Heptcore
+{
+    /*
+        glfwMakeContextCurrent that switches the Heptcore state (bind caches, uniform linker) along with the context,
+        (nullptr, nullptr) releases the current one
+    */
+    void makeContextCurrent(GLFWwindow* context, ContextState* state);
+
+    /*
+        Fences of tasks destroyed on a thread without a context, their worker deletes them
+    */
+    struct OrphanedFences{
+        std::mutex mutex;
+        std::vector<GLsync> fences = {};
+    };
+
+    /*
+        Handle to work submitted to a ContextWorker.
+
+        The worker places a fence after the task, the task counts as complete
+        only once the gpu is done with everything it issued.
+    */
+    class WorkerTask{
+        private:
+            std::function<void()> function;
+
+            std::atomic<bool> executed = false;
+            GLsync fence = nullptr;
+            std::weak_ptr<OrphanedFences> orphaned_fences = {}; // Of the worker that placed the fence
+            std::exception_ptr error = nullptr;
+
+            friend class ContextWorker;
+        public:
+            WorkerTask(std::function<void()> function): function(std::move(function)) {}
+            virtual ~WorkerTask();
+
+            /*
+                Non blocking, call on the render thread (or any thread with a shared context current)
+            */
+            bool isComplete();
+            /*
+                Blocks until the task is complete
+            */
+            void wait();
+    };
+
+    template <typename T>
+    class WorkerResource: public WorkerTask{
+        private:
+            std::unique_ptr<T> resource = nullptr;
+
+        public:
+            template <typename... Args>
+            WorkerResource(Args... args): WorkerTask([this, args...](){ resource = std::make_unique<T>(args...); }) {}
+
+            /*
+                Returns nullptr until the task is complete
+            */
+            T* get(){
+                if(!isComplete()) return nullptr;
+                return resource.get();
+            }
+            std::unique_ptr<T> take(){
+                wait();
+                return std::move(resource);
+            }
+    };
+
+    /*
+        A hidden context sharing objects with a Window, owned by its own thread.
+
+        Buffers, textures, shader programs and sync objects are shared between the contexts.
+        Container objects (VertexArrayObject, Framebuffer) are not, those need to be created
+        on the thread that uses them.
+    */
+    class ContextWorker{
+        private:
+            GLFWwindow* context;
+            ContextState state;
+            std::thread thread;
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<std::shared_ptr<WorkerTask>> tasks = {};
+            bool running = true;
+
+            std::shared_ptr<OrphanedFences> orphaned_fences = std::make_shared<OrphanedFences>();
+
+            void run();
+            void deleteOrphanedFences();
+        public:
+            /*
+                Takes ownership of the context window, has to be constructed and destroyed on the main thread (glfw requirement).
+                Uniforms created in tasks go to linker (the default one if nullptr), samplers come from
+                samplers, which has to be the cache of the context it shares objects with.
+            */
+            ContextWorker(GLFWwindow* context, std::shared_ptr<ShaderUniformLinker> linker = nullptr, std::shared_ptr<SamplerCache> samplers = nullptr);
+            ~ContextWorker();
+
+            ContextWorker(const ContextWorker&) = delete;
+            ContextWorker& operator=(const ContextWorker&) = delete;
+
+            std::shared_ptr<WorkerTask> submit(std::function<void()> function);
+
+            /*
+                Constructs a T on the worker thread, for example createResource<Texture2D>("image.png")
+            */
+            template <typename T, typename... Args>
+            std::shared_ptr<WorkerResource<T>> createResource(Args... args){
+                auto task = std::make_shared<WorkerResource<T>>(args...);
+                submit(task);
+                return task;
+            }
+
+            void submit(std::shared_ptr<WorkerTask> task);
+
+            size_t pending();
+    };
+}
@@ -0,0 +1,296 @@
+#include <mesh/mesh_file.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Heptcore;
+
+static size_t alignUp(size_t value){
+    return (value + mesh_file_alignment - 1) & ~(mesh_file_alignment - 1);
+}
+
+MeshBounds Heptcore::computeMeshBounds(const Mesh& mesh){
+    MeshBounds bounds = {};
+    if(mesh.vertexCount() == 0) return bounds;
+
+    bounds.min = mesh.position(0);
+    bounds.max = bounds.min;
+    for(uint vertex = 1; vertex < mesh.vertexCount(); vertex++){
+        glm::vec3 position = mesh.position(vertex);
+        bounds.min = glm::min(bounds.min, position);
+        bounds.max = glm::max(bounds.max, position);
+    }
+
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    for(uint vertex = 0; vertex < mesh.vertexCount(); vertex++)
+        bounds.radius = std::max(bounds.radius, glm::distance(bounds.center, mesh.position(vertex)));
+
+    return bounds;
+}
+
+void Heptcore::writeMeshFile(const std::string& filename, const std::vector<MeshFileStreamData>& streams, const uint* indices, size_t index_count, MeshBounds bounds, const MeshletData* meshlets){
+    MeshFileHeader header = {};
+    header.stream_count = (uint32_t) streams.size();
+    header.index_count = (uint32_t) index_count;
+
+    for(int i = 0; i < 3; i++){
+        header.bounds_min[i] = bounds.min[i];
+        header.bounds_max[i] = bounds.max[i];
+        header.center[i] = bounds.center[i];
+    }
+    header.radius = bounds.radius;
+
+    std::vector<MeshFileStream> stream_headers(streams.size());
+
+    size_t offset = alignUp(sizeof(MeshFileHeader) + sizeof(MeshFileStream) * streams.size());
+    for(size_t i = 0; i < streams.size(); i++){
+        auto& bindings = streams[i].format.getBindings();
+        if(bindings.size() > mesh_file_max_bindings) throw std::logic_error("Too many bindings in a mesh file stream.");
+
+        auto& stream = stream_headers[i];
+        stream.vertex_count = (uint32_t) streams[i].vertex_count;
+        stream.binding_count = (uint32_t) bindings.size();
+        for(size_t b = 0; b < bindings.size(); b++) stream.bindings[b] = (uint8_t) bindings[b];
+        stream.per_instance = streams[i].format.isPerInstance();
+        stream.offset = offset;
+        stream.size = streams[i].vertex_count * streams[i].format.getVertexSize() * sizeof(float);
+
+        offset = alignUp(offset + stream.size);
+    }
+
+    header.index_offset = offset;
+    header.file_size = offset + index_count * sizeof(uint);
+
+    bool has_meshlets = meshlets && !meshlets->meshlets.empty();
+    size_t meshlet_vertex_offset = 0, meshlet_triangle_offset = 0;
+    if(has_meshlets){
+        header.meshlet_count = (uint32_t) meshlets->meshlets.size();
+        header.meshlet_vertex_count = (uint32_t) meshlets->vertices.size();
+        header.meshlet_triangle_count = (uint32_t) (meshlets->triangles.size() / 3);
+
+        header.meshlet_offset = alignUp(header.file_size);
+        meshlet_vertex_offset = alignUp(header.meshlet_offset + meshlets->meshlets.size() * sizeof(Meshlet));
+        meshlet_triangle_offset = alignUp(meshlet_vertex_offset + meshlets->vertices.size() * sizeof(uint));
+        header.file_size = meshlet_triangle_offset + header.meshlet_triangle_count * 3;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) throw std::runtime_error("Failed to open mesh file for writing: " + filename);
+
+    const char padding[mesh_file_alignment] = {};
+    auto pad = [&](){
+        size_t position = (size_t) file.tellp();
+        file.write(padding, alignUp(position) - position);
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(stream_headers.data()), sizeof(MeshFileStream) * stream_headers.size());
+    pad();
+
+    for(size_t i = 0; i < streams.size(); i++){
+        file.write(reinterpret_cast<const char*>(streams[i].data), stream_headers[i].size);
+        pad();
+    }
+
+    file.write(reinterpret_cast<const char*>(indices), index_count * sizeof(uint));
+
+    if(has_meshlets){
+        pad();
+        file.write(reinterpret_cast<const char*>(meshlets->meshlets.data()), meshlets->meshlets.size() * sizeof(Meshlet));
+        pad();
+        file.write(reinterpret_cast<const char*>(meshlets->vertices.data()), meshlets->vertices.size() * sizeof(uint));
+        pad();
+        file.write(reinterpret_cast<const char*>(meshlets->triangles.data()), header.meshlet_triangle_count * 3);
+    }
+
+    if(!file.good()) throw std::runtime_error("Failed to write mesh file: " + filename);
+}
+
+void Heptcore::writeMeshFile(const std::string& filename, const Mesh& mesh, const VertexFormat& format, const MeshletData* meshlets){
+    if(format.getVertexSize() != mesh.vertex_size) throw std::logic_error("Vertex format doesnt match the mesh vertex size.");
+
+    writeMeshFile(filename, {{format, mesh.vertices.data(), mesh.vertexCount()}}, mesh.indices.data(), mesh.indices.size(), computeMeshBounds(mesh), meshlets);
+}
+
+MappedMesh::MappedMesh(const std::string& filename){
+    file_descriptor = open(filename.c_str(), O_RDONLY);
+    if(file_descriptor < 0) throw std::runtime_error("Failed to open mesh file: " + filename);
+
+    struct stat file_stat = {};
+    if(fstat(file_descriptor, &file_stat) != 0 || (size_t) file_stat.st_size < mesh_file_v1_header_size){
+        close();
+        throw std::runtime_error("Invalid mesh file: " + filename);
+    }
+
+    mapping_size = (size_t) file_stat.st_size;
+    mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if(mapping == MAP_FAILED){
+        mapping = nullptr;
+        close();
+        throw std::runtime_error("Failed to map mesh file: " + filename);
+    }
+
+    // The whole file is going to be read front to back by the upload
+    madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+    madvise(mapping, mapping_size, MADV_WILLNEED);
+
+    auto invalid = [&](const char* reason){
+        close();
+        throw std::runtime_error("Invalid mesh file '" + filename + "': " + reason);
+    };
+
+    // Version 1 files end the header at radius and have no meshlets, the rest stays zeroed
+    const char* bytes = static_cast<const char*>(mapping);
+    std::memcpy(reinterpret_cast<char*>(&header), bytes, mesh_file_v1_header_size);
+    if(std::memcmp(header.magic, "HPMS", 4) != 0) invalid("wrong magic");
+    if(header.version != 1 && header.version != mesh_file_version) invalid("unsupported version");
+
+    size_t header_size = header.version == 1 ? mesh_file_v1_header_size : sizeof(MeshFileHeader);
+    if(header_size > mapping_size) invalid("truncated header");
+    if(header.version != 1) std::memcpy(reinterpret_cast<char*>(&header), bytes, sizeof(MeshFileHeader));
+    streams = reinterpret_cast<const MeshFileStream*>(bytes + header_size);
+
+    // Everything below is compared by subtraction so offsets near 2^64 cant wrap past the checks
+    auto outOfBounds = [&](uint64_t offset, uint64_t size){
+        return offset > mapping_size || size > mapping_size - offset;
+    };
+
+    if(header.file_size > mapping_size) invalid("truncated");
+    if(outOfBounds(header_size, sizeof(MeshFileStream) * (uint64_t) header.stream_count)) invalid("truncated stream table");
+
+    uint64_t vertex_count = UINT32_MAX;
+    for(size_t i = 0; i < header.stream_count; i++){
+        auto& stream = streams[i];
+        if(stream.binding_count > mesh_file_max_bindings) invalid("too many bindings");
+        if(stream.offset % mesh_file_alignment != 0) invalid("misaligned stream");
+        if(outOfBounds(stream.offset, stream.size)) invalid("stream out of bounds");
+
+        uint vertex_size = 0;
+        for(size_t b = 0; b < stream.binding_count; b++) vertex_size += stream.bindings[b];
+        if(stream.size != (uint64_t) stream.vertex_count * vertex_size * sizeof(float)) invalid("stream size doesnt match its format");
+
+        if(!stream.per_instance) vertex_count = std::min<uint64_t>(vertex_count, stream.vertex_count);
+    }
+    if(vertex_count == UINT32_MAX) vertex_count = 0;
+
+    if(header.index_offset % mesh_file_alignment != 0) invalid("misaligned indices");
+    if(outOfBounds(header.index_offset, (uint64_t) header.index_count * sizeof(uint))) invalid("indices out of bounds");
+
+    // Indices go straight into draw calls, one past the last vertex reads whatever the driver has there
+    const uint* indices = getIndices();
+    for(size_t i = 0; i < header.index_count; i++)
+        if(indices[i] >= vertex_count) invalid("index out of range");
+
+    if(header.meshlet_count > 0){
+        uint64_t meshlets_size = (uint64_t) header.meshlet_count * sizeof(Meshlet);
+        if(header.meshlet_offset % mesh_file_alignment != 0) invalid("misaligned meshlets");
+        if(outOfBounds(header.meshlet_offset, meshlets_size)) invalid("meshlets out of bounds");
+
+        meshlet_vertex_offset = alignUp(header.meshlet_offset + meshlets_size);
+        if(outOfBounds(meshlet_vertex_offset, (uint64_t) header.meshlet_vertex_count * sizeof(uint))) invalid("meshlet vertices out of bounds");
+        meshlet_triangle_offset = alignUp(meshlet_vertex_offset + header.meshlet_vertex_count * sizeof(uint));
+        if(outOfBounds(meshlet_triangle_offset, (uint64_t) header.meshlet_triangle_count * 3)) invalid("meshlet triangles out of bounds");
+
+        const Meshlet* meshlets = getMeshlets();
+        const uint* meshlet_vertices = getMeshletVertices();
+        const uint8_t* meshlet_triangles = getMeshletTriangles();
+        for(size_t m = 0; m < header.meshlet_count; m++){
+            auto& meshlet = meshlets[m];
+            if((uint64_t) meshlet.vertex_offset + meshlet.vertex_count > header.meshlet_vertex_count) invalid("meshlet vertex range out of bounds");
+            if((uint64_t) meshlet.triangle_offset + meshlet.triangle_count > header.meshlet_triangle_count) invalid("meshlet triangle range out of bounds");
+
+            for(size_t v = 0; v < meshlet.vertex_count; v++)
+                if(meshlet_vertices[meshlet.vertex_offset + v] >= vertex_count) invalid("meshlet vertex out of range");
+            for(size_t t = 0; t < meshlet.triangle_count * (size_t) 3; t++)
+                if(meshlet_triangles[meshlet.triangle_offset * (size_t) 3 + t] >= meshlet.vertex_count) invalid("meshlet triangle index out of range");
+        }
+    }
+}
+
+MappedMesh::~MappedMesh(){
+    close();
+}
+
+void MappedMesh::close(){
+    if(mapping) munmap(mapping, mapping_size);
+    if(file_descriptor >= 0) ::close(file_descriptor);
+
+    mapping = nullptr;
+    file_descriptor = -1;
+}
+
+VertexFormat MappedMesh::getStreamFormat(size_t stream) const{
+    if(stream >= header.stream_count) throw std::logic_error("Mesh stream out of range.");
+
+    auto& description = streams[stream];
+    std::vector<VertexBindingType> bindings(description.binding_count);
+    for(size_t b = 0; b < description.binding_count; b++) bindings[b] = (VertexBindingType) description.bindings[b];
+
+    return VertexFormat(bindings, description.per_instance != 0);
+}
+
+size_t MappedMesh::getVertexCount(size_t stream) const{
+    if(stream >= header.stream_count) throw std::logic_error("Mesh stream out of range.");
+    return streams[stream].vertex_count;
+}
+
+const float* MappedMesh::getStreamData(size_t stream) const{
+    if(stream >= header.stream_count) throw std::logic_error("Mesh stream out of range.");
+    return reinterpret_cast<const float*>(static_cast<const char*>(mapping) + streams[stream].offset);
+}
+
+size_t MappedMesh::getStreamSize(size_t stream) const{
+    if(stream >= header.stream_count) throw std::logic_error("Mesh stream out of range.");
+    return streams[stream].size / sizeof(float);
+}
+
+const uint* MappedMesh::getIndices() const{
+    return reinterpret_cast<const uint*>(static_cast<const char*>(mapping) + header.index_offset);
+}
+
+MeshBounds MappedMesh::getBounds() const{
+    MeshBounds bounds = {};
+    bounds.min = {header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]};
+    bounds.max = {header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]};
+    bounds.center = {header.center[0], header.center[1], header.center[2]};
+    bounds.radius = header.radius;
+    return bounds;
+}
+
+const Meshlet* MappedMesh::getMeshlets() const{
+    if(header.meshlet_count == 0) return nullptr;
+    return reinterpret_cast<const Meshlet*>(static_cast<const char*>(mapping) + header.meshlet_offset);
+}
+
+const uint* MappedMesh::getMeshletVertices() const{
+    if(header.meshlet_count == 0) return nullptr;
+    return reinterpret_cast<const uint*>(static_cast<const char*>(mapping) + meshlet_vertex_offset);
+}
+
+const uint8_t* MappedMesh::getMeshletTriangles() const{
+    if(header.meshlet_count == 0) return nullptr;
+    return reinterpret_cast<const uint8_t*>(mapping) + meshlet_triangle_offset;
+}
+
+void MappedMesh::uploadStream(size_t stream, Buffer<float, GL_ARRAY_BUFFER>& buffer) const{
+    buffer.initialize(getStreamSize(stream), getStreamData(stream));
+}
+
+void MappedMesh::uploadIndices(Buffer<uint, GL_ELEMENT_ARRAY_BUFFER>& buffer) const{
+    buffer.initialize(getIndexCount(), getIndices());
+}
+
+void MappedMesh::copyStream(size_t stream, float* destination, size_t offset) const{
+    std::memcpy(destination + offset, getStreamData(stream), getStreamSize(stream) * sizeof(float));
+}
+
+void MappedMesh::copyIndices(uint* destination, size_t offset) const{
+    std::memcpy(destination + offset, getIndices(), getIndexCount() * sizeof(uint));
+}
@@ -0,0 +1,544 @@
+#include <mesh/optimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace Heptcore;
+
+static constexpr uint invalid_index = ~0u;
+
+static void validateIndices(const Mesh& mesh){
+    if(mesh.vertex_size == 0 || mesh.vertices.size() % mesh.vertex_size != 0)
+        throw std::logic_error("Mesh vertex data is not a multiple of the vertex size.");
+    if(mesh.position_offset + 3 > mesh.vertex_size)
+        throw std::logic_error("Mesh position doesnt fit into a vertex.");
+    if(mesh.indices.size() % 3 != 0)
+        throw std::logic_error("Mesh index count is not a multiple of three.");
+
+    size_t vertex_count = mesh.vertexCount();
+    for(uint index: mesh.indices) if(index >= vertex_count) throw std::logic_error("Mesh index out of range.");
+}
+
+/*
+    Simulates a FIFO post-transform cache, returns the number of vertex shader invocations
+*/
+static size_t simulateCache(const uint* indices, size_t index_count, size_t vertex_count, uint cache_size, std::vector<uint>* triangle_misses = nullptr){
+    std::vector<size_t> timestamps(vertex_count, 0);
+    size_t time = cache_size + 1; // Everything starts out of the cache
+    size_t misses = 0;
+
+    for(size_t i = 0; i < index_count; i += 3){
+        uint triangle_missed = 0;
+        for(int k = 0; k < 3; k++){
+            uint vertex = indices[i + k];
+            if(time - timestamps[vertex] > cache_size){
+                timestamps[vertex] = time++;
+                triangle_missed++;
+            }
+        }
+        misses += triangle_missed;
+        if(triangle_misses) triangle_misses->push_back(triangle_missed);
+    }
+
+    return misses;
+}
+
+size_t Heptcore::weldVertices(Mesh& mesh, float epsilon){
+    validateIndices(mesh);
+
+    size_t vertex_count = mesh.vertexCount();
+    uint size = mesh.vertex_size;
+
+    // Quantized (or raw bit) representation of every float, equal keys mean equal vertices.
+    // Quantized keys are offset into [0, 2^63), values that dont fit (huge, inf, nan) keep their
+    // raw bits with the top bit set so they only weld with exactly equal values
+    constexpr double quantized_limit = 4611686018427387904.0; // 2^62
+    std::vector<uint64_t> keys(mesh.vertices.size());
+    for(size_t i = 0; i < mesh.vertices.size(); i++){
+        float value = mesh.vertices[i];
+        if(value == 0.0f) value = 0.0f; // Treat -0 and 0 as the same
+
+        double quantized = epsilon > 0 ? std::floor((double) value / epsilon + 0.5) : 0.0;
+        if(epsilon > 0 && quantized > -quantized_limit && quantized < quantized_limit){
+            keys[i] = (uint64_t) ((int64_t) quantized + (int64_t) quantized_limit);
+        }
+        else{
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(uint32_t));
+            keys[i] = (1ull << 63) | bits;
+        }
+    }
+
+    auto hashVertex = [&](uint vertex){
+        size_t hash = 14695981039346656037ull;
+        for(uint i = 0; i < size; i++){
+            hash ^= keys[vertex * size + i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    };
+    auto equalVertex = [&](uint a, uint b){
+        return std::memcmp(&keys[a * size], &keys[b * size], size * sizeof(uint64_t)) == 0;
+    };
+
+    std::unordered_map<size_t, uint> heads = {};
+    heads.reserve(vertex_count);
+    std::vector<uint> chain(vertex_count, invalid_index);
+    std::vector<uint> remap(vertex_count, invalid_index);
+    std::vector<float> welded = {};
+    welded.reserve(mesh.vertices.size());
+
+    uint unique = 0;
+    for(uint vertex = 0; vertex < vertex_count; vertex++){
+        size_t hash = hashVertex(vertex);
+        auto head = heads.find(hash);
+
+        uint found = invalid_index;
+        if(head != heads.end()){
+            for(uint candidate = head->second; candidate != invalid_index; candidate = chain[candidate]){
+                if(equalVertex(candidate, vertex)){
+                    found = candidate;
+                    break;
+                }
+            }
+        }
+
+        if(found != invalid_index){
+            remap[vertex] = remap[found];
+            continue;
+        }
+
+        remap[vertex] = unique++;
+        welded.insert(welded.end(), mesh.vertices.begin() + vertex * size, mesh.vertices.begin() + (vertex + 1) * size);
+
+        chain[vertex] = head != heads.end() ? head->second : invalid_index;
+        heads[hash] = vertex;
+    }
+
+    for(auto& index: mesh.indices) index = remap[index];
+    mesh.vertices = std::move(welded);
+
+    return unique;
+}
+
+/*
+    Tom Forsyth's linear-speed vertex cache optimisation
+*/
+static constexpr int forsyth_cache_size = 32;
+
+static float forsythVertexScore(int cache_position, uint remaining){
+    if(remaining == 0) return -1.0f;
+
+    float score = 0.0f;
+    if(cache_position >= 0){
+        if(cache_position < 3) score = 0.75f; // Last triangle, dont favor it so strips dont just go back and forth
+        else score = std::pow(1.0f - float(cache_position - 3) / (forsyth_cache_size - 3), 1.5f);
+    }
+
+    // Favor vertices with few triangles left so lone triangles dont get stranded
+    return score + 2.0f * std::pow((float) remaining, -0.5f);
+}
+
+void Heptcore::optimizeVertexCache(Mesh& mesh){
+    validateIndices(mesh);
+
+    size_t vertex_count = mesh.vertexCount();
+    size_t triangle_count = mesh.triangleCount();
+    if(triangle_count == 0) return;
+
+    auto& indices = mesh.indices;
+
+    std::vector<uint> remaining(vertex_count, 0);
+    for(uint index: indices) remaining[index]++;
+
+    // Triangles for every vertex, the first remaining[vertex] entries are the not yet emitted ones
+    std::vector<uint> offsets(vertex_count + 1, 0);
+    for(size_t vertex = 0; vertex < vertex_count; vertex++) offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+
+    std::vector<uint> adjacency(indices.size());
+    std::vector<uint> fill(offsets.begin(), offsets.end() - 1);
+    for(size_t triangle = 0; triangle < triangle_count; triangle++){
+        for(int k = 0; k < 3; k++) adjacency[fill[indices[triangle * 3 + k]]++] = (uint) triangle;
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for(size_t vertex = 0; vertex < vertex_count; vertex++) vertex_score[vertex] = forsythVertexScore(-1, remaining[vertex]);
+
+    std::vector<bool> emitted(triangle_count, false);
+
+    int best = -1;
+    float best_score = -1.0f;
+    for(size_t triangle = 0; triangle < triangle_count; triangle++){
+        const uint* triangle_indices = &indices[triangle * 3];
+        float score = vertex_score[triangle_indices[0]] + vertex_score[triangle_indices[1]] + vertex_score[triangle_indices[2]];
+        if(score > best_score){
+            best_score = score;
+            best = (int) triangle;
+        }
+    }
+
+    std::vector<uint> result = {};
+    result.reserve(indices.size());
+
+    std::vector<uint> cache = {};
+    std::vector<uint> new_cache = {};
+    size_t scan_cursor = 0;
+
+    while(result.size() < indices.size()){
+        if(best < 0){
+            // Nothing in the cache has triangles left, continue with the first unemitted one
+            while(emitted[scan_cursor]) scan_cursor++;
+            best = (int) scan_cursor;
+        }
+
+        uint triangle_indices[3] = {indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+        emitted[best] = true;
+
+        new_cache.clear();
+        for(uint vertex: triangle_indices){
+            result.push_back(vertex);
+
+            uint* begin = &adjacency[offsets[vertex]];
+            uint* end = begin + remaining[vertex];
+            uint* position = std::find(begin, end, (uint) best);
+            std::swap(*position, *(end - 1));
+            remaining[vertex]--;
+
+            if(std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end()) new_cache.push_back(vertex);
+        }
+        for(uint vertex: cache){
+            if(std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end()) new_cache.push_back(vertex);
+        }
+
+        for(size_t i = 0; i < new_cache.size(); i++){
+            uint vertex = new_cache[i];
+            cache_position[vertex] = i < forsyth_cache_size ? (int) i : -1;
+            vertex_score[vertex] = forsythVertexScore(cache_position[vertex], remaining[vertex]);
+        }
+
+        // Rescore every triangle touching the cache (including the vertices that just fell out)
+        best = -1;
+        best_score = -1.0f;
+        for(uint vertex: new_cache){
+            for(uint i = 0; i < remaining[vertex]; i++){
+                uint triangle = adjacency[offsets[vertex] + i];
+                const uint* neighbour = &indices[triangle * 3];
+
+                float score = vertex_score[neighbour[0]] + vertex_score[neighbour[1]] + vertex_score[neighbour[2]];
+
+                if(score > best_score){
+                    best_score = score;
+                    best = (int) triangle;
+                }
+            }
+        }
+
+        if(new_cache.size() > forsyth_cache_size) new_cache.resize(forsyth_cache_size);
+        std::swap(cache, new_cache);
+    }
+
+    indices = std::move(result);
+}
+
+void Heptcore::optimizeOverdraw(Mesh& mesh, float threshold, uint cache_size){
+    validateIndices(mesh);
+
+    size_t triangle_count = mesh.triangleCount();
+    if(triangle_count == 0 || threshold <= 1.0f) return;
+
+    auto& indices = mesh.indices;
+    size_t vertex_count = mesh.vertexCount();
+
+    // Hard boundaries, places where the cache got completely flushed anyway
+    std::vector<uint> triangle_misses = {};
+    triangle_misses.reserve(triangle_count);
+    simulateCache(indices.data(), indices.size(), vertex_count, cache_size, &triangle_misses);
+
+    std::vector<size_t> hard_clusters = {0};
+    for(size_t triangle = 1; triangle < triangle_count; triangle++){
+        if(triangle_misses[triangle] == 3) hard_clusters.push_back(triangle);
+    }
+    hard_clusters.push_back(triangle_count);
+
+    // Soft boundaries, split hard clusters further as long as the local cache efficiency stays within threshold
+    std::vector<size_t> clusters = {};
+    for(size_t c = 0; c + 1 < hard_clusters.size(); c++){
+        size_t start = hard_clusters[c];
+        size_t end = hard_clusters[c + 1];
+
+        float cluster_acmr = (float) simulateCache(&indices[start * 3], (end - start) * 3, vertex_count, cache_size) / (end - start);
+
+        clusters.push_back(start);
+
+        size_t soft_start = start;
+        size_t soft_misses = 0;
+        // Restart the simulation after every split, the sort breaks locality between clusters
+        std::vector<size_t> timestamps(vertex_count, 0);
+        size_t time = cache_size + 1;
+        for(size_t triangle = start; triangle < end; triangle++){
+            for(int k = 0; k < 3; k++){
+                uint vertex = indices[triangle * 3 + k];
+                if(time - timestamps[vertex] > cache_size){
+                    timestamps[vertex] = time++;
+                    soft_misses++;
+                }
+            }
+
+            size_t soft_triangles = triangle - soft_start + 1;
+            if(triangle + 1 < end && (float) soft_misses / soft_triangles <= cluster_acmr * threshold){
+                clusters.push_back(triangle + 1);
+                soft_start = triangle + 1;
+                soft_misses = 0;
+                time += cache_size + 1;
+            }
+        }
+    }
+    clusters.push_back(triangle_count);
+
+    glm::vec3 mesh_centroid = {0,0,0};
+    float mesh_area = 0;
+
+    struct Cluster{
+        size_t start;
+        size_t end;
+        glm::vec3 centroid;
+        glm::vec3 normal;
+        float area;
+        float sort_key;
+    };
+    std::vector<Cluster> sorted(clusters.size() - 1);
+
+    for(size_t c = 0; c + 1 < clusters.size(); c++){
+        Cluster& cluster = sorted[c];
+        cluster = {clusters[c], clusters[c + 1], {0,0,0}, {0,0,0}, 0, 0};
+
+        for(size_t triangle = cluster.start; triangle < cluster.end; triangle++){
+            glm::vec3 a = mesh.position(indices[triangle * 3]);
+            glm::vec3 b = mesh.position(indices[triangle * 3 + 1]);
+            glm::vec3 c_ = mesh.position(indices[triangle * 3 + 2]);
+
+            glm::vec3 normal = glm::cross(b - a, c_ - a);
+            float area = glm::length(normal);
+
+            cluster.centroid += (a + b + c_) * (area / 3.0f);
+            cluster.normal += normal;
+            cluster.area += area;
+        }
+
+        mesh_centroid += cluster.centroid;
+        mesh_area += cluster.area;
+
+        if(cluster.area > 0) cluster.centroid = cluster.centroid / cluster.area;
+    }
+    if(mesh_area > 0) mesh_centroid = mesh_centroid / mesh_area;
+
+    for(auto& cluster: sorted){
+        float normal_length = glm::length(cluster.normal);
+        glm::vec3 normal = normal_length > 0 ? cluster.normal / normal_length : glm::vec3(0,0,0);
+        cluster.sort_key = glm::dot(cluster.centroid - mesh_centroid, normal);
+    }
+
+    // Outward facing clusters first, they are the most likely to occlude the rest
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b){ return a.sort_key > b.sort_key; });
+
+    std::vector<uint> result = {};
+    result.reserve(indices.size());
+    for(auto& cluster: sorted) result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+
+    indices = std::move(result);
+}
+
+void Heptcore::optimizeVertexFetch(Mesh& mesh){
+    validateIndices(mesh);
+
+    size_t vertex_count = mesh.vertexCount();
+    uint size = mesh.vertex_size;
+
+    std::vector<uint> remap(vertex_count, invalid_index);
+    std::vector<float> reordered = {};
+    reordered.reserve(mesh.vertices.size());
+
+    uint next = 0;
+    for(auto& index: mesh.indices){
+        if(remap[index] == invalid_index){
+            remap[index] = next++;
+            reordered.insert(reordered.end(), mesh.vertices.begin() + index * size, mesh.vertices.begin() + (index + 1) * size);
+        }
+        index = remap[index];
+    }
+
+    // Vertices not referenced by any triangle are dropped
+    mesh.vertices = std::move(reordered);
+}
+
+static void computeMeshletBounds(const Mesh& mesh, MeshletData& data, Meshlet& meshlet){
+    const uint* vertices = &data.vertices[meshlet.vertex_offset];
+    const uint8_t* triangles = &data.triangles[meshlet.triangle_offset * 3];
+
+    glm::vec3 min = mesh.position(vertices[0]);
+    glm::vec3 max = min;
+    for(uint i = 1; i < meshlet.vertex_count; i++){
+        glm::vec3 position = mesh.position(vertices[i]);
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+
+    meshlet.center = (min + max) * 0.5f;
+    meshlet.radius = 0;
+    for(uint i = 0; i < meshlet.vertex_count; i++)
+        meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, mesh.position(vertices[i])));
+
+    std::vector<glm::vec3> normals = {};
+    std::vector<glm::vec3> corners = {};
+    glm::vec3 axis = {0,0,0};
+    for(uint t = 0; t < meshlet.triangle_count; t++){
+        glm::vec3 a = mesh.position(vertices[triangles[t * 3]]);
+        glm::vec3 b = mesh.position(vertices[triangles[t * 3 + 1]]);
+        glm::vec3 c = mesh.position(vertices[triangles[t * 3 + 2]]);
+
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float area = glm::length(normal);
+        if(area <= 0) continue; // Degenerate triangles dont affect visibility
+
+        normals.push_back(normal / area);
+        corners.push_back(a);
+        axis += normal / area;
+    }
+
+    meshlet.cone_apex = meshlet.center;
+    meshlet.cone_axis = {0,0,0};
+    meshlet.cone_cutoff = 1.0f;
+
+    float axis_length = glm::length(axis);
+    if(normals.empty() || axis_length <= 0) return;
+    axis = axis / axis_length;
+
+    float min_dot = 1.0f;
+    for(auto& normal: normals) min_dot = std::min(min_dot, glm::dot(normal, axis));
+
+    // Normals spread over more than a hemisphere (give or take), the cone is useless
+    if(min_dot <= 0.1f) return;
+
+    // Move the apex back so the plane of every triangle is in front of it
+    float max_t = 0;
+    for(size_t i = 0; i < normals.size(); i++){
+        float t = glm::dot(meshlet.center - corners[i], normals[i]) / glm::dot(axis, normals[i]);
+        max_t = std::max(max_t, t);
+    }
+
+    meshlet.cone_apex = meshlet.center - axis * max_t;
+    meshlet.cone_axis = axis;
+    meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+}
+
+MeshletData Heptcore::buildMeshlets(const Mesh& mesh, uint max_vertices, uint max_triangles){
+    validateIndices(mesh);
+
+    if(max_vertices < 3 || max_vertices > 255) throw std::logic_error("Meshlet vertex limit has to be between 3 and 255.");
+    if(max_triangles < 1) throw std::logic_error("Meshlet triangle limit has to be at least 1.");
+
+    MeshletData data = {};
+    std::vector<int> local(mesh.vertexCount(), -1);
+
+    Meshlet current = {};
+    auto finish = [&](){
+        if(current.triangle_count == 0) return;
+
+        computeMeshletBounds(mesh, data, current);
+        data.meshlets.push_back(current);
+
+        for(uint i = 0; i < current.vertex_count; i++) local[data.vertices[current.vertex_offset + i]] = -1;
+
+        current = {};
+        current.vertex_offset = (uint) data.vertices.size();
+        current.triangle_offset = (uint) data.triangles.size() / 3;
+    };
+
+    for(size_t triangle = 0; triangle < mesh.triangleCount(); triangle++){
+        const uint* triangle_indices = &mesh.indices[triangle * 3];
+
+        uint new_vertices = 0;
+        for(int k = 0; k < 3; k++){
+            uint vertex = triangle_indices[k];
+            bool seen = local[vertex] >= 0 || (k > 0 && triangle_indices[0] == vertex) || (k > 1 && triangle_indices[1] == vertex);
+            if(!seen) new_vertices++;
+        }
+
+        if(current.vertex_count + new_vertices > max_vertices || current.triangle_count + 1 > max_triangles) finish();
+
+        for(int k = 0; k < 3; k++){
+            uint vertex = triangle_indices[k];
+            if(local[vertex] < 0){
+                local[vertex] = (int) current.vertex_count++;
+                data.vertices.push_back(vertex);
+            }
+            data.triangles.push_back((uint8_t) local[vertex]);
+        }
+        current.triangle_count++;
+    }
+    finish();
+
+    return data;
+}
+
+MeshStatistics Heptcore::analyzeMesh(const Mesh& mesh, uint cache_size){
+    validateIndices(mesh);
+
+    MeshStatistics statistics = {};
+    statistics.triangles = mesh.triangleCount();
+
+    size_t vertex_count = mesh.vertexCount();
+    std::vector<bool> used(vertex_count, false);
+    for(uint index: mesh.indices) used[index] = true;
+    statistics.vertices = std::count(used.begin(), used.end(), true);
+
+    statistics.transformed = simulateCache(mesh.indices.data(), mesh.indices.size(), vertex_count, cache_size);
+
+    if(statistics.triangles > 0) statistics.acmr = (float) statistics.transformed / statistics.triangles;
+    if(statistics.vertices > 0) statistics.atvr = (float) statistics.transformed / statistics.vertices;
+
+    // Vertex fetch, 64 byte cache lines and a small fully associative FIFO of them
+    constexpr size_t line_size = 64;
+    constexpr size_t line_cache_size = 16;
+    size_t vertex_bytes = mesh.vertex_size * sizeof(float);
+
+    std::vector<size_t> line_cache = {};
+    size_t fetched_lines = 0;
+    std::vector<size_t> timestamps(vertex_count, 0);
+    size_t time = cache_size + 1;
+
+    for(uint index: mesh.indices){
+        if(time - timestamps[index] <= cache_size) continue;
+        timestamps[index] = time++;
+
+        size_t first_line = (index * vertex_bytes) / line_size;
+        size_t last_line = (index * vertex_bytes + vertex_bytes - 1) / line_size;
+        for(size_t line = first_line; line <= last_line; line++){
+            if(std::find(line_cache.begin(), line_cache.end(), line) != line_cache.end()) continue;
+
+            fetched_lines++;
+            line_cache.push_back(line);
+            if(line_cache.size() > line_cache_size) line_cache.erase(line_cache.begin());
+        }
+    }
+
+    if(statistics.vertices > 0) statistics.overfetch = (float) (fetched_lines * line_size) / (statistics.vertices * vertex_bytes);
+
+    return statistics;
+}
+
+MeshStatistics Heptcore::optimizeMesh(Mesh& mesh, MeshOptimizerSettings settings, MeshletData* meshlets){
+    if(settings.weld) weldVertices(mesh, settings.weld_epsilon);
+
+    optimizeVertexCache(mesh);
+    if(settings.overdraw_threshold > 1.0f) optimizeOverdraw(mesh, settings.overdraw_threshold, settings.cache_size);
+    optimizeVertexFetch(mesh);
+
+    if(settings.meshlets && meshlets) *meshlets = buildMeshlets(mesh, settings.meshlet_max_vertices, settings.meshlet_max_triangles);
+
+    return analyzeMesh(mesh, settings.cache_size);
+}
@@ -1,22 +0,0 @@
-#include <opengl/buffer.hpp>
-
-using namespace Heptcore;
-
-void checkGLError(const char *file, int line){
-    GLenum error;
-    while ((error = glGetError()) != GL_NO_ERROR) {
-        const char *errorString;
-        switch (error) {
-            case GL_INVALID_ENUM:                  errorString = "GL_INVALID_ENUM"; break;
-            case GL_INVALID_VALUE:                 errorString = "GL_INVALID_VALUE"; break;
-            case GL_INVALID_OPERATION:             errorString = "GL_INVALID_OPERATION"; break;
-            //case GL_STACK_OVERFLOW:                errorString = "GL_STACK_OVERFLOW"; break;
-            //case GL_STACK_UNDERFLOW:               errorString = "GL_STACK_UNDERFLOW"; break;
-            case GL_OUT_OF_MEMORY:                 errorString = "GL_OUT_OF_MEMORY"; break;
-            case GL_INVALID_FRAMEBUFFER_OPERATION: errorString = "GL_INVALID_FRAMEBUFFER_OPERATION"; break;
-            default:                               errorString = "Unknown error"; break;
-        }
-        std::cerr << "OpenGL error in file " << file << " at line " << line << " " << errorString << std::endl;
-        //throw std::runtime_error("Opengl error.");
-    }
-}
\ No newline at end of file
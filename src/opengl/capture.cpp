@@ -0,0 +1,1688 @@
+#include <opengl/capture.hpp>
+#include <opengl/framebuffer.hpp>
+#include <opengl/quad.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/shaders.hpp>
+#include <opengl/texture.hpp>
+#include <opengl/vao.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace Heptcore;
+
+FrameCapture Heptcore::frameCapture = FrameCapture();
+
+static constexpr char CAPTURE_MAGIC[4] = {'H', 'C', 'A', 'P'};
+static constexpr uint32_t CAPTURE_VERSION = 2;
+static constexpr size_t CAPTURE_FRAME_COUNT_OFFSET = 16; // Magic, version, width, height
+
+// Texture parameters stored with every texture snapshot
+static constexpr GLenum TEXTURE_PARAMETERS[] = {
+    GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER,
+    GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R,
+    GL_TEXTURE_BASE_LEVEL, GL_TEXTURE_MAX_LEVEL,
+    GL_TEXTURE_COMPARE_MODE, GL_TEXTURE_COMPARE_FUNC
+};
+static constexpr size_t TEXTURE_PARAMETER_COUNT = sizeof(TEXTURE_PARAMETERS) / sizeof(GLenum);
+
+const char* Heptcore::captureOpName(CaptureOp op){
+    switch(op){
+        case CAPTURE_FRAME_BEGIN:                  return "frame begin";
+        case CAPTURE_FRAME_END:                    return "frame end";
+        case CAPTURE_BUFFER_SNAPSHOT:              return "buffer snapshot";
+        case CAPTURE_BUFFER_DATA:                  return "buffer data";
+        case CAPTURE_BUFFER_SUBDATA:               return "buffer subdata";
+        case CAPTURE_TEXTURE_SNAPSHOT:             return "texture snapshot";
+        case CAPTURE_TEXTURE_DATA:                 return "texture data";
+        case CAPTURE_TEXTURE_BIND:                 return "texture bind";
+        case CAPTURE_TEXTURE_UNBIND:               return "texture unbind";
+        case CAPTURE_TEXTURE_PARAMETER:            return "texture parameter";
+        case CAPTURE_PROGRAM_SNAPSHOT:             return "program snapshot";
+        case CAPTURE_PROGRAM_USE:                  return "program use";
+        case CAPTURE_UNIFORM:                      return "uniform";
+        case CAPTURE_FRAMEBUFFER_SNAPSHOT:         return "framebuffer snapshot";
+        case CAPTURE_FRAMEBUFFER_BIND:             return "framebuffer bind";
+        case CAPTURE_FRAMEBUFFER_RESOLVE:          return "framebuffer resolve";
+        case CAPTURE_FRAMEBUFFER_INVALIDATE_DEPTH: return "framebuffer invalidate depth";
+        case CAPTURE_VERTEX_ARRAY_SNAPSHOT:        return "vertex array snapshot";
+        case CAPTURE_VERTEX_ARRAY_FORMAT:          return "vertex array format";
+        case CAPTURE_VERTEX_ARRAY_BIND:            return "vertex array bind";
+        case CAPTURE_DRAW:                         return "draw";
+        case CAPTURE_DRAW_INDEXED:                 return "draw indexed";
+        case CAPTURE_QUAD:                         return "fullscreen quad";
+        case CAPTURE_RENDER_STATE:                 return "render state";
+        case CAPTURE_CLEAR:                        return "clear";
+        case CAPTURE_BUFFER_BIND:                  return "buffer bind";
+        case CAPTURE_BUFFER_CLEAR:                 return "buffer clear";
+        case CAPTURE_IMAGE_BIND:                   return "image bind";
+        case CAPTURE_DISPATCH:                     return "dispatch";
+        case CAPTURE_DISPATCH_INDIRECT:            return "dispatch indirect";
+        case CAPTURE_MEMORY_BARRIER:               return "memory barrier";
+        default:                                   return "unknown";
+    }
+}
+
+static bool isSnapshot(CaptureOp op){
+    return op == CAPTURE_BUFFER_SNAPSHOT || op == CAPTURE_TEXTURE_SNAPSHOT || op == CAPTURE_PROGRAM_SNAPSHOT ||
+        op == CAPTURE_FRAMEBUFFER_SNAPSHOT || op == CAPTURE_VERTEX_ARRAY_SNAPSHOT;
+}
+
+struct ReadbackFormat{
+    uint format;
+    uint type;
+    size_t pixel_size;
+};
+
+/*
+    How a texture is read back and uploaded again, everything gets all four channels so one
+    format covers every channel count
+*/
+static ReadbackFormat readbackFormat(uint internal_format){
+    switch(internal_format){
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32:
+        case GL_DEPTH_COMPONENT32F:
+            return {GL_DEPTH_COMPONENT, GL_FLOAT, 4};
+        case GL_DEPTH24_STENCIL8:
+            return {GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, 4};
+        case GL_DEPTH32F_STENCIL8:
+            return {GL_DEPTH_STENCIL, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, 8};
+
+        case GL_R8I: case GL_RG8I: case GL_RGB8I: case GL_RGBA8I:
+        case GL_R16I: case GL_RG16I: case GL_RGB16I: case GL_RGBA16I:
+        case GL_R32I: case GL_RG32I: case GL_RGB32I: case GL_RGBA32I:
+            return {GL_RGBA_INTEGER, GL_INT, 16};
+        case GL_R8UI: case GL_RG8UI: case GL_RGB8UI: case GL_RGBA8UI:
+        case GL_R16UI: case GL_RG16UI: case GL_RGB16UI: case GL_RGBA16UI:
+        case GL_R32UI: case GL_RG32UI: case GL_RGB32UI: case GL_RGBA32UI:
+        case GL_RGB10_A2UI:
+            return {GL_RGBA_INTEGER, GL_UNSIGNED_INT, 16};
+
+        case GL_R16F: case GL_RG16F: case GL_RGB16F: case GL_RGBA16F:
+        case GL_R32F: case GL_RG32F: case GL_RGB32F: case GL_RGBA32F:
+        case GL_R11F_G11F_B10F: case GL_RGB9_E5:
+            return {GL_RGBA, GL_FLOAT, 16};
+
+        case GL_R16: case GL_RG16: case GL_RGB16: case GL_RGBA16: case GL_RGB10_A2:
+            return {GL_RGBA, GL_UNSIGNED_SHORT, 8};
+
+        default:
+            return {GL_RGBA, GL_UNSIGNED_BYTE, 4};
+    }
+}
+
+enum UniformKind{
+    UNIFORM_FLOAT = 0,
+    UNIFORM_INT = 1,
+    UNIFORM_UINT = 2
+};
+
+struct UniformInfo{
+    int components; // 0 for types captures skip
+    UniformKind kind;
+};
+
+static UniformInfo uniformInfo(uint type){
+    switch(type){
+        case GL_FLOAT:             return {1, UNIFORM_FLOAT};
+        case GL_FLOAT_VEC2:        return {2, UNIFORM_FLOAT};
+        case GL_FLOAT_VEC3:        return {3, UNIFORM_FLOAT};
+        case GL_FLOAT_VEC4:        return {4, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT2:        return {4, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT3:        return {9, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT4:        return {16, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT2x3:      return {6, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT2x4:      return {8, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT3x2:      return {6, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT3x4:      return {12, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT4x2:      return {8, UNIFORM_FLOAT};
+        case GL_FLOAT_MAT4x3:      return {12, UNIFORM_FLOAT};
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:         return {2, UNIFORM_INT};
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:         return {3, UNIFORM_INT};
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:         return {4, UNIFORM_INT};
+        case GL_UNSIGNED_INT:      return {1, UNIFORM_UINT};
+        case GL_UNSIGNED_INT_VEC2: return {2, UNIFORM_UINT};
+        case GL_UNSIGNED_INT_VEC3: return {3, UNIFORM_UINT};
+        case GL_UNSIGNED_INT_VEC4: return {4, UNIFORM_UINT};
+        case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+        case GL_DOUBLE_MAT2: case GL_DOUBLE_MAT3: case GL_DOUBLE_MAT4:
+        case GL_DOUBLE_MAT2x3: case GL_DOUBLE_MAT2x4: case GL_DOUBLE_MAT3x2:
+        case GL_DOUBLE_MAT3x4: case GL_DOUBLE_MAT4x2: case GL_DOUBLE_MAT4x3:
+                                   return {0, UNIFORM_FLOAT};
+        default:                   return {1, UNIFORM_INT}; // GL_INT, GL_BOOL, samplers and images
+    }
+}
+
+static void setProgramUniform(uint program, int location, uint type, int count, const void* data){
+    const float* floats = static_cast<const float*>(data);
+    const int* ints = static_cast<const int*>(data);
+    const uint* uints = static_cast<const uint*>(data);
+
+    switch(type){
+        case GL_FLOAT:        glProgramUniform1fv(program, location, count, floats); return;
+        case GL_FLOAT_VEC2:   glProgramUniform2fv(program, location, count, floats); return;
+        case GL_FLOAT_VEC3:   glProgramUniform3fv(program, location, count, floats); return;
+        case GL_FLOAT_VEC4:   glProgramUniform4fv(program, location, count, floats); return;
+        case GL_FLOAT_MAT2:   glProgramUniformMatrix2fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT3:   glProgramUniformMatrix3fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT4:   glProgramUniformMatrix4fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT2x3: glProgramUniformMatrix2x3fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT2x4: glProgramUniformMatrix2x4fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT3x2: glProgramUniformMatrix3x2fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT3x4: glProgramUniformMatrix3x4fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT4x2: glProgramUniformMatrix4x2fv(program, location, count, GL_FALSE, floats); return;
+        case GL_FLOAT_MAT4x3: glProgramUniformMatrix4x3fv(program, location, count, GL_FALSE, floats); return;
+        default: break;
+    }
+
+    UniformInfo info = uniformInfo(type);
+    if(info.kind == UNIFORM_UINT){
+        switch(info.components){
+            case 1: glProgramUniform1uiv(program, location, count, uints); return;
+            case 2: glProgramUniform2uiv(program, location, count, uints); return;
+            case 3: glProgramUniform3uiv(program, location, count, uints); return;
+            case 4: glProgramUniform4uiv(program, location, count, uints); return;
+        }
+    }
+    else if(info.kind == UNIFORM_INT){
+        switch(info.components){
+            case 1: glProgramUniform1iv(program, location, count, ints); return;
+            case 2: glProgramUniform2iv(program, location, count, ints); return;
+            case 3: glProgramUniform3iv(program, location, count, ints); return;
+            case 4: glProgramUniform4iv(program, location, count, ints); return;
+        }
+    }
+}
+
+static CaptureRenderState readRenderState(){
+    CaptureRenderState state;
+    std::memset(&state, 0, sizeof(state)); // Padding too, states are compared bytewise
+
+    GLint value = 0;
+    auto integer = [&](GLenum name){
+        glGetIntegerv(name, &value);
+        return (uint32_t) value;
+    };
+
+    glGetIntegerv(GL_VIEWPORT, state.viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, state.scissor);
+    state.depth_func = integer(GL_DEPTH_FUNC);
+    state.blend_source_rgb = integer(GL_BLEND_SRC_RGB);
+    state.blend_destination_rgb = integer(GL_BLEND_DST_RGB);
+    state.blend_source_alpha = integer(GL_BLEND_SRC_ALPHA);
+    state.blend_destination_alpha = integer(GL_BLEND_DST_ALPHA);
+    state.blend_equation_rgb = integer(GL_BLEND_EQUATION_RGB);
+    state.blend_equation_alpha = integer(GL_BLEND_EQUATION_ALPHA);
+    glGetFloatv(GL_BLEND_COLOR, state.blend_color);
+    state.cull_mode = integer(GL_CULL_FACE_MODE);
+    state.front_face = integer(GL_FRONT_FACE);
+
+    GLboolean flag = GL_FALSE;
+    GLboolean color_mask[4] = {};
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+    glGetBooleanv(GL_COLOR_WRITEMASK, color_mask);
+    state.depth_mask = flag;
+    for(int i = 0; i < 4; i++) state.color_mask[i] = color_mask[i];
+
+    state.scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+    state.depth_test = glIsEnabled(GL_DEPTH_TEST);
+    state.blend = glIsEnabled(GL_BLEND);
+    state.cull_face = glIsEnabled(GL_CULL_FACE);
+    return state;
+}
+
+static void applyRenderState(const CaptureRenderState& state){
+    auto enable = [](GLenum capability, bool enabled){ enabled ? glEnable(capability) : glDisable(capability); };
+
+    glViewport(state.viewport[0], state.viewport[1], state.viewport[2], state.viewport[3]);
+    glScissor(state.scissor[0], state.scissor[1], state.scissor[2], state.scissor[3]);
+    enable(GL_SCISSOR_TEST, state.scissor_test);
+
+    enable(GL_DEPTH_TEST, state.depth_test);
+    glDepthFunc(state.depth_func);
+    glDepthMask(state.depth_mask);
+
+    enable(GL_BLEND, state.blend);
+    glBlendFuncSeparate(state.blend_source_rgb, state.blend_destination_rgb, state.blend_source_alpha, state.blend_destination_alpha);
+    glBlendEquationSeparate(state.blend_equation_rgb, state.blend_equation_alpha);
+    glBlendColor(state.blend_color[0], state.blend_color[1], state.blend_color[2], state.blend_color[3]);
+
+    enable(GL_CULL_FACE, state.cull_face);
+    glCullFace(state.cull_mode);
+    glFrontFace(state.front_face);
+
+    glColorMask(state.color_mask[0], state.color_mask[1], state.color_mask[2], state.color_mask[3]);
+}
+
+/*
+    Size of the single value glClearNamedBufferData repeats over the buffer
+*/
+static size_t clearValueSize(uint format, uint type){
+    size_t components = 4;
+    switch(format){
+        case GL_RED: case GL_RED_INTEGER: case GL_GREEN: case GL_BLUE:
+        case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+            components = 1; break;
+        case GL_RG: case GL_RG_INTEGER:
+            components = 2; break;
+        case GL_RGB: case GL_RGB_INTEGER: case GL_BGR: case GL_BGR_INTEGER:
+            components = 3; break;
+        default: break;
+    }
+
+    switch(type){
+        case GL_BYTE: case GL_UNSIGNED_BYTE:
+            return components;
+        case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_2_10_10_10_REV:
+            return 4; // Packed, one value for every component
+        default:
+            return components * 4;
+    }
+}
+
+/*
+    Recording
+*/
+
+void FrameCapture::beginRecord(CaptureOp op){
+    record.clear();
+    record.push_back(op);
+    record.resize(5); // Payload size, filled in by endRecord
+}
+
+void FrameCapture::endRecord(){
+    uint32_t size = record.size() - 5;
+    std::memcpy(record.data() + 1, &size, sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(record.data()), record.size());
+}
+
+void FrameCapture::write(const void* data, size_t bytes){
+    const uint8_t* begin = static_cast<const uint8_t*>(data);
+    record.insert(record.end(), begin, begin + bytes);
+}
+
+void FrameCapture::writeString(const std::string& string){
+    write<uint32_t>(string.size());
+    write(string.data(), string.size());
+}
+
+/*
+    Raw GL calls are recorded by swapping the glad pointer of the function for CaptureHook::call.
+    The pointers are global and read by every thread with a context, so they are only written by
+    installCaptureHooks right after glad loaded, before other threads call GL, and never again.
+    Calls from other threads go through the hooks too but isRecording only lets the capturing thread record.
+*/
+template <auto pointer, auto record>
+struct CaptureHook;
+
+template <typename... Arguments, void (APIENTRYP* pointer)(Arguments...), void (*record)(Arguments...)>
+struct CaptureHook<pointer, record>{
+    static inline void (APIENTRYP original)(Arguments...) = nullptr;
+
+    static void APIENTRY call(Arguments... arguments){
+        if(frameCapture.isRecording()) record(arguments...);
+        original(arguments...);
+    }
+    static void install(){
+        if(*pointer == call) return;
+        original = *pointer;
+        if(original) *pointer = call;
+    }
+};
+
+template <typename... Hooks>
+struct CaptureHooks{
+    static void install() {(Hooks::install(), ...);}
+};
+
+static void recordClear(GLbitfield mask) {frameCapture.clear(mask);}
+
+template <uint type, typename T, typename... Values>
+static void recordUniformValues(GLint location, T first, Values... rest){
+    T values[] = {first, rest...};
+    frameCapture.rawUniform(location, type, 1, values);
+}
+template <uint type, typename T>
+static void recordUniformArray(GLint location, GLsizei count, const T* values){
+    frameCapture.rawUniform(location, type, count, values);
+}
+template <uint type, int size>
+static void recordUniformMatrix(GLint location, GLsizei count, GLboolean transpose, const GLfloat* values){
+    if(!transpose || count <= 0){
+        frameCapture.rawUniform(location, type, count, values);
+        return;
+    }
+
+    // Captures store column major like the wrappers upload
+    std::vector<GLfloat> transposed((size_t) count * size * size);
+    for(int matrix = 0; matrix < count; matrix++)
+        for(int column = 0; column < size; column++)
+            for(int row = 0; row < size; row++)
+                transposed[(size_t) matrix * size * size + column * size + row] = values[(size_t) matrix * size * size + row * size + column];
+    frameCapture.rawUniform(location, type, count, transposed.data());
+}
+
+static void recordDrawArrays(GLenum mode, GLint first, GLsizei count) {frameCapture.rawDraw(mode, first, count, 1, 0);}
+static void recordDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances){
+    frameCapture.rawDraw(mode, first, count, instances, 0);
+}
+static void recordDrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instances, GLuint base_instance){
+    frameCapture.rawDraw(mode, first, count, instances, base_instance);
+}
+static void recordDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices){
+    frameCapture.rawDrawIndexed(mode, count, type, reinterpret_cast<uintptr_t>(indices), 1);
+}
+static void recordDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances){
+    frameCapture.rawDrawIndexed(mode, count, type, reinterpret_cast<uintptr_t>(indices), instances);
+}
+
+static void recordBindBufferBase(GLenum target, GLuint index, GLuint buffer) {frameCapture.bindBuffer(target, index, buffer, 0, 0);}
+static void recordBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size){
+    frameCapture.bindBuffer(target, index, buffer, offset, size);
+}
+static void recordClearNamedBufferData(GLuint buffer, GLenum internal_format, GLenum format, GLenum type, const void* data){
+    frameCapture.clearBuffer(buffer, internal_format, format, type, data);
+}
+static void recordBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format){
+    frameCapture.bindImage(unit, texture, level, layered, layer, access, format);
+}
+static void recordDispatchCompute(GLuint x, GLuint y, GLuint z) {frameCapture.dispatch(x, y, z);}
+static void recordDispatchComputeIndirect(GLintptr offset) {frameCapture.dispatchIndirect(offset);}
+static void recordMemoryBarrier(GLbitfield barriers) {frameCapture.memoryBarrier(barriers);}
+
+using RawCallHooks = CaptureHooks<
+    CaptureHook<&glad_glClear, recordClear>,
+
+    CaptureHook<&glad_glUniform1f, recordUniformValues<GL_FLOAT, GLfloat>>,
+    CaptureHook<&glad_glUniform2f, recordUniformValues<GL_FLOAT_VEC2, GLfloat, GLfloat>>,
+    CaptureHook<&glad_glUniform3f, recordUniformValues<GL_FLOAT_VEC3, GLfloat, GLfloat, GLfloat>>,
+    CaptureHook<&glad_glUniform4f, recordUniformValues<GL_FLOAT_VEC4, GLfloat, GLfloat, GLfloat, GLfloat>>,
+    CaptureHook<&glad_glUniform1i, recordUniformValues<GL_INT, GLint>>,
+    CaptureHook<&glad_glUniform2i, recordUniformValues<GL_INT_VEC2, GLint, GLint>>,
+    CaptureHook<&glad_glUniform3i, recordUniformValues<GL_INT_VEC3, GLint, GLint, GLint>>,
+    CaptureHook<&glad_glUniform4i, recordUniformValues<GL_INT_VEC4, GLint, GLint, GLint, GLint>>,
+    CaptureHook<&glad_glUniform1ui, recordUniformValues<GL_UNSIGNED_INT, GLuint>>,
+    CaptureHook<&glad_glUniform2ui, recordUniformValues<GL_UNSIGNED_INT_VEC2, GLuint, GLuint>>,
+    CaptureHook<&glad_glUniform3ui, recordUniformValues<GL_UNSIGNED_INT_VEC3, GLuint, GLuint, GLuint>>,
+    CaptureHook<&glad_glUniform4ui, recordUniformValues<GL_UNSIGNED_INT_VEC4, GLuint, GLuint, GLuint, GLuint>>,
+    CaptureHook<&glad_glUniform1fv, recordUniformArray<GL_FLOAT, GLfloat>>,
+    CaptureHook<&glad_glUniform2fv, recordUniformArray<GL_FLOAT_VEC2, GLfloat>>,
+    CaptureHook<&glad_glUniform3fv, recordUniformArray<GL_FLOAT_VEC3, GLfloat>>,
+    CaptureHook<&glad_glUniform4fv, recordUniformArray<GL_FLOAT_VEC4, GLfloat>>,
+    CaptureHook<&glad_glUniform1iv, recordUniformArray<GL_INT, GLint>>,
+    CaptureHook<&glad_glUniform2iv, recordUniformArray<GL_INT_VEC2, GLint>>,
+    CaptureHook<&glad_glUniform3iv, recordUniformArray<GL_INT_VEC3, GLint>>,
+    CaptureHook<&glad_glUniform4iv, recordUniformArray<GL_INT_VEC4, GLint>>,
+    CaptureHook<&glad_glUniform1uiv, recordUniformArray<GL_UNSIGNED_INT, GLuint>>,
+    CaptureHook<&glad_glUniform2uiv, recordUniformArray<GL_UNSIGNED_INT_VEC2, GLuint>>,
+    CaptureHook<&glad_glUniform3uiv, recordUniformArray<GL_UNSIGNED_INT_VEC3, GLuint>>,
+    CaptureHook<&glad_glUniform4uiv, recordUniformArray<GL_UNSIGNED_INT_VEC4, GLuint>>,
+    CaptureHook<&glad_glUniformMatrix2fv, recordUniformMatrix<GL_FLOAT_MAT2, 2>>,
+    CaptureHook<&glad_glUniformMatrix3fv, recordUniformMatrix<GL_FLOAT_MAT3, 3>>,
+    CaptureHook<&glad_glUniformMatrix4fv, recordUniformMatrix<GL_FLOAT_MAT4, 4>>,
+
+    CaptureHook<&glad_glDrawArrays, recordDrawArrays>,
+    CaptureHook<&glad_glDrawArraysInstanced, recordDrawArraysInstanced>,
+    CaptureHook<&glad_glDrawArraysInstancedBaseInstance, recordDrawArraysInstancedBaseInstance>,
+    CaptureHook<&glad_glDrawElements, recordDrawElements>,
+    CaptureHook<&glad_glDrawElementsInstanced, recordDrawElementsInstanced>,
+
+    CaptureHook<&glad_glBindBufferBase, recordBindBufferBase>,
+    CaptureHook<&glad_glBindBufferRange, recordBindBufferRange>,
+    CaptureHook<&glad_glClearNamedBufferData, recordClearNamedBufferData>,
+    CaptureHook<&glad_glBindImageTexture, recordBindImageTexture>,
+    CaptureHook<&glad_glDispatchCompute, recordDispatchCompute>,
+    CaptureHook<&glad_glDispatchComputeIndirect, recordDispatchComputeIndirect>,
+    CaptureHook<&glad_glMemoryBarrier, recordMemoryBarrier>
+>;
+
+void Heptcore::installCaptureHooks(){
+    RawCallHooks::install();
+}
+
+void FrameCapture::captureFrames(const std::string& filename, int frames){
+    if(frames <= 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    armed_filename = filename;
+    armed_frames = frames;
+    armed.store(true, std::memory_order_release);
+}
+
+void FrameCapture::endFrame(){
+    if(recording.load(std::memory_order_relaxed) && std::this_thread::get_id() == thread){
+        beginRecord(CAPTURE_FRAME_END);
+        endRecord();
+        frames_written++;
+
+        if(--frames_left > 0){
+            beginFrame();
+            return;
+        }
+        finish();
+    }
+
+    if(!armed.load(std::memory_order_acquire)) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        filename = armed_filename;
+        frames_left = armed_frames;
+        armed.store(false, std::memory_order_relaxed);
+    }
+
+    thread = std::this_thread::get_id();
+    start();
+}
+
+void FrameCapture::start(){
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if(!file){
+        std::cerr << "Failed to open capture file: " << filename << std::endl;
+        return;
+    }
+
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    int32_t width = viewport[2];
+    int32_t height = viewport[3];
+    uint32_t frame_count = 0; // Patched by finish
+    file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&CAPTURE_VERSION), sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&width), sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(&height), sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(&frame_count), sizeof(uint32_t));
+
+    frames_written = 0;
+    buffers.clear();
+    textures.clear();
+    programs.clear();
+    framebuffers.clear();
+    vertex_arrays.clear();
+    uniform_names.clear();
+
+    recording.store(true, std::memory_order_release);
+    beginFrame();
+}
+
+void FrameCapture::finish(){
+    recording.store(false, std::memory_order_release);
+
+    file.seekp(CAPTURE_FRAME_COUNT_OFFSET);
+    file.write(reinterpret_cast<const char*>(&frames_written), sizeof(uint32_t));
+    file.close();
+
+    record.clear();
+    record.shrink_to_fit();
+}
+
+void FrameCapture::beginFrame(){
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    beginRecord(CAPTURE_FRAME_BEGIN);
+    write(viewport, sizeof(viewport));
+    write<uint8_t>(glIsEnabled(GL_DEPTH_TEST));
+    write<uint8_t>(glIsEnabled(GL_BLEND));
+    write<uint8_t>(glIsEnabled(GL_CULL_FACE));
+    endRecord();
+
+    // Replay starts every frame from the default framebuffer, the full state goes in again before the first draw
+    render_state_recorded = false;
+}
+
+void FrameCapture::renderState(){
+    CaptureRenderState state = readRenderState();
+    if(render_state_recorded && std::memcmp(&state, &render_state, sizeof(state)) == 0) return;
+
+    render_state = state;
+    render_state_recorded = true;
+
+    beginRecord(CAPTURE_RENDER_STATE);
+    write(state);
+    endRecord();
+}
+
+const std::string* FrameCapture::uniformName(uint program, int location){
+    auto found = uniform_names.find(program);
+    if(found == uniform_names.end()){
+        found = uniform_names.emplace(program, std::unordered_map<int, std::string>{}).first;
+
+        GLint uniform_count = 0, max_length = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+        std::vector<char> name_buffer(max_length + 1);
+
+        for(GLuint index = 0; index < (GLuint) uniform_count; index++){
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, index, name_buffer.size(), nullptr, &size, &type, name_buffer.data());
+
+            std::string uniform_name = name_buffer.data();
+            bool array = uniform_name.ends_with("[0]");
+            if(array) uniform_name.resize(uniform_name.size() - 3);
+
+            for(int element = 0; element < size; element++){
+                std::string element_name = array ? uniform_name + "[" + std::to_string(element) + "]" : uniform_name;
+                int location = glGetUniformLocation(program, element_name.c_str());
+                if(location != -1) found->second[location] = std::move(element_name);
+            }
+        }
+    }
+
+    auto name = found->second.find(location);
+    return name == found->second.end() ? nullptr : &name->second;
+}
+
+void FrameCapture::snapshotBuffer(uint name, CaptureOp op){
+    buffers.insert(name);
+    if(!glIsBuffer(name)) return;
+
+    GLint64 size = 0;
+    glGetNamedBufferParameteri64v(name, GL_BUFFER_SIZE, &size);
+
+    beginRecord(op);
+    write<uint32_t>(name);
+    write<uint64_t>(size);
+    size_t offset = record.size();
+    record.resize(offset + size);
+    if(size > 0) glGetNamedBufferSubData(name, 0, size, record.data() + offset);
+    endRecord();
+}
+
+void FrameCapture::snapshotTexture(uint name, uint target, CaptureOp op){
+    textures.insert(name);
+    if(!glIsTexture(name) || target == GL_TEXTURE_2D_MULTISAMPLE || target == GL_TEXTURE_2D_MULTISAMPLE_ARRAY) return;
+
+    GLint internal_format = 0, compressed = 0, immutable = 0, levels = 0;
+    glGetTextureLevelParameteriv(name, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    glGetTextureLevelParameteriv(name, 0, GL_TEXTURE_COMPRESSED, &compressed);
+    glGetTextureParameteriv(name, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+
+    if(immutable) glGetTextureParameteriv(name, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+    else{
+        // Mutable storage, count the levels that were specified
+        GLint level_width = 0;
+        do{
+            glGetTextureLevelParameteriv(name, levels, GL_TEXTURE_WIDTH, &level_width);
+        } while(level_width > 0 && ++levels < 16);
+    }
+    if(levels == 0) return; // No storage yet
+
+    bool cube = target == GL_TEXTURE_CUBE_MAP;
+    ReadbackFormat readback = readbackFormat(internal_format);
+
+    auto levelSize = [&](int level){
+        GLint width = 1, height = 1, depth = 1;
+        glGetTextureLevelParameteriv(name, level, GL_TEXTURE_WIDTH, &width);
+        glGetTextureLevelParameteriv(name, level, GL_TEXTURE_HEIGHT, &height);
+        glGetTextureLevelParameteriv(name, level, GL_TEXTURE_DEPTH, &depth);
+        if(cube) depth = 6;
+        return std::array<int32_t, 3>{width, height, depth};
+    };
+
+    std::array<int32_t, 3> base = levelSize(0);
+
+    beginRecord(op);
+    write<uint32_t>(name);
+    write<uint32_t>(target);
+    write<uint32_t>(internal_format);
+    write<uint8_t>(compressed);
+    write<uint32_t>(readback.format);
+    write<uint32_t>(readback.type);
+    write<uint32_t>(levels);
+    write(base.data(), sizeof(base));
+
+    for(GLenum parameter: TEXTURE_PARAMETERS){
+        GLint value = 0;
+        glGetTextureParameteriv(name, parameter, &value);
+        write<int32_t>(value);
+    }
+
+    GLint pack_alignment = 4, pack_buffer = 0;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &pack_alignment);
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    for(int level = 0; level < levels; level++){
+        std::array<int32_t, 3> size = levelSize(level);
+
+        size_t bytes = 0;
+        if(compressed){
+            GLint image_size = 0;
+            glGetTextureLevelParameteriv(name, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &image_size);
+            bytes = (size_t) image_size * (cube ? 6 : 1);
+        }
+        else bytes = (size_t) size[0] * size[1] * size[2] * readback.pixel_size;
+
+        write(size.data(), sizeof(size));
+        write<uint64_t>(bytes);
+
+        size_t offset = record.size();
+        record.resize(offset + bytes);
+        if(compressed) glGetCompressedTextureImage(name, level, bytes, record.data() + offset);
+        else glGetTextureImage(name, level, readback.format, readback.type, bytes, record.data() + offset);
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, pack_alignment);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_buffer);
+
+    endRecord();
+}
+
+void FrameCapture::snapshotProgram(ShaderProgram& program){
+    uint name = program.getID();
+    programs.insert(name);
+
+    struct UniformValue{
+        std::string name;
+        uint type;
+        std::array<uint32_t, 16> value;
+    };
+    std::vector<UniformValue> values = {};
+
+    GLint uniform_count = 0, max_length = 0;
+    glGetProgramiv(name, GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(name, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    std::vector<char> name_buffer(max_length + 1);
+
+    for(GLuint index = 0; index < (GLuint) uniform_count; index++){
+        GLint size = 0, block = -1;
+        GLenum type = 0;
+        glGetActiveUniform(name, index, name_buffer.size(), nullptr, &size, &type, name_buffer.data());
+        glGetActiveUniformsiv(name, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+
+        std::string uniform_name = name_buffer.data();
+        UniformInfo info = uniformInfo(type);
+        if(block != -1 || info.components == 0 || uniform_name.starts_with("gl_")) continue;
+
+        bool array = uniform_name.ends_with("[0]");
+        if(array) uniform_name.resize(uniform_name.size() - 3);
+
+        // Arrays are stored element by element
+        for(int element = 0; element < size; element++){
+            UniformValue value = {array ? uniform_name + "[" + std::to_string(element) + "]" : uniform_name, type, {}};
+
+            int location = glGetUniformLocation(name, value.name.c_str());
+            if(location == -1) continue;
+
+            if(info.kind == UNIFORM_FLOAT) glGetUniformfv(name, location, reinterpret_cast<float*>(value.value.data()));
+            else if(info.kind == UNIFORM_UINT) glGetUniformuiv(name, location, value.value.data());
+            else glGetUniformiv(name, location, reinterpret_cast<int*>(value.value.data()));
+
+            values.push_back(std::move(value));
+        }
+    }
+
+    beginRecord(CAPTURE_PROGRAM_SNAPSHOT);
+    write<uint32_t>(name);
+
+#if HEPTCORE_CAPTURE
+    auto& sources = program.getSources();
+    write<uint32_t>(sources.size());
+    for(auto& [type, source]: sources){
+        write<uint32_t>(type);
+        writeString(source);
+    }
+#else
+    write<uint32_t>(0);
+#endif
+
+    write<uint32_t>(values.size());
+    for(auto& value: values){
+        writeString(value.name);
+        write<uint32_t>(value.type);
+        write(value.value.data(), uniformInfo(value.type).components * sizeof(uint32_t));
+    }
+    endRecord();
+}
+
+void FrameCapture::snapshotVertexArray(uint name, CaptureOp op){
+    vertex_arrays.insert(name);
+    if(!glIsVertexArray(name)) return;
+
+    struct Attribute{
+        uint32_t index;
+        uint32_t buffer;
+        int32_t size;
+        uint32_t type;
+        uint8_t normalized;
+        uint8_t integer;
+        int32_t stride;
+        uint32_t divisor;
+        uint64_t offset;
+    };
+    std::vector<Attribute> attributes = {};
+
+    // Attribute buffers can only be queried on the bound vao
+    GLint previous = 0, element_buffer = 0, max_attributes = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attributes);
+    glBindVertexArray(name);
+
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &element_buffer);
+    for(int i = 0; i < max_attributes; i++){
+        GLint enabled = 0;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+        if(!enabled) continue;
+
+        GLint buffer = 0, size = 0, type = 0, normalized = 0, integer = 0, stride = 0, divisor = 0;
+        void* pointer = nullptr;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &normalized);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &integer);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, &divisor);
+        glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+
+        attributes.push_back({(uint32_t) i, (uint32_t) buffer, size, (uint32_t) type, (uint8_t) normalized, (uint8_t) integer,
+            stride, (uint32_t) divisor, (uint64_t) reinterpret_cast<uintptr_t>(pointer)});
+    }
+
+    glBindVertexArray(previous);
+
+    // The buffers go into the capture first so replay can attach them
+    if(element_buffer && !buffers.contains(element_buffer)) snapshotBuffer(element_buffer, CAPTURE_BUFFER_SNAPSHOT);
+    for(auto& attribute: attributes)
+        if(attribute.buffer && !buffers.contains(attribute.buffer)) snapshotBuffer(attribute.buffer, CAPTURE_BUFFER_SNAPSHOT);
+
+    beginRecord(op);
+    write<uint32_t>(name);
+    write<uint32_t>(element_buffer);
+    write<uint32_t>(attributes.size());
+    for(auto& attribute: attributes){
+        write(attribute.index);
+        write(attribute.buffer);
+        write(attribute.size);
+        write(attribute.type);
+        write(attribute.normalized);
+        write(attribute.integer);
+        write(attribute.stride);
+        write(attribute.divisor);
+        write(attribute.offset);
+    }
+    endRecord();
+}
+
+void FrameCapture::snapshotFramebuffer(Framebuffer& framebuffer){
+    framebuffers.insert(framebuffer.getID());
+
+    const FramebufferSettings& settings = framebuffer.getSettings();
+    auto& color = framebuffer.getTextures();
+    Texture2D* depth = framebuffer.getDepthTexture();
+
+    beginRecord(CAPTURE_FRAMEBUFFER_SNAPSHOT);
+    write<uint32_t>(framebuffer.getID());
+    write<int32_t>(framebuffer.getWidth());
+    write<int32_t>(framebuffer.getHeight());
+    write<int32_t>(settings.samples);
+    write<int32_t>(settings.depth);
+    write<uint8_t>(settings.multisample_textures);
+    write<uint8_t>(settings.depth_texture);
+
+    write<uint32_t>(color.size());
+    for(auto& texture: color){
+        GLint internal_format = 0;
+        glGetTextureLevelParameteriv(texture.getID(), 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+        ReadbackFormat readback = readbackFormat(internal_format);
+
+        write<uint32_t>(texture.getID());
+        write<uint32_t>(internal_format);
+        write<uint32_t>(readback.format);
+        write<uint32_t>(readback.type);
+    }
+    write<uint32_t>(depth ? depth->getID() : 0);
+    endRecord();
+
+    // Replay creates the textures with the framebuffer, their contents come after it
+    for(auto& texture: color) snapshotTexture(texture.getID(), GL_TEXTURE_2D, CAPTURE_TEXTURE_SNAPSHOT);
+    if(depth) snapshotTexture(depth->getID(), GL_TEXTURE_2D, CAPTURE_TEXTURE_SNAPSHOT);
+}
+
+void FrameCapture::bufferData(uint name){
+    snapshotBuffer(name, CAPTURE_BUFFER_DATA);
+}
+
+void FrameCapture::bufferSubData(uint name, size_t offset, size_t size, const void* data){
+    if(!buffers.contains(name)) snapshotBuffer(name, CAPTURE_BUFFER_SNAPSHOT);
+
+    beginRecord(CAPTURE_BUFFER_SUBDATA);
+    write<uint32_t>(name);
+    write<uint64_t>(offset);
+    write<uint64_t>(size);
+    write(data, size);
+    endRecord();
+}
+
+void FrameCapture::textureData(uint name, uint target){
+    snapshotTexture(name, target, CAPTURE_TEXTURE_DATA);
+}
+
+void FrameCapture::bindTexture(uint name, uint target, int unit, const SamplerDescription* sampler){
+    if(!textures.contains(name)) snapshotTexture(name, target, CAPTURE_TEXTURE_SNAPSHOT);
+
+    beginRecord(CAPTURE_TEXTURE_BIND);
+    write<uint32_t>(name);
+    write<int32_t>(unit);
+    write<uint8_t>(sampler != nullptr);
+    if(sampler) write(*sampler);
+    endRecord();
+}
+
+void FrameCapture::unbindTexture(uint name, uint target, int unit){
+    if(!textures.contains(name)) snapshotTexture(name, target, CAPTURE_TEXTURE_SNAPSHOT);
+
+    beginRecord(CAPTURE_TEXTURE_UNBIND);
+    write<uint32_t>(name);
+    write<int32_t>(unit);
+    endRecord();
+}
+
+void FrameCapture::textureParameter(uint name, uint target, int identifier, int value){
+    if(!textures.contains(name)) snapshotTexture(name, target, CAPTURE_TEXTURE_SNAPSHOT);
+
+    beginRecord(CAPTURE_TEXTURE_PARAMETER);
+    write<uint32_t>(name);
+    write<int32_t>(identifier);
+    write<int32_t>(value);
+    endRecord();
+}
+
+void FrameCapture::useProgram(ShaderProgram& program){
+    if(!programs.contains(program.getID())) snapshotProgram(program);
+
+    beginRecord(CAPTURE_PROGRAM_USE);
+    write<uint32_t>(program.getID());
+    endRecord();
+}
+
+void FrameCapture::uniform(const std::string& name, uint type, int count, const void* data){
+    UniformInfo info = uniformInfo(type);
+    if(info.components == 0 || count <= 0) return;
+
+    beginRecord(CAPTURE_UNIFORM);
+    writeString(name);
+    write<uint32_t>(type);
+    write<int32_t>(count);
+    write(data, (size_t) count * info.components * sizeof(uint32_t));
+    endRecord();
+}
+
+void FrameCapture::bindFramebuffer(Framebuffer* framebuffer){
+    if(framebuffer && !framebuffers.contains(framebuffer->getID())) snapshotFramebuffer(*framebuffer);
+
+    beginRecord(CAPTURE_FRAMEBUFFER_BIND);
+    write<uint32_t>(framebuffer ? framebuffer->getID() : 0);
+    endRecord();
+}
+
+void FrameCapture::resolveFramebuffer(Framebuffer& framebuffer, bool invalidate){
+    if(!framebuffers.contains(framebuffer.getID())) snapshotFramebuffer(framebuffer);
+
+    beginRecord(CAPTURE_FRAMEBUFFER_RESOLVE);
+    write<uint32_t>(framebuffer.getID());
+    write<uint8_t>(invalidate);
+    endRecord();
+}
+
+void FrameCapture::invalidateDepth(Framebuffer& framebuffer){
+    if(!framebuffers.contains(framebuffer.getID())) snapshotFramebuffer(framebuffer);
+
+    beginRecord(CAPTURE_FRAMEBUFFER_INVALIDATE_DEPTH);
+    write<uint32_t>(framebuffer.getID());
+    endRecord();
+}
+
+void FrameCapture::bindVertexArray(uint name){
+    if(!vertex_arrays.contains(name)) snapshotVertexArray(name, CAPTURE_VERTEX_ARRAY_SNAPSHOT);
+
+    beginRecord(CAPTURE_VERTEX_ARRAY_BIND);
+    write<uint32_t>(name);
+    endRecord();
+}
+
+void FrameCapture::vertexArrayChanged(uint name){
+    snapshotVertexArray(name, CAPTURE_VERTEX_ARRAY_FORMAT);
+}
+
+void FrameCapture::draw(uint vertex_array, uint mode, int first, int count, int instances, uint base_instance){
+    if(!vertex_arrays.contains(vertex_array)) snapshotVertexArray(vertex_array, CAPTURE_VERTEX_ARRAY_SNAPSHOT);
+    renderState();
+
+    beginRecord(CAPTURE_DRAW);
+    write<uint32_t>(vertex_array);
+    write<uint32_t>(mode);
+    write<int32_t>(first);
+    write<int32_t>(count);
+    write<int32_t>(instances);
+    write<uint32_t>(base_instance);
+    endRecord();
+}
+
+void FrameCapture::drawIndexed(uint vertex_array, uint mode, int count, uint index_type, size_t offset, int instances){
+    if(!vertex_arrays.contains(vertex_array)) snapshotVertexArray(vertex_array, CAPTURE_VERTEX_ARRAY_SNAPSHOT);
+    renderState();
+
+    beginRecord(CAPTURE_DRAW_INDEXED);
+    write<uint32_t>(vertex_array);
+    write<uint32_t>(mode);
+    write<int32_t>(count);
+    write<uint32_t>(index_type);
+    write<uint64_t>(offset);
+    write<int32_t>(instances);
+    endRecord();
+}
+
+void FrameCapture::renderQuad(){
+    renderState();
+    beginRecord(CAPTURE_QUAD);
+    endRecord();
+}
+
+void FrameCapture::clear(uint mask){
+    renderState(); // Scissor and write masks apply to clears
+
+    GLfloat color[4] = {};
+    GLfloat depth = 1.0f;
+    GLint stencil = 0;
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+    glGetFloatv(GL_DEPTH_CLEAR_VALUE, &depth);
+    glGetIntegerv(GL_STENCIL_CLEAR_VALUE, &stencil);
+
+    beginRecord(CAPTURE_CLEAR);
+    write<uint32_t>(mask);
+    write(color, sizeof(color));
+    write<float>(depth);
+    write<int32_t>(stencil);
+    endRecord();
+}
+
+void FrameCapture::rawUniform(int location, uint type, int count, const void* data){
+    if(location < 0) return;
+
+    // Only programs used through ShaderProgram are in the capture, replay sets uniforms by name
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    if(!programs.contains(program)) return;
+
+    const std::string* name = uniformName(program, location);
+    if(name) uniform(*name, type, count, data);
+}
+
+void FrameCapture::rawDraw(uint mode, int first, int count, int instances, uint base_instance){
+    GLint vertex_array = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array);
+    if(vertex_array) draw(vertex_array, mode, first, count, instances, base_instance);
+}
+
+void FrameCapture::rawDrawIndexed(uint mode, int count, uint index_type, size_t offset, int instances){
+    GLint vertex_array = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array);
+    if(vertex_array) drawIndexed(vertex_array, mode, count, index_type, offset, instances);
+}
+
+void FrameCapture::bindBuffer(uint target, uint index, uint name, size_t offset, size_t size){
+    if(name && !buffers.contains(name)) snapshotBuffer(name, CAPTURE_BUFFER_SNAPSHOT);
+
+    beginRecord(CAPTURE_BUFFER_BIND);
+    write<uint32_t>(target);
+    write<uint32_t>(index);
+    write<uint32_t>(name);
+    write<uint64_t>(offset);
+    write<uint64_t>(size); // 0 is the whole buffer
+    endRecord();
+}
+
+void FrameCapture::clearBuffer(uint name, uint internal_format, uint format, uint type, const void* data){
+    if(!buffers.contains(name)) snapshotBuffer(name, CAPTURE_BUFFER_SNAPSHOT);
+
+    uint32_t size = data ? clearValueSize(format, type) : 0; // No data clears to zero
+    beginRecord(CAPTURE_BUFFER_CLEAR);
+    write<uint32_t>(name);
+    write<uint32_t>(internal_format);
+    write<uint32_t>(format);
+    write<uint32_t>(type);
+    write<uint32_t>(size);
+    if(size) write(data, size);
+    endRecord();
+}
+
+void FrameCapture::bindImage(uint unit, uint name, int level, bool layered, int layer, uint access, uint format){
+    if(name && !textures.contains(name)){
+        GLint target = 0;
+        glGetTextureParameteriv(name, GL_TEXTURE_TARGET, &target);
+        snapshotTexture(name, target, CAPTURE_TEXTURE_SNAPSHOT);
+    }
+
+    beginRecord(CAPTURE_IMAGE_BIND);
+    write<uint32_t>(unit);
+    write<uint32_t>(name);
+    write<int32_t>(level);
+    write<uint8_t>(layered);
+    write<int32_t>(layer);
+    write<uint32_t>(access);
+    write<uint32_t>(format);
+    endRecord();
+}
+
+void FrameCapture::dispatch(uint groups_x, uint groups_y, uint groups_z){
+    beginRecord(CAPTURE_DISPATCH);
+    write<uint32_t>(groups_x);
+    write<uint32_t>(groups_y);
+    write<uint32_t>(groups_z);
+    endRecord();
+}
+
+void FrameCapture::dispatchIndirect(size_t offset){
+    GLint buffer = 0;
+    glGetIntegerv(GL_DISPATCH_INDIRECT_BUFFER_BINDING, &buffer);
+    if(buffer && !buffers.contains(buffer)) snapshotBuffer(buffer, CAPTURE_BUFFER_SNAPSHOT);
+
+    beginRecord(CAPTURE_DISPATCH_INDIRECT);
+    write<uint32_t>(buffer);
+    write<uint64_t>(offset);
+    endRecord();
+}
+
+void FrameCapture::memoryBarrier(uint barriers){
+    beginRecord(CAPTURE_MEMORY_BARRIER);
+    write<uint32_t>(barriers);
+    endRecord();
+}
+
+/*
+    Replay
+*/
+
+namespace Heptcore{
+    /*
+        Texture recreated from a snapshot, immutable storage of the captured size
+    */
+    class CapturedTexture: public BindableTexture{
+        public:
+            CapturedTexture(uint target, uint internal_format, int levels, int width, int height, int depth){
+                glDeleteTextures(1, &texture);
+                glCreateTextures(target, 1, &texture);
+                TYPE = target;
+
+                if(target == GL_TEXTURE_1D) glTextureStorage1D(texture, levels, internal_format, width);
+                else if(target == GL_TEXTURE_2D || target == GL_TEXTURE_1D_ARRAY || target == GL_TEXTURE_RECTANGLE || target == GL_TEXTURE_CUBE_MAP)
+                    glTextureStorage2D(texture, levels, internal_format, width, height);
+                else glTextureStorage3D(texture, levels, internal_format, width, height, depth);
+
+                setMemorySize(textureMemorySize(internal_format, width, height, levels) * depth);
+            }
+    };
+}
+
+/*
+    Bounds checked reads from a record payload
+*/
+class CaptureReader{
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t offset = 0;
+    public:
+        CaptureReader(const uint8_t* data, size_t size): data(data), size(size){}
+
+        const uint8_t* bytes(size_t count){
+            if(offset + count > size) throw std::runtime_error("Capture record is truncated.");
+            const uint8_t* begin = data + offset;
+            offset += count;
+            return begin;
+        }
+        template <typename T>
+        T read(){
+            T value;
+            std::memcpy(&value, bytes(sizeof(T)), sizeof(T));
+            return value;
+        }
+        std::string readString(){
+            uint32_t length = read<uint32_t>();
+            const uint8_t* begin = bytes(length);
+            return std::string(reinterpret_cast<const char*>(begin), length);
+        }
+};
+
+CaptureReplay::CaptureReplay() = default;
+
+CaptureReplay::~CaptureReplay(){
+    if(!timestamp_queries.empty()) glDeleteQueries(timestamp_queries.size(), timestamp_queries.data());
+
+    // Framebuffer textures are referenced by textures
+    textures.clear();
+}
+
+void CaptureReplay::load(const std::string& filename){
+    std::ifstream input(filename, std::ios::binary);
+    if(!input) throw std::runtime_error("Failed to open capture: " + filename);
+
+    data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    snapshots.clear();
+    frames.clear();
+
+    CaptureReader header(data.data(), data.size());
+    if(std::memcmp(header.bytes(sizeof(CAPTURE_MAGIC)), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0)
+        throw std::runtime_error("Not a capture file: " + filename);
+    if(header.read<uint32_t>() != CAPTURE_VERSION) throw std::runtime_error("Unsupported capture version: " + filename);
+
+    width = header.read<int32_t>();
+    height = header.read<int32_t>();
+    header.read<uint32_t>(); // Frame count, 0 if the capture never finished, the records tell anyway
+
+    size_t offset = CAPTURE_FRAME_COUNT_OFFSET + sizeof(uint32_t);
+    while(offset < data.size()){
+        if(offset + 5 > data.size()) break; // Cut off while writing
+
+        CaptureOp op = (CaptureOp) data[offset];
+        uint32_t size = 0;
+        std::memcpy(&size, data.data() + offset + 1, sizeof(uint32_t));
+        if(op >= CAPTURE_OP_COUNT) throw std::runtime_error("Corrupt capture: " + filename);
+        if(offset + 5 + size > data.size()) break;
+
+        Record record = {op, offset + 5, size};
+        offset += 5 + size;
+
+        if(isSnapshot(op)) snapshots.push_back(record);
+        else if(op == CAPTURE_FRAME_BEGIN) frames.push_back({record});
+        else if(!frames.empty()) frames.back().push_back(record);
+        else throw std::runtime_error("Corrupt capture: " + filename);
+    }
+}
+
+CaptureReplay::ReplayTexture* CaptureReplay::texture(uint name){
+    auto found = textures.find(name);
+    if(found == textures.end() || !found->second.texture) return nullptr;
+    return &found->second;
+}
+
+void CaptureReplay::restore(){
+    HEPTCORE_DEBUG_GROUP("CaptureReplay::restore");
+
+    Framebuffer::bindDefault();
+    current_program = nullptr;
+    textures.clear();
+    framebuffers.clear();
+    vertex_arrays.clear();
+    programs.clear();
+    buffers.clear();
+
+    if(!quad) quad = std::make_unique<FullscreenQuad>();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for(auto& record: snapshots) execute(record);
+}
+
+void CaptureReplay::replayFrame(size_t frame, CaptureTimings* timings){
+    auto& records = frames.at(frame);
+    bool gpu = timings && timings->gpu;
+
+    if(gpu && timestamp_queries.size() < records.size() * 2){
+        size_t created = timestamp_queries.size();
+        timestamp_queries.resize(records.size() * 2);
+        glGenQueries(timestamp_queries.size() - created, timestamp_queries.data() + created);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for(size_t i = 0; i < records.size(); i++){
+        const Record& record = records[i];
+        if(!timings){
+            execute(record);
+            continue;
+        }
+
+        if(gpu) glQueryCounter(timestamp_queries[i * 2], GL_TIMESTAMP);
+        auto start = std::chrono::steady_clock::now();
+
+        execute(record);
+
+        auto end = std::chrono::steady_clock::now();
+        if(gpu) glQueryCounter(timestamp_queries[i * 2 + 1], GL_TIMESTAMP);
+
+        CaptureCallTiming& call = timings->calls[record.op];
+        call.count++;
+        call.cpu_ms += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    if(!gpu) return;
+
+    for(size_t i = 0; i < records.size(); i++){
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(timestamp_queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(timestamp_queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        timings->calls[records[i].op].gpu_ms += (end - begin) / 1000000.0;
+    }
+}
+
+void CaptureReplay::textureRecord(const Record& record){
+    CaptureReader reader(data.data() + record.offset, record.size);
+
+    uint name = reader.read<uint32_t>();
+    uint target = reader.read<uint32_t>();
+    uint internal_format = reader.read<uint32_t>();
+    bool compressed = reader.read<uint8_t>();
+    uint format = reader.read<uint32_t>();
+    uint type = reader.read<uint32_t>();
+    int levels = reader.read<uint32_t>();
+    int width = reader.read<int32_t>();
+    int height = reader.read<int32_t>();
+    int depth = reader.read<int32_t>();
+
+    // Framebuffer textures already exist and keep being used if the storage still matches
+    ReplayTexture& entry = textures[name];
+    bool matches = entry.texture && entry.texture->getType() == target && entry.internal_format == (int) internal_format &&
+        entry.width == width && entry.height == height && entry.depth == depth && entry.levels == levels;
+    if(!matches){
+        entry.owned = std::make_unique<CapturedTexture>(target, internal_format, levels, width, height, depth);
+        entry.texture = entry.owned.get();
+        entry.internal_format = internal_format;
+        entry.width = width;
+        entry.height = height;
+        entry.depth = depth;
+        entry.levels = levels;
+    }
+
+    uint id = entry.texture->getID();
+    for(GLenum parameter: TEXTURE_PARAMETERS) glTextureParameteri(id, parameter, reader.read<int32_t>());
+
+    bool layered = !(target == GL_TEXTURE_1D || target == GL_TEXTURE_2D || target == GL_TEXTURE_1D_ARRAY || target == GL_TEXTURE_RECTANGLE);
+    for(int level = 0; level < levels; level++){
+        int level_width = reader.read<int32_t>();
+        int level_height = reader.read<int32_t>();
+        int level_depth = reader.read<int32_t>();
+        size_t bytes = reader.read<uint64_t>();
+        const uint8_t* pixels = reader.bytes(bytes);
+
+        if(compressed){
+            if(target == GL_TEXTURE_1D) glCompressedTextureSubImage1D(id, level, 0, level_width, internal_format, bytes, pixels);
+            else if(!layered) glCompressedTextureSubImage2D(id, level, 0, 0, level_width, level_height, internal_format, bytes, pixels);
+            else glCompressedTextureSubImage3D(id, level, 0, 0, 0, level_width, level_height, level_depth, internal_format, bytes, pixels);
+        }
+        else{
+            if(target == GL_TEXTURE_1D) glTextureSubImage1D(id, level, 0, level_width, format, type, pixels);
+            else if(!layered) glTextureSubImage2D(id, level, 0, 0, level_width, level_height, format, type, pixels);
+            else glTextureSubImage3D(id, level, 0, 0, 0, level_width, level_height, level_depth, format, type, pixels);
+        }
+    }
+}
+
+void CaptureReplay::framebufferRecord(const Record& record){
+    CaptureReader reader(data.data() + record.offset, record.size);
+
+    uint name = reader.read<uint32_t>();
+    int framebuffer_width = reader.read<int32_t>();
+    int framebuffer_height = reader.read<int32_t>();
+
+    FramebufferSettings settings = {};
+    settings.samples = reader.read<int32_t>();
+    settings.depth = (FramebufferDepth) reader.read<int32_t>();
+    settings.multisample_textures = reader.read<uint8_t>();
+    settings.depth_texture = reader.read<uint8_t>();
+
+    std::vector<uint> color_names(reader.read<uint32_t>());
+    std::vector<Framebuffer::FramebufferTexture> definitions(color_names.size());
+    for(size_t i = 0; i < color_names.size(); i++){
+        color_names[i] = reader.read<uint32_t>();
+        definitions[i].internal_format = reader.read<uint32_t>();
+        definitions[i].format = reader.read<uint32_t>();
+        definitions[i].data_type = reader.read<uint32_t>();
+    }
+    uint depth_name = reader.read<uint32_t>();
+
+    auto framebuffer = std::make_unique<Framebuffer>(framebuffer_width, framebuffer_height, definitions, settings);
+
+    // Captured names of the attachments now resolve to the textures of the new framebuffer
+    auto attach = [&](uint captured, Texture2D* attachment){
+        GLint internal_format = 0;
+        glGetTextureLevelParameteriv(attachment->getID(), 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+
+        ReplayTexture& entry = textures[captured];
+        entry.owned = nullptr;
+        entry.texture = attachment;
+        entry.internal_format = internal_format;
+        entry.width = framebuffer_width;
+        entry.height = framebuffer_height;
+        entry.depth = 1;
+        entry.levels = 1;
+    };
+    for(size_t i = 0; i < color_names.size(); i++) attach(color_names[i], &framebuffer->getTextures()[i]);
+    if(depth_name && framebuffer->getDepthTexture()) attach(depth_name, framebuffer->getDepthTexture());
+
+    framebuffers[name] = std::move(framebuffer);
+}
+
+void CaptureReplay::vertexArrayRecord(const Record& record){
+    CaptureReader reader(data.data() + record.offset, record.size);
+
+    uint name = reader.read<uint32_t>();
+    uint element_buffer = reader.read<uint32_t>();
+    uint attribute_count = reader.read<uint32_t>();
+
+    auto vao = std::make_unique<VertexArrayObject>();
+    vao->bind(); // Names from glGenVertexArrays only become objects once bound
+    vao->unbind();
+    uint id = vao->getID();
+
+    auto bufferID = [&](uint captured) -> uint{
+        auto found = buffers.find(captured);
+        return found == buffers.end() ? 0 : found->second->getID();
+    };
+
+    for(uint i = 0; i < attribute_count; i++){
+        uint index = reader.read<uint32_t>();
+        uint buffer = bufferID(reader.read<uint32_t>());
+        int size = reader.read<int32_t>();
+        uint type = reader.read<uint32_t>();
+        bool normalized = reader.read<uint8_t>();
+        bool integer = reader.read<uint8_t>();
+        int stride = reader.read<int32_t>();
+        uint divisor = reader.read<uint32_t>();
+        uint64_t offset = reader.read<uint64_t>();
+        if(!buffer) continue;
+
+        // A stride of 0 meant tightly packed
+        if(stride == 0){
+            int component_size = (type == GL_BYTE || type == GL_UNSIGNED_BYTE) ? 1 : (type == GL_SHORT || type == GL_UNSIGNED_SHORT || type == GL_HALF_FLOAT) ? 2 : type == GL_DOUBLE ? 8 : 4;
+            stride = size * component_size;
+        }
+
+        // Every attribute gets the binding of the same index, like glVertexAttribPointer does
+        glVertexArrayVertexBuffer(id, index, buffer, offset, stride);
+        if(integer) glVertexArrayAttribIFormat(id, index, size, type, 0);
+        else glVertexArrayAttribFormat(id, index, size, type, normalized, 0);
+        glVertexArrayAttribBinding(id, index, index);
+        glVertexArrayBindingDivisor(id, index, divisor);
+        glEnableVertexArrayAttrib(id, index);
+    }
+
+    if(element_buffer) glVertexArrayElementBuffer(id, bufferID(element_buffer));
+
+    vertex_arrays[name] = std::move(vao);
+}
+
+void CaptureReplay::programRecord(const Record& record){
+    CaptureReader reader(data.data() + record.offset, record.size);
+
+    uint name = reader.read<uint32_t>();
+
+    ReplayProgram replay = {std::make_unique<ShaderProgram>(), {}};
+    uint source_count = reader.read<uint32_t>();
+    for(uint i = 0; i < source_count; i++){
+        int type = reader.read<uint32_t>();
+        replay.program->addShaderSource(reader.readString(), type, "capture");
+    }
+    if(source_count > 0) replay.program->compile();
+
+    uint program = replay.program->getID();
+    uint uniform_count = reader.read<uint32_t>();
+    for(uint i = 0; i < uniform_count; i++){
+        std::string uniform_name = reader.readString();
+        uint type = reader.read<uint32_t>();
+        const uint8_t* value = reader.bytes(uniformInfo(type).components * sizeof(uint32_t));
+
+        int location = glGetUniformLocation(program, uniform_name.c_str());
+        replay.locations[uniform_name] = location;
+        if(location != -1) setProgramUniform(program, location, type, 1, value);
+    }
+
+    programs[name] = std::move(replay);
+}
+
+void CaptureReplay::execute(const Record& record){
+    CaptureReader reader(data.data() + record.offset, record.size);
+
+    switch(record.op){
+        case CAPTURE_FRAME_BEGIN:{
+            GLint viewport[4];
+            std::memcpy(viewport, reader.bytes(sizeof(viewport)), sizeof(viewport));
+            bool depth_test = reader.read<uint8_t>();
+            bool blend = reader.read<uint8_t>();
+            bool cull = reader.read<uint8_t>();
+
+            Framebuffer::bindDefault();
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+            depth_test ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+            blend ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+            cull ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+            break;
+        }
+        case CAPTURE_FRAME_END:
+            break;
+
+        case CAPTURE_BUFFER_SNAPSHOT:
+        case CAPTURE_BUFFER_DATA:{
+            uint name = reader.read<uint32_t>();
+            size_t size = reader.read<uint64_t>();
+            const uint8_t* contents = reader.bytes(size);
+
+            // Same size keeps the buffer so vertex arrays pointing at it stay valid
+            auto& buffer = buffers[name];
+            if(buffer && buffer->size() == size){
+                if(size > 0) buffer->insert(0, size, contents);
+                break;
+            }
+            buffer = std::make_unique<Buffer<unsigned char, GL_ARRAY_BUFFER>>();
+            buffer->initialize(size, contents);
+            break;
+        }
+        case CAPTURE_BUFFER_SUBDATA:{
+            uint name = reader.read<uint32_t>();
+            size_t offset = reader.read<uint64_t>();
+            size_t size = reader.read<uint64_t>();
+            const uint8_t* contents = reader.bytes(size);
+
+            auto found = buffers.find(name);
+            if(found != buffers.end() && offset + size <= found->second->size()) found->second->insert(offset, size, contents);
+            break;
+        }
+
+        case CAPTURE_TEXTURE_SNAPSHOT:
+        case CAPTURE_TEXTURE_DATA:
+            textureRecord(record);
+            break;
+        case CAPTURE_TEXTURE_BIND:{
+            ReplayTexture* bound = texture(reader.read<uint32_t>());
+            int unit = reader.read<int32_t>();
+            bool has_sampler = reader.read<uint8_t>();
+            SamplerDescription description = {};
+            if(has_sampler) description = reader.read<SamplerDescription>();
+            if(!bound) break;
+
+            if(has_sampler) bound->texture->bind(unit, samplerCache().get(description));
+            else bound->texture->bind(unit);
+            break;
+        }
+        case CAPTURE_TEXTURE_UNBIND:{
+            ReplayTexture* bound = texture(reader.read<uint32_t>());
+            int unit = reader.read<int32_t>();
+            if(bound) bound->texture->unbind(unit);
+            break;
+        }
+        case CAPTURE_TEXTURE_PARAMETER:{
+            ReplayTexture* changed = texture(reader.read<uint32_t>());
+            int identifier = reader.read<int32_t>();
+            int value = reader.read<int32_t>();
+            if(changed) glTextureParameteri(changed->texture->getID(), identifier, value);
+            break;
+        }
+
+        case CAPTURE_PROGRAM_SNAPSHOT:
+            programRecord(record);
+            break;
+        case CAPTURE_PROGRAM_USE:{
+            auto found = programs.find(reader.read<uint32_t>());
+            if(found == programs.end()){
+                current_program = nullptr;
+                break;
+            }
+            current_program = &found->second;
+            current_program->program->use();
+            break;
+        }
+        case CAPTURE_UNIFORM:{
+            std::string name = reader.readString();
+            uint type = reader.read<uint32_t>();
+            int count = reader.read<int32_t>();
+            const uint8_t* value = reader.bytes((size_t) count * uniformInfo(type).components * sizeof(uint32_t));
+            if(!current_program) break;
+
+            uint program = current_program->program->getID();
+            auto location = current_program->locations.find(name);
+            if(location == current_program->locations.end())
+                location = current_program->locations.emplace(name, glGetUniformLocation(program, name.c_str())).first;
+            if(location->second != -1) setProgramUniform(program, location->second, type, count, value);
+            break;
+        }
+
+        case CAPTURE_FRAMEBUFFER_SNAPSHOT:
+            framebufferRecord(record);
+            break;
+        case CAPTURE_FRAMEBUFFER_BIND:{
+            // The viewport comes with the render state before the next draw
+            uint name = reader.read<uint32_t>();
+            auto found = framebuffers.find(name);
+            if(name == 0 || found == framebuffers.end()) Framebuffer::bindDefault();
+            else found->second->bind();
+            break;
+        }
+        case CAPTURE_FRAMEBUFFER_RESOLVE:{
+            auto found = framebuffers.find(reader.read<uint32_t>());
+            bool invalidate = reader.read<uint8_t>();
+            if(found != framebuffers.end()) found->second->resolve(invalidate);
+            break;
+        }
+        case CAPTURE_FRAMEBUFFER_INVALIDATE_DEPTH:{
+            auto found = framebuffers.find(reader.read<uint32_t>());
+            if(found != framebuffers.end()) found->second->invalidateDepth();
+            break;
+        }
+
+        case CAPTURE_VERTEX_ARRAY_SNAPSHOT:
+        case CAPTURE_VERTEX_ARRAY_FORMAT:
+            vertexArrayRecord(record);
+            break;
+        case CAPTURE_VERTEX_ARRAY_BIND:{
+            auto found = vertex_arrays.find(reader.read<uint32_t>());
+            if(found != vertex_arrays.end()) found->second->bind();
+            break;
+        }
+        case CAPTURE_DRAW:{
+            auto found = vertex_arrays.find(reader.read<uint32_t>());
+            uint mode = reader.read<uint32_t>();
+            int first = reader.read<int32_t>();
+            int count = reader.read<int32_t>();
+            int instances = reader.read<int32_t>();
+            uint base_instance = reader.read<uint32_t>();
+            if(found == vertex_arrays.end()) break;
+
+            if(base_instance == 0) found->second->draw(mode, first, count, instances);
+            else{
+                found->second->bind();
+                glDrawArraysInstancedBaseInstance(mode, first, count, instances, base_instance);
+            }
+            break;
+        }
+        case CAPTURE_DRAW_INDEXED:{
+            auto found = vertex_arrays.find(reader.read<uint32_t>());
+            uint mode = reader.read<uint32_t>();
+            int count = reader.read<int32_t>();
+            uint index_type = reader.read<uint32_t>();
+            size_t offset = reader.read<uint64_t>();
+            int instances = reader.read<int32_t>();
+            if(found != vertex_arrays.end()) found->second->drawIndexed(mode, count, index_type, offset, instances);
+            break;
+        }
+        case CAPTURE_QUAD:
+            quad->render();
+            break;
+
+        case CAPTURE_RENDER_STATE:
+            applyRenderState(reader.read<CaptureRenderState>());
+            break;
+        case CAPTURE_CLEAR:{
+            uint mask = reader.read<uint32_t>();
+            float color[4];
+            std::memcpy(color, reader.bytes(sizeof(color)), sizeof(color));
+            float depth = reader.read<float>();
+            int stencil = reader.read<int32_t>();
+
+            glClearColor(color[0], color[1], color[2], color[3]);
+            glClearDepth(depth);
+            glClearStencil(stencil);
+            glClear(mask);
+            break;
+        }
+        case CAPTURE_BUFFER_BIND:{
+            uint target = reader.read<uint32_t>();
+            uint index = reader.read<uint32_t>();
+            auto found = buffers.find(reader.read<uint32_t>());
+            size_t offset = reader.read<uint64_t>();
+            size_t size = reader.read<uint64_t>();
+
+            uint id = found == buffers.end() ? 0 : found->second->getID();
+            if(size == 0 || !id) glBindBufferBase(target, index, id);
+            else glBindBufferRange(target, index, id, offset, size);
+            break;
+        }
+        case CAPTURE_BUFFER_CLEAR:{
+            auto found = buffers.find(reader.read<uint32_t>());
+            uint internal_format = reader.read<uint32_t>();
+            uint format = reader.read<uint32_t>();
+            uint type = reader.read<uint32_t>();
+            uint32_t size = reader.read<uint32_t>();
+            const uint8_t* value = size ? reader.bytes(size) : nullptr;
+            if(found != buffers.end()) glClearNamedBufferData(found->second->getID(), internal_format, format, type, value);
+            break;
+        }
+        case CAPTURE_IMAGE_BIND:{
+            uint unit = reader.read<uint32_t>();
+            uint name = reader.read<uint32_t>();
+            int level = reader.read<int32_t>();
+            bool layered = reader.read<uint8_t>();
+            int layer = reader.read<int32_t>();
+            uint access = reader.read<uint32_t>();
+            uint format = reader.read<uint32_t>();
+
+            ReplayTexture* bound = texture(name);
+            glBindImageTexture(unit, bound ? bound->texture->getID() : 0, level, layered, layer, access, format);
+            break;
+        }
+        case CAPTURE_DISPATCH:{
+            uint groups_x = reader.read<uint32_t>();
+            uint groups_y = reader.read<uint32_t>();
+            uint groups_z = reader.read<uint32_t>();
+            glDispatchCompute(groups_x, groups_y, groups_z);
+            break;
+        }
+        case CAPTURE_DISPATCH_INDIRECT:{
+            auto found = buffers.find(reader.read<uint32_t>());
+            size_t offset = reader.read<uint64_t>();
+            if(found == buffers.end()) break;
+
+            glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, found->second->getID());
+            glDispatchComputeIndirect(offset);
+            glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+            break;
+        }
+        case CAPTURE_MEMORY_BARRIER:
+            glMemoryBarrier(reader.read<uint32_t>());
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,358 @@
+#include <opengl/clustered_lighting.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Heptcore;
+
+static const char* include_source = R"(
+#pragma once
+
+// Culling passes define HEPTCORE_CLUSTER_ACCESS empty to write the lists
+#ifndef HEPTCORE_CLUSTER_ACCESS
+#define HEPTCORE_CLUSTER_ACCESS readonly
+#endif
+
+struct HeptcorePointLight{
+    vec3 position;
+    float radius;
+    vec3 color;
+    float intensity;
+};
+
+layout(std140, binding = 4) uniform HeptcoreClusterParameters{
+    mat4 heptcoreClusterView;
+    mat4 heptcoreClusterProjection;
+    uvec4 heptcoreClusterGrid; // Tiles x, tiles y, slices, light count
+    vec4 heptcoreClusterScreen; // Tile width, tile height, viewport width, viewport height in pixels
+    vec4 heptcoreClusterDepth; // Near, far, slice scale, slice bias
+};
+
+layout(std430, binding = 4) readonly buffer HeptcoreLights{
+    HeptcorePointLight heptcoreLights[];
+};
+layout(std430, binding = 5) HEPTCORE_CLUSTER_ACCESS buffer HeptcoreClusterLights{
+    uvec2 heptcoreClusterLights[]; // Offset into heptcoreLightIndices, count
+};
+layout(std430, binding = 6) HEPTCORE_CLUSTER_ACCESS buffer HeptcoreLightIndices{
+    uint heptcoreLightIndices[];
+};
+
+// Positive view space distance of a depth buffer value
+float heptcoreLinearDepth(float depth){
+    float near_plane = heptcoreClusterDepth.x;
+    float far_plane = heptcoreClusterDepth.y;
+    float ndc = depth * 2.0 - 1.0;
+    return 2.0 * near_plane * far_plane / (far_plane + near_plane - ndc * (far_plane - near_plane));
+}
+
+uint heptcoreClusterIndex(vec2 pixel, float view_depth){
+    uvec3 cluster;
+    cluster.xy = min(uvec2(pixel / heptcoreClusterScreen.xy), heptcoreClusterGrid.xy - 1u);
+    cluster.z = uint(clamp(log(view_depth) * heptcoreClusterDepth.z + heptcoreClusterDepth.w, 0.0, float(heptcoreClusterGrid.z - 1u)));
+    return cluster.x + cluster.y * heptcoreClusterGrid.x + cluster.z * heptcoreClusterGrid.x * heptcoreClusterGrid.y;
+}
+
+// (offset, count) of the lights touching the cluster of a fragment, pass gl_FragCoord
+uvec2 heptcoreClusterLightRange(vec4 frag_coord){
+    return heptcoreClusterLights[heptcoreClusterIndex(frag_coord.xy, heptcoreLinearDepth(frag_coord.z))];
+}
+
+HeptcorePointLight heptcoreClusterLight(uvec2 range, uint i){
+    return heptcoreLights[heptcoreLightIndices[range.x + i]];
+}
+
+// Inverse square falloff windowed to reach 0 at the radius
+float heptcoreLightAttenuation(HeptcorePointLight light, vec3 position){
+    vec3 offset = light.position - position;
+    float distance_squared = dot(offset, offset);
+    float window = clamp(1.0 - pow(distance_squared / (light.radius * light.radius), 2.0), 0.0, 1.0);
+    return window * window / max(distance_squared, 0.0001);
+}
+)";
+
+// View space bounds of every cluster, only when the projection or viewport changes
+static const char* bounds_source = R"(
+#version 450 core
+layout(local_size_x = 64) in;
+
+#include "heptcore/clustered_lighting.glsl"
+
+layout(std430, binding = 7) writeonly buffer ClusterBounds{
+    vec4 clusterBounds[]; // Min, max
+};
+
+vec3 nearPlanePoint(vec2 pixel, mat4 inverse_projection){
+    vec2 ndc = clamp(pixel / heptcoreClusterScreen.zw, 0.0, 1.0) * 2.0 - 1.0;
+    vec4 position = inverse_projection * vec4(ndc, -1.0, 1.0);
+    return position.xyz / position.w;
+}
+
+void main(){
+    uint index = gl_GlobalInvocationID.x;
+    uvec3 grid = heptcoreClusterGrid.xyz;
+    if(index >= grid.x * grid.y * grid.z) return;
+
+    uvec3 cluster = uvec3(index % grid.x, index / grid.x % grid.y, index / (grid.x * grid.y));
+
+    mat4 inverse_projection = inverse(heptcoreClusterProjection);
+    vec3 low = nearPlanePoint(vec2(cluster.xy) * heptcoreClusterScreen.xy, inverse_projection);
+    vec3 high = nearPlanePoint(vec2(cluster.xy + 1u) * heptcoreClusterScreen.xy, inverse_projection);
+
+    // Same exponential split heptcoreClusterIndex uses
+    float near_plane = heptcoreClusterDepth.x;
+    float far_plane = heptcoreClusterDepth.y;
+    float slice_near = -near_plane * pow(far_plane / near_plane, float(cluster.z) / float(grid.z));
+    float slice_far = -near_plane * pow(far_plane / near_plane, float(cluster.z + 1u) / float(grid.z));
+
+    // Rays through the tile corners cut by both slice planes
+    vec3 low_near = low * (slice_near / low.z);
+    vec3 low_far = low * (slice_far / low.z);
+    vec3 high_near = high * (slice_near / high.z);
+    vec3 high_far = high * (slice_far / high.z);
+
+    clusterBounds[index * 2u] = vec4(min(min(low_near, low_far), min(high_near, high_far)), 0.0);
+    clusterBounds[index * 2u + 1u] = vec4(max(max(low_near, low_far), max(high_near, high_far)), 0.0);
+}
+)";
+
+// Marks every cluster some depth sample falls into
+static const char* mark_source = R"(
+#version 450 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+#include "heptcore/clustered_lighting.glsl"
+
+layout(binding = 0) uniform sampler2D clusterDepth;
+
+layout(std430, binding = 8) writeonly buffer ClusterActive{
+    uint clusterActive[];
+};
+
+void main(){
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if(any(greaterThanEqual(pixel, ivec2(heptcoreClusterScreen.zw)))) return;
+
+    float depth = texelFetch(clusterDepth, pixel, 0).r;
+    if(depth >= 1.0) return; // Nothing rendered here
+
+    clusterActive[heptcoreClusterIndex(vec2(pixel) + 0.5, heptcoreLinearDepth(depth))] = 1u;
+}
+)";
+
+// Active clusters into a list, the count doubles as the indirect dispatch size of the assignment
+static const char* compact_source = R"(
+#version 450 core
+layout(local_size_x = 64) in;
+
+#include "heptcore/clustered_lighting.glsl"
+
+layout(std430, binding = 8) readonly buffer ClusterActive{
+    uint clusterActive[];
+};
+layout(std430, binding = 9) writeonly buffer ClusterActiveList{
+    uint clusterActiveList[];
+};
+layout(std430, binding = 10) buffer ClusterCounters{
+    uint clusterActiveCount; // Indirect dispatch x
+    uint clusterDispatchY;
+    uint clusterDispatchZ;
+    uint clusterIndexCount;
+};
+
+void main(){
+    uint index = gl_GlobalInvocationID.x;
+    if(index >= heptcoreClusterGrid.x * heptcoreClusterGrid.y * heptcoreClusterGrid.z) return;
+    if(clusterActive[index] == 0u) return;
+
+    clusterActiveList[atomicAdd(clusterActiveCount, 1u)] = index;
+}
+)";
+
+// One workgroup per active cluster, tests every light and appends the hits to the shared index list
+static const char* assign_source = R"(
+#version 450 core
+#define HEPTCORE_CLUSTER_ACCESS
+layout(local_size_x = 64) in;
+
+#include "heptcore/clustered_lighting.glsl"
+
+layout(std430, binding = 7) readonly buffer ClusterBounds{
+    vec4 clusterBounds[];
+};
+layout(std430, binding = 9) readonly buffer ClusterActiveList{
+    uint clusterActiveList[];
+};
+layout(std430, binding = 10) buffer ClusterCounters{
+    uint clusterActiveCount;
+    uint clusterDispatchY;
+    uint clusterDispatchZ;
+    uint clusterIndexCount;
+};
+
+uniform uint clusterIndexCapacity;
+
+shared uint found[MAX_CLUSTER_LIGHTS];
+shared uint found_count;
+shared uint found_offset;
+
+void main(){
+    uint cluster = clusterActiveList[gl_WorkGroupID.x];
+    uint local = gl_LocalInvocationIndex;
+
+    if(local == 0u) found_count = 0u;
+    barrier();
+
+    vec3 low = clusterBounds[cluster * 2u].xyz;
+    vec3 high = clusterBounds[cluster * 2u + 1u].xyz;
+
+    for(uint i = local; i < heptcoreClusterGrid.w; i += gl_WorkGroupSize.x){
+        HeptcorePointLight light = heptcoreLights[i];
+        vec3 center = (heptcoreClusterView * vec4(light.position, 1.0)).xyz;
+
+        // Sphere against box, through the closest point of the box
+        vec3 offset = clamp(center, low, high) - center;
+        if(dot(offset, offset) > light.radius * light.radius) continue;
+
+        uint slot = atomicAdd(found_count, 1u);
+        if(slot < MAX_CLUSTER_LIGHTS) found[slot] = i;
+    }
+    barrier();
+
+    if(local == 0u){
+        uint count = min(found_count, uint(MAX_CLUSTER_LIGHTS));
+        uint offset = atomicAdd(clusterIndexCount, count);
+        // Out of index space, the cluster keeps what still fits
+        count = offset >= clusterIndexCapacity ? 0u : min(count, clusterIndexCapacity - offset);
+
+        found_offset = offset;
+        found_count = count;
+        heptcoreClusterLights[cluster] = uvec2(offset, count);
+    }
+    barrier();
+
+    for(uint i = local; i < found_count; i += gl_WorkGroupSize.x) heptcoreLightIndices[found_offset + i] = found[i];
+}
+)";
+
+ClusteredLighting::ClusteredLighting(ShaderVariantCache& cache, ClusterGridSettings settings): cache(cache), settings(settings){
+    cluster_count = settings.tiles_x * settings.tiles_y * settings.slices;
+    index_capacity = (size_t) cluster_count * settings.average_lights_per_cluster;
+
+    shaderPreprocessor.addSource(include_name, include_source);
+
+    lights.initialize(64);
+    parameters.initialize(1);
+    cluster_lights.initialize(cluster_count * 2);
+    light_indices.initialize(index_capacity);
+    bounds.initialize(cluster_count * 2);
+    active.initialize(cluster_count);
+    active_list.initialize(cluster_count);
+    counters.initialize(4);
+
+    lights.label("ClusteredLighting lights");
+    cluster_lights.label("ClusteredLighting cluster lights");
+    light_indices.label("ClusteredLighting light indices");
+
+    uniformLinker().ignore("clusterDepth");
+    uniformLinker().ignore("clusterIndexCapacity");
+}
+
+void ClusteredLighting::setLights(const std::vector<PointLight>& new_lights){
+    light_count = new_lights.size();
+    if(light_count == 0) return;
+
+    if(light_count > lights.size()) lights.initialize(std::max(light_count, lights.size() * 2));
+    lights.insert(0, light_count, new_lights.data());
+}
+
+void ClusteredLighting::bind(){
+    glBindBufferBase(GL_UNIFORM_BUFFER, 4, parameters.getID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, lights.getID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, cluster_lights.getID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, light_indices.getID());
+}
+
+void ClusteredLighting::bindCullingBuffers(){
+    bind();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, bounds.getID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, active.getID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, active_list.getID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, counters.getID());
+}
+
+void ClusteredLighting::update(Framebuffer& framebuffer, const glm::mat4& view, const glm::mat4& projection){
+    Texture2D* depth = framebuffer.getDepthTexture();
+    if(!depth) throw std::logic_error("ClusteredLighting needs a framebuffer with FramebufferSettings::depth_texture.");
+
+    update(*depth, framebuffer.getWidth(), framebuffer.getHeight(), view, projection);
+}
+
+void ClusteredLighting::update(BindableTexture& depth, int width, int height, const glm::mat4& view, const glm::mat4& projection){
+    HEPTCORE_DEBUG_GROUP("ClusteredLighting::update");
+
+    // Planes straight from the perspective matrix
+    float near_plane = projection[3][2] / (projection[2][2] - 1.0f);
+    float far_plane = projection[3][2] / (projection[2][2] + 1.0f);
+    float log_range = std::log(far_plane / near_plane);
+
+    Parameters values = {};
+    values.view = view;
+    values.projection = projection;
+    values.tiles_x = settings.tiles_x;
+    values.tiles_y = settings.tiles_y;
+    values.slices = settings.slices;
+    values.light_count = (uint) light_count;
+    values.tile_width = std::ceil((float) width / settings.tiles_x);
+    values.tile_height = std::ceil((float) height / settings.tiles_y);
+    values.screen_width = (float) width;
+    values.screen_height = (float) height;
+    values.near_plane = near_plane;
+    values.far_plane = far_plane;
+    values.slice_scale = settings.slices / log_range;
+    values.slice_bias = -settings.slices * std::log(near_plane) / log_range;
+    parameters.insert(0, 1, &values);
+
+    // Dispatch (0 active, 1, 1), no indices used
+    uint reset[4] = {0, 1, 1, 0};
+    counters.insert(0, 4, reset);
+    glClearNamedBufferData(active.getID(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glClearNamedBufferData(cluster_lights.getID(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    bindCullingBuffers();
+
+    uint cluster_groups = (uint) (cluster_count + 63) / 64;
+
+    if(projection != bounds_projection || width != bounds_width || height != bounds_height){
+        cache.getFromSources({{bounds_source, GL_COMPUTE_SHADER}}).use();
+        glDispatchCompute(cluster_groups, 1, 1);
+        HEPTCORE_COUNT(dispatches, 1);
+
+        bounds_projection = projection;
+        bounds_width = width;
+        bounds_height = height;
+    }
+
+    cache.getFromSources({{mark_source, GL_COMPUTE_SHADER}}).use();
+    depth.bind(0);
+    glDispatchCompute((uint) (width + 7) / 8, (uint) (height + 7) / 8, 1);
+    HEPTCORE_COUNT(dispatches, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    cache.getFromSources({{compact_source, GL_COMPUTE_SHADER}}).use();
+    glDispatchCompute(cluster_groups, 1, 1);
+    HEPTCORE_COUNT(dispatches, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    ShaderProgram& assign = cache.getFromSources({{assign_source, GL_COMPUTE_SHADER}}, {{"MAX_CLUSTER_LIGHTS", std::to_string(settings.max_lights_per_cluster)}});
+    assign.use();
+    glUniform1ui(assign.getUniformLocation("clusterIndexCapacity"), (uint) index_capacity);
+    HEPTCORE_COUNT(uniform_uploads, 1);
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, counters.getID());
+    glDispatchComputeIndirect(0);
+    HEPTCORE_COUNT(dispatches, 1);
+
+    // Shading reads the lists from fragment shaders next
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
@@ -0,0 +1,44 @@
+#include <opengl/context_state.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/shaders.hpp>
+
+#include <utility>
+
+using namespace Heptcore;
+
+static thread_local ContextState* current_state = nullptr;
+
+static const std::shared_ptr<ShaderUniformLinker>& defaultLinker(){
+    static std::shared_ptr<ShaderUniformLinker> linker = std::make_shared<ShaderUniformLinker>();
+    return linker;
+}
+
+static const std::shared_ptr<SamplerCache>& defaultSamplerCache(){
+    static std::shared_ptr<SamplerCache> cache = std::make_shared<SamplerCache>();
+    return cache;
+}
+
+ContextState::ContextState(std::shared_ptr<ShaderUniformLinker> linker, std::shared_ptr<SamplerCache> samplers):
+    uniform_linker(linker ? std::move(linker) : defaultLinker()), sampler_cache(samplers ? std::move(samplers) : defaultSamplerCache()){}
+ContextState::~ContextState(){
+    if(current_state == this) current_state = nullptr;
+}
+
+void ContextState::invalidate(){
+    texture_bindings = {};
+    sampler_bindings = {};
+    framebuffer = ~0u; // Not a name, even binding the default framebuffer goes through
+    program = -1;
+}
+
+ContextState& ContextState::current(){
+    if(current_state) return *current_state;
+
+    // For threads that made a context current without Heptcore knowing
+    static thread_local ContextState fallback{};
+    return fallback;
+}
+
+ContextState* ContextState::setCurrent(ContextState* state){
+    return std::exchange(current_state, state);
+}
@@ -0,0 +1,163 @@
+#include <opengl/debug.hpp>
+
+#include <GLFW/glfw3.h>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+using namespace Heptcore;
+
+DebugOutput Heptcore::debugOutput = {};
+
+void Heptcore::checkGLError(const char *file, int line){
+    GLenum error;
+    while ((error = glGetError()) != GL_NO_ERROR) {
+        const char *errorString;
+        switch (error) {
+            case GL_INVALID_ENUM:                  errorString = "GL_INVALID_ENUM"; break;
+            case GL_INVALID_VALUE:                 errorString = "GL_INVALID_VALUE"; break;
+            case GL_INVALID_OPERATION:             errorString = "GL_INVALID_OPERATION"; break;
+            case GL_STACK_OVERFLOW:                errorString = "GL_STACK_OVERFLOW"; break;
+            case GL_STACK_UNDERFLOW:               errorString = "GL_STACK_UNDERFLOW"; break;
+            case GL_OUT_OF_MEMORY:                 errorString = "GL_OUT_OF_MEMORY"; break;
+            case GL_INVALID_FRAMEBUFFER_OPERATION: errorString = "GL_INVALID_FRAMEBUFFER_OPERATION"; break;
+            default:                               errorString = "Unknown error"; break;
+        }
+        std::cerr << "OpenGL error in file " << file << " at line " << line << " " << errorString << std::endl;
+        //throw std::runtime_error("Opengl error.");
+    }
+}
+
+static const char* sourceName(GLenum source){
+    switch(source){
+        case GL_DEBUG_SOURCE_API:             return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:     return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION:     return "application";
+        default:                              return "other";
+    }
+}
+
+static const char* typeName(GLenum type){
+    switch(type){
+        case GL_DEBUG_TYPE_ERROR:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+        case GL_DEBUG_TYPE_MARKER:              return "marker";
+        default:                                return "other";
+    }
+}
+
+static DebugSeverity toSeverity(GLenum severity){
+    switch(severity){
+        case GL_DEBUG_SEVERITY_HIGH:   return DEBUG_HIGH;
+        case GL_DEBUG_SEVERITY_MEDIUM: return DEBUG_MEDIUM;
+        case GL_DEBUG_SEVERITY_LOW:    return DEBUG_LOW;
+        default:                       return DEBUG_NOTIFICATION;
+    }
+}
+
+static const char* severityName(DebugSeverity severity){
+    switch(severity){
+        case DEBUG_HIGH:   return "high";
+        case DEBUG_MEDIUM: return "medium";
+        case DEBUG_LOW:    return "low";
+        default:           return "notification";
+    }
+}
+
+void APIENTRY DebugOutput::callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* user){
+    // The const is only in the signature, install passes a non const DebugOutput
+    static_cast<DebugOutput*>(const_cast<void*>(user))->receive(source, type, id, severity, message);
+}
+
+void DebugOutput::receive(GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* message){
+    // Our own debug groups come back as messages
+    if(type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP) return;
+
+    DebugSeverity level = toSeverity(severity);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(level < minimum_severity) return;
+    if(source >= GL_DEBUG_SOURCE_API && source <= GL_DEBUG_SOURCE_OTHER && !source_enabled[source - GL_DEBUG_SOURCE_API]) return;
+
+    // Some drivers use id 0 for everything, so the text is part of the key
+    uint64_t key = std::hash<std::string_view>{}(message);
+    key ^= ((uint64_t) source << 48) ^ ((uint64_t) type << 32) ^ id;
+
+    Message& entry = messages[key];
+    entry.severity = level;
+    entry.count++;
+
+    // A message from a draw inside a loop would otherwise flood the output every frame
+    if((entry.count & (entry.count - 1)) != 0) return;
+
+    std::cerr << "OpenGL " << typeName(type) << " (" << sourceName(source) << ", " << severityName(level) << ", id " << id << ")";
+    if(entry.count > 1) std::cerr << " repeated " << entry.count << " times";
+    std::cerr << ": " << message << std::endl;
+}
+
+bool DebugOutput::install(){
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if(!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) return false;
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if(synchronous) glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    glDebugMessageCallback(callback, this);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    applySeverityFilter();
+
+    return true;
+}
+
+void DebugOutput::applySeverityFilter(){
+    // Let the driver skip generating what would be filtered anyway
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    if(minimum_severity > DEBUG_NOTIFICATION) glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    if(minimum_severity > DEBUG_LOW) glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_LOW, 0, nullptr, GL_FALSE);
+    if(minimum_severity > DEBUG_MEDIUM) glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_MEDIUM, 0, nullptr, GL_FALSE);
+}
+
+void DebugOutput::setMinimumSeverity(DebugSeverity severity){
+    std::lock_guard<std::mutex> lock(mutex);
+    minimum_severity = severity;
+
+    // Only a context with this callback installed, without one the control calls would leak into someone elses filter
+    if(!glad_glGetPointerv || !glfwGetCurrentContext() || !glIsEnabled(GL_DEBUG_OUTPUT)) return;
+    void* user = nullptr;
+    glGetPointerv(GL_DEBUG_CALLBACK_USER_PARAM, &user);
+    if(user == this) applySeverityFilter();
+}
+
+void DebugOutput::setSourceEnabled(GLenum source, bool enabled){
+    if(source < GL_DEBUG_SOURCE_API || source > GL_DEBUG_SOURCE_OTHER) throw std::logic_error("Unknown debug message source.");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    source_enabled[source - GL_DEBUG_SOURCE_API] = enabled;
+}
+
+size_t DebugOutput::getUniqueMessages(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return messages.size();
+}
+
+uint64_t DebugOutput::getTotalMessages(){
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    for(auto& [key, message]: messages) total += message.count;
+    return total;
+}
+
+void DebugOutput::reset(){
+    std::lock_guard<std::mutex> lock(mutex);
+    messages.clear();
+}
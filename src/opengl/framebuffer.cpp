@@ -1,52 +1,272 @@
 #include <opengl/framebuffer.hpp>
 
+#include <algorithm>
+#include <utility>
+
 using namespace Heptcore;
 
-static uint currently_bound = 0;
-Framebuffer::Framebuffer(int width, int height, std::vector<FramebufferTexture> texture_definitions): width(width), height(height){
-    glGenFramebuffers(1, &framebuffer_id);
-    bind();
+static uint depthFormat(FramebufferDepth depth){
+    switch(depth){
+        case DEPTH_16:            return GL_DEPTH_COMPONENT16;
+        case DEPTH_24:            return GL_DEPTH_COMPONENT24;
+        case DEPTH_32F:           return GL_DEPTH_COMPONENT32F;
+        case DEPTH_24_STENCIL_8:  return GL_DEPTH24_STENCIL8;
+        case DEPTH_32F_STENCIL_8: return GL_DEPTH32F_STENCIL8;
+        default:                  return 0;
+    }
+}
 
-    glGenRenderbuffers(1, &depth_renderbuffer_id);
-    glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer_id);
+Framebuffer::Framebuffer(int width, int height, std::vector<FramebufferTexture> texture_definitions, FramebufferSettings settings): width(width), height(height), settings(settings){
+    HEPTCORE_RECORD_SUPPRESS();
 
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_renderbuffer_id);
+    if(this->settings.samples > 0){
+        GLint max_samples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+        if(this->settings.samples > max_samples){
+            std::cerr << "Framebuffer samples clamped from " << this->settings.samples << " to " << max_samples << std::endl;
+            this->settings.samples = max_samples;
+        }
+    }
 
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &framebuffer_id);
+    bind();
+
+    createDepth();
 
     size_t textures_total = texture_definitions.size();
     textures.resize(textures_total);
 
-    std::vector<uint> attachments(textures_total);
+    color_attachments.resize(textures_total);
     for(int i = 0; i < textures.size();i++){
         auto& definition = texture_definitions[i];
         auto& texture = textures[i];
 
         texture.configure(definition.internal_format, definition.format, definition.data_type, width, height);
 
-        attachments[i] = GL_COLOR_ATTACHMENT0 + i;
-        
-        glFramebufferTexture2D(GL_FRAMEBUFFER,  attachments[i] , GL_TEXTURE_2D, texture.getID(), 0);
+        color_attachments[i] = GL_COLOR_ATTACHMENT0 + i;
     }
 
-    glDrawBuffers(textures_total, attachments.data());
+    if(this->settings.samples > 0){
+        createMultisampleColor(texture_definitions);
+
+        // The textures live in their own framebuffer that is only ever blitted into
+        glCreateFramebuffers(1, &resolve_framebuffer_id);
+        for(size_t i = 0; i < textures.size();i++) glNamedFramebufferTexture(resolve_framebuffer_id, color_attachments[i], textures[i].getID(), 0);
+        glNamedFramebufferDrawBuffers(resolve_framebuffer_id, textures_total, color_attachments.data());
+
+        if(this->settings.depth_texture && this->settings.depth != DEPTH_NONE){
+            createDepthTexture();
+            glNamedFramebufferTexture(resolve_framebuffer_id, depthAttachment(), depth_texture->getID(), 0);
+        }
+
+        if(glCheckNamedFramebufferStatus(resolve_framebuffer_id, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            throw std::runtime_error("Failed to create resolve framebuffer!");
+    }
+    else{
+        for(size_t i = 0; i < textures.size();i++)
+            glFramebufferTexture2D(GL_FRAMEBUFFER, color_attachments[i], GL_TEXTURE_2D, textures[i].getID(), 0);
+    }
+
+    glDrawBuffers(textures_total, color_attachments.data());
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) 
         throw std::runtime_error("Failed to create framebuffer!");
 
     unbind();
 }
+
+uint Framebuffer::depthAttachment(){
+    if(settings.depth == DEPTH_24_STENCIL_8 || settings.depth == DEPTH_32F_STENCIL_8) return GL_DEPTH_STENCIL_ATTACHMENT;
+    return GL_DEPTH_ATTACHMENT;
+}
+
+void Framebuffer::createDepthTexture(){
+    depth_texture = std::make_unique<Texture2D>();
+    depth_texture->setup(width, height, 1, depthFormat(settings.depth));
+
+    glTextureParameteri(depth_texture->getID(), GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(depth_texture->getID(), GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(depth_texture->getID(), GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(depth_texture->getID(), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void Framebuffer::createDepth(){
+    if(settings.depth == DEPTH_NONE) return;
+
+    uint format = depthFormat(settings.depth);
+
+    // Multisampled depth stays a renderbuffer, the texture gets the resolved depth
+    if(settings.depth_texture && settings.samples == 0){
+        createDepthTexture();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, depthAttachment(), GL_TEXTURE_2D, depth_texture->getID(), 0);
+        return;
+    }
+
+    glGenRenderbuffers(1, &depth_renderbuffer_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer_id);
+
+    if(settings.samples > 0) glRenderbufferStorageMultisample(GL_RENDERBUFFER, settings.samples, format, width, height);
+    else glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
+
+    renderbuffer_memory += textureMemorySize(format, width, height) * std::max(settings.samples, 1);
+    memoryTracker.allocate(MEMORY_RENDERBUFFER, textureMemorySize(format, width, height) * std::max(settings.samples, 1));
+
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, depthAttachment(), GL_RENDERBUFFER, depth_renderbuffer_id);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+void Framebuffer::createMultisampleColor(const std::vector<FramebufferTexture>& texture_definitions){
+    multisample_color.resize(texture_definitions.size());
+
+    for(size_t i = 0; i < texture_definitions.size();i++){
+        uint format = texture_definitions[i].internal_format;
+        size_t bytes = textureMemorySize(format, width, height) * settings.samples;
+
+        if(settings.multisample_textures){
+            glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &multisample_color[i]);
+            glTextureStorage2DMultisample(multisample_color[i], settings.samples, format, width, height, GL_TRUE);
+            glNamedFramebufferTexture(framebuffer_id, color_attachments[i], multisample_color[i], 0);
+
+            multisample_texture_memory += bytes;
+            memoryTracker.allocate(MEMORY_TEXTURE, bytes);
+        }
+        else{
+            glCreateRenderbuffers(1, &multisample_color[i]);
+            glNamedRenderbufferStorageMultisample(multisample_color[i], settings.samples, format, width, height);
+            glNamedFramebufferRenderbuffer(framebuffer_id, color_attachments[i], GL_RENDERBUFFER, multisample_color[i]);
+
+            renderbuffer_memory += bytes;
+            memoryTracker.allocate(MEMORY_RENDERBUFFER, bytes);
+        }
+    }
+}
+
+Framebuffer::~Framebuffer(){
+    if(!framebuffer_id) return; // Moved from
+
+    if(ContextState::current().framebuffer == framebuffer_id) unbind();
+
+    if(settings.multisample_textures) glDeleteTextures(multisample_color.size(), multisample_color.data());
+    else glDeleteRenderbuffers(multisample_color.size(), multisample_color.data());
+
+    if(depth_renderbuffer_id) glDeleteRenderbuffers(1, &depth_renderbuffer_id);
+    if(resolve_framebuffer_id) glDeleteFramebuffers(1, &resolve_framebuffer_id);
+    glDeleteFramebuffers(1, &framebuffer_id);
+
+    memoryTracker.free(MEMORY_RENDERBUFFER, renderbuffer_memory);
+    memoryTracker.free(MEMORY_TEXTURE, multisample_texture_memory);
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept:
+    width(other.width), height(other.height),
+    textures(std::move(other.textures)),
+    settings(other.settings),
+    framebuffer_id(std::exchange(other.framebuffer_id, 0)),
+    depth_renderbuffer_id(std::exchange(other.depth_renderbuffer_id, 0)),
+    depth_texture(std::move(other.depth_texture)),
+    resolve_framebuffer_id(std::exchange(other.resolve_framebuffer_id, 0)),
+    multisample_color(std::move(other.multisample_color)),
+    color_attachments(std::move(other.color_attachments)),
+    renderbuffer_memory(std::exchange(other.renderbuffer_memory, 0)),
+    multisample_texture_memory(std::exchange(other.multisample_texture_memory, 0)){}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept{
+    // Swapping leaves our old objects to the destructor of other
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    std::swap(textures, other.textures);
+    std::swap(settings, other.settings);
+    std::swap(framebuffer_id, other.framebuffer_id);
+    std::swap(depth_renderbuffer_id, other.depth_renderbuffer_id);
+    std::swap(depth_texture, other.depth_texture);
+    std::swap(resolve_framebuffer_id, other.resolve_framebuffer_id);
+    std::swap(multisample_color, other.multisample_color);
+    std::swap(color_attachments, other.color_attachments);
+    std::swap(renderbuffer_memory, other.renderbuffer_memory);
+    std::swap(multisample_texture_memory, other.multisample_texture_memory);
+    return *this;
+}
+
+void Framebuffer::resolve(bool invalidate){
+    HEPTCORE_RECORD(resolveFramebuffer(*this, invalidate));
+    HEPTCORE_RECORD_SUPPRESS();
+
+    if(settings.samples == 0){
+        if(invalidate && !depth_texture) invalidateDepth(); // A depth texture is there to be read
+        return;
+    }
+
+    HEPTCORE_DEBUG_GROUP("Framebuffer::resolve");
+
+    // Blits are clipped by the scissor test
+    GLboolean scissor_enabled = glIsEnabled(GL_SCISSOR_TEST);
+    if(scissor_enabled) glDisable(GL_SCISSOR_TEST);
+
+    // One blit per attachment, a blit only reads from a single read buffer
+    for(size_t i = 0; i < color_attachments.size();i++){
+        glNamedFramebufferReadBuffer(framebuffer_id, color_attachments[i]);
+        glNamedFramebufferDrawBuffer(resolve_framebuffer_id, color_attachments[i]);
+        glBlitNamedFramebuffer(framebuffer_id, resolve_framebuffer_id, 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glNamedFramebufferReadBuffer(framebuffer_id, color_attachments.empty() ? GL_NONE : color_attachments[0]);
+    glNamedFramebufferDrawBuffers(resolve_framebuffer_id, color_attachments.size(), color_attachments.data());
+
+    // Depth cant be averaged, a nearest blit takes one of the samples
+    if(depth_texture){
+        GLbitfield mask = GL_DEPTH_BUFFER_BIT;
+        if(depthAttachment() == GL_DEPTH_STENCIL_ATTACHMENT) mask |= GL_STENCIL_BUFFER_BIT;
+        glBlitNamedFramebuffer(framebuffer_id, resolve_framebuffer_id, 0, 0, width, height, 0, 0, width, height, mask, GL_NEAREST);
+    }
+
+    if(scissor_enabled) glEnable(GL_SCISSOR_TEST);
+
+    if(!invalidate) return;
+
+    // Everything multisampled is now dead, dont let the driver store it back to memory
+    std::vector<uint> invalidated = color_attachments;
+    if(settings.depth != DEPTH_NONE) invalidated.push_back(depthAttachment());
+    glInvalidateNamedFramebufferData(framebuffer_id, invalidated.size(), invalidated.data());
+}
+
+void Framebuffer::invalidateDepth(){
+    if(settings.depth == DEPTH_NONE) return;
+    HEPTCORE_RECORD(invalidateDepth(*this));
+
+    uint attachment = depthAttachment();
+    glInvalidateNamedFramebufferData(framebuffer_id, 1, &attachment);
+}
+
+uint Framebuffer::getMultisampleTexture(size_t index){
+    if(!settings.multisample_textures || index >= multisample_color.size()) return 0;
+    return multisample_color[index];
+}
+
 void Framebuffer::bind(){
-    if(currently_bound == framebuffer_id) return;
+    HEPTCORE_RECORD(bindFramebuffer(this));
+    uint& currently_bound = ContextState::current().framebuffer;
+    if(currently_bound == framebuffer_id){
+        HEPTCORE_COUNT(redundant_binds_skipped, 1);
+        return;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    HEPTCORE_COUNT(framebuffer_binds, 1);
     currently_bound = framebuffer_id;
 }
-void Framebuffer::unbind(){
-    if(currently_bound == 0) return;
+void Framebuffer::bindDefault(){
+    HEPTCORE_RECORD(bindFramebuffer(nullptr));
+    uint& currently_bound = ContextState::current().framebuffer;
+    if(currently_bound == 0){
+        HEPTCORE_COUNT(redundant_binds_skipped, 1);
+        return;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    HEPTCORE_COUNT(framebuffer_binds, 1);
     currently_bound = 0;
 }
+void Framebuffer::unbind(){
+    bindDefault();
+}
 
 void Framebuffer::bindTextures(){
     for(int i = 0;i < textures.size();i++) textures[i].bind(i);
@@ -0,0 +1,484 @@
+#include <opengl/image_kernels.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Heptcore;
+
+static const char* downsample_source = R"(
+#version 450 core
+layout(local_size_x = 256) in;
+
+layout(binding = 0) uniform sampler2D downsampleSource;
+layout(binding = 0, IMAGE_FORMAT) uniform coherent image2D downsampleLevels[8];
+layout(std430, binding = 0) coherent buffer DownsampleCounter{
+    uint finished;
+};
+
+uniform int downsampleBaseLevel;
+uniform int downsampleLevelCount; // Levels written, the first is downsampleBaseLevel + 1
+uniform uint downsampleGroups;
+
+shared vec4 tile[16][16];
+shared bool last_group;
+
+vec4 reduce(vec4 a, vec4 b, vec4 c, vec4 d){
+#if DOWNSAMPLE_MODE == 1
+    return min(min(a, b), min(c, d));
+#elif DOWNSAMPLE_MODE == 2
+    return max(max(a, b), max(c, d));
+#else
+    return (a + b + c + d) * 0.25;
+#endif
+}
+
+// level counts from the base, 1 is the first level written
+void store(int level, ivec2 position, vec4 value){
+    if(level > downsampleLevelCount) return;
+    imageStore(downsampleLevels[level - 1], position, value);
+}
+
+// Reads clamp to the edge, so odd sizes repeat their last row or column
+vec4 load(ivec2 position, bool from_image){
+    if(from_image){
+        ivec2 size = imageSize(downsampleLevels[5]);
+        return imageLoad(downsampleLevels[5], clamp(position, ivec2(0), size - 1));
+    }
+    ivec2 size = textureSize(downsampleSource, downsampleBaseLevel);
+    return texelFetch(downsampleSource, clamp(position, ivec2(0), size - 1), downsampleBaseLevel);
+}
+
+vec4 reduceQuad(ivec2 source, ivec2 target, int level, bool from_image){
+    vec4 value = reduce(load(source, from_image), load(source + ivec2(1, 0), from_image), load(source + ivec2(0, 1), from_image), load(source + ivec2(1, 1), from_image));
+    store(level, target, value);
+    return value;
+}
+
+// A 4x4 block into 2x2 texels of level and one of level + 1
+vec4 reduceBlock(ivec2 source, ivec2 target, int level, bool from_image){
+    vec4 value = reduce(
+        reduceQuad(source, target, level, from_image),
+        reduceQuad(source + ivec2(2, 0), target + ivec2(1, 0), level, from_image),
+        reduceQuad(source + ivec2(0, 2), target + ivec2(0, 1), level, from_image),
+        reduceQuad(source + ivec2(2, 2), target + ivec2(1, 1), level, from_image)
+    );
+    store(level + 1, target / 2, value);
+    return value;
+}
+
+// The tile holds size * 2 texels per side of the level above
+void reduceTile(ivec2 thread, ivec2 group, int level, int size){
+    bool inside = all(lessThan(thread, ivec2(size)));
+    vec4 value = vec4(0.0);
+    if(inside){
+        ivec2 source = thread * 2;
+        value = reduce(tile[source.y][source.x], tile[source.y][source.x + 1], tile[source.y + 1][source.x], tile[source.y + 1][source.x + 1]);
+    }
+    barrier();
+
+    if(inside){
+        tile[thread.y][thread.x] = value;
+        store(level, group * size + thread, value);
+    }
+    barrier();
+}
+
+void main(){
+    uint index = gl_LocalInvocationIndex;
+    ivec2 thread = ivec2(index % 16u, index / 16u);
+    ivec2 group = ivec2(gl_WorkGroupID.xy);
+
+    // 64x64 texels of the base per workgroup, levels 1 and 2 straight from registers
+    tile[thread.y][thread.x] = reduceBlock(group * 64 + thread * 4, group * 32 + thread * 2, 1, false);
+    barrier();
+
+    reduceTile(thread, group, 3, 8);
+    reduceTile(thread, group, 4, 4);
+    reduceTile(thread, group, 5, 2);
+    reduceTile(thread, group, 6, 1);
+
+    if(downsampleLevelCount <= 6) return;
+
+    // Only the last workgroup to get here sees all of level 6 and can keep going
+    memoryBarrierImage();
+    barrier();
+    if(index == 0u) last_group = atomicAdd(finished, 1u) == downsampleGroups - 1u;
+    barrier();
+    if(!last_group) return;
+
+    if(index == 0u) finished = 0u; // Ready for the next dispatch
+
+    // Level 6 is at most 64x64 here (checked before dispatching)
+    reduceBlock(thread * 4, thread * 2, 7, true);
+}
+)";
+
+static const char* blur_source = R"(
+#version 450 core
+#define TILE_SIZE 256
+layout(local_size_x = TILE_SIZE) in;
+
+layout(binding = 0) uniform sampler2D blurSource;
+layout(binding = 0, IMAGE_FORMAT) uniform writeonly image2D blurDestination;
+
+uniform int blurSourceLevel;
+uniform int blurRadius;
+uniform float blurSigma;
+
+shared vec4 row[TILE_SIZE + 2 * MAX_RADIUS];
+shared float weights[MAX_RADIUS + 1];
+
+ivec2 texel(int along, int across){
+#ifdef BLUR_VERTICAL
+    return ivec2(across, along);
+#else
+    return ivec2(along, across);
+#endif
+}
+
+void main(){
+    ivec2 size = textureSize(blurSource, blurSourceLevel);
+#ifdef BLUR_VERTICAL
+    int extent = size.y;
+#else
+    int extent = size.x;
+#endif
+
+    int local = int(gl_LocalInvocationID.x);
+    int start = int(gl_WorkGroupID.x) * TILE_SIZE;
+    int across = int(gl_WorkGroupID.y);
+
+    // The tile and the radius on both sides, every texel is fetched once per workgroup
+    for(int i = local; i < TILE_SIZE + 2 * blurRadius; i += TILE_SIZE){
+        int along = clamp(start + i - blurRadius, 0, extent - 1);
+        row[i] = texelFetch(blurSource, texel(along, across), blurSourceLevel);
+    }
+    if(local <= blurRadius) weights[local] = exp(-float(local * local) / (2.0 * blurSigma * blurSigma));
+    barrier();
+
+    int along = start + local;
+    if(along >= extent) return;
+
+    int center = local + blurRadius;
+    vec4 sum = row[center] * weights[0];
+    float total = weights[0];
+    for(int i = 1; i <= blurRadius; i++){
+        sum += (row[center - i] + row[center + i]) * weights[i];
+        total += 2.0 * weights[i];
+    }
+
+    imageStore(blurDestination, texel(along, across), sum / total);
+}
+)";
+
+static const char* bloom_prefilter_source = R"(
+#version 450 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D bloomInput;
+layout(binding = 0, rgba16f) uniform writeonly image2D bloomTarget;
+
+uniform float bloomThreshold;
+uniform float bloomKnee;
+
+void main(){
+    ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(bloomTarget);
+    if(any(greaterThanEqual(position, size))) return;
+
+    // One bilinear tap between 4 input texels averages them
+    vec2 uv = (vec2(position) + 0.5) / vec2(size);
+    vec3 color = textureLod(bloomInput, uv, 0.0).rgb;
+
+    // Quadratic soft threshold
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - bloomThreshold + bloomKnee, 0.0, 2.0 * bloomKnee);
+    soft = soft * soft / (4.0 * bloomKnee + 0.00001);
+    float contribution = max(soft, brightness - bloomThreshold) / max(brightness, 0.00001);
+
+    imageStore(bloomTarget, position, vec4(color * contribution, 1.0));
+}
+)";
+
+static const char* bloom_upsample_source = R"(
+#version 450 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D bloomPyramid;
+layout(binding = 0, rgba16f) uniform image2D bloomTarget;
+
+uniform int bloomLevel; // Written, bloomLevel + 1 is sampled
+uniform float bloomRadius;
+
+void main(){
+    ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(bloomTarget);
+    if(any(greaterThanEqual(position, size))) return;
+
+    vec2 uv = (vec2(position) + 0.5) / vec2(size);
+    vec2 offset = bloomRadius / vec2(textureSize(bloomPyramid, bloomLevel + 1));
+    float lod = float(bloomLevel + 1);
+
+    // 3x3 tent
+    vec3 sum = textureLod(bloomPyramid, uv, lod).rgb * 4.0;
+    sum += textureLod(bloomPyramid, uv + vec2(-offset.x, 0.0), lod).rgb * 2.0;
+    sum += textureLod(bloomPyramid, uv + vec2( offset.x, 0.0), lod).rgb * 2.0;
+    sum += textureLod(bloomPyramid, uv + vec2(0.0, -offset.y), lod).rgb * 2.0;
+    sum += textureLod(bloomPyramid, uv + vec2(0.0,  offset.y), lod).rgb * 2.0;
+    sum += textureLod(bloomPyramid, uv + vec2(-offset.x, -offset.y), lod).rgb;
+    sum += textureLod(bloomPyramid, uv + vec2( offset.x, -offset.y), lod).rgb;
+    sum += textureLod(bloomPyramid, uv + vec2(-offset.x,  offset.y), lod).rgb;
+    sum += textureLod(bloomPyramid, uv + vec2( offset.x,  offset.y), lod).rgb;
+
+    imageStore(bloomTarget, position, imageLoad(bloomTarget, position) + vec4(sum / 16.0, 0.0));
+}
+)";
+
+/*
+    Makes image writes visible to whatever comes next, another kernel, sampling or rendering
+*/
+static void imageBarrier(){
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+}
+
+static uint groupCount(int size, int group_size){
+    return (uint) ((size + group_size - 1) / group_size);
+}
+
+ImageLevel Heptcore::queryImageLevel(const BindableTexture& texture, int level){
+    ImageLevel result = {};
+    glGetTextureLevelParameteriv(texture.getID(), level, GL_TEXTURE_WIDTH, &result.width);
+    glGetTextureLevelParameteriv(texture.getID(), level, GL_TEXTURE_HEIGHT, &result.height);
+    glGetTextureLevelParameteriv(texture.getID(), level, GL_TEXTURE_INTERNAL_FORMAT, &result.internal_format);
+    glGetTextureParameteriv(texture.getID(), GL_TEXTURE_IMMUTABLE_LEVELS, &result.levels);
+    return result;
+}
+
+std::string Heptcore::imageFormatQualifier(int internal_format){
+    switch(internal_format){
+        case GL_RGBA8: return "rgba8";
+        case GL_RGBA16F: return "rgba16f";
+        case GL_RGBA32F: return "rgba32f";
+        case GL_RG8: return "rg8";
+        case GL_RG16F: return "rg16f";
+        case GL_RG32F: return "rg32f";
+        case GL_R8: return "r8";
+        case GL_R16F: return "r16f";
+        case GL_R32F: return "r32f";
+        case GL_R11F_G11F_B10F: return "r11f_g11f_b10f";
+    }
+    throw std::logic_error("Texture format " + std::to_string(internal_format) + " cant be used as an image.");
+}
+
+Downsampler::Downsampler(ShaderVariantCache& cache): cache(cache){
+    uint zero = 0;
+    counter.initialize(1, &zero);
+    counter.label("Downsampler counter");
+
+    uniformLinker().ignore("downsampleSource");
+    uniformLinker().ignore("downsampleLevels");
+    uniformLinker().ignore("downsampleBaseLevel");
+    uniformLinker().ignore("downsampleLevelCount");
+    uniformLinker().ignore("downsampleGroups");
+}
+
+void Downsampler::generate(Texture2D& texture, DownsampleMode mode, int first_level){
+    ImageLevel base = queryImageLevel(texture, first_level);
+    if(base.levels == 0) throw std::logic_error("Downsampler needs immutable storage, create the texture with Texture2D::setup.");
+
+    auto power_of_two = [](int size){ return size > 0 && (size & (size - 1)) == 0; };
+    if(mode != DOWNSAMPLE_AVERAGE && (!power_of_two(base.width) || !power_of_two(base.height)))
+        throw std::logic_error("Min and max downsampling only stay conservative for power of two sizes, got " +
+            std::to_string(base.width) + "x" + std::to_string(base.height) + ".");
+
+    ShaderProgram& program = cache.getFromSources({{downsample_source, GL_COMPUTE_SHADER}}, {
+        {"IMAGE_FORMAT", imageFormatQualifier(base.internal_format)},
+        {"DOWNSAMPLE_MODE", std::to_string((int) mode)}
+    });
+
+    HEPTCORE_DEBUG_GROUP("Downsampler::generate");
+
+    program.use();
+    int base_level_location = program.getUniformLocation("downsampleBaseLevel");
+    int level_count_location = program.getUniformLocation("downsampleLevelCount");
+    int groups_location = program.getUniformLocation("downsampleGroups");
+
+    texture.bind(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, counter.getID());
+
+    int level = first_level;
+    int width = base.width;
+    int height = base.height;
+    while(level + 1 < base.levels){
+        // The last workgroup only handles levels 7 and 8 when level 6 fits into its 64x64 tile
+        bool continues = std::max(width >> 6, 1) <= 64 && std::max(height >> 6, 1) <= 64;
+        int count = std::min(base.levels - 1 - level, continues ? levels_per_dispatch : 6);
+
+        for(int i = 0; i < count; i++) glBindImageTexture(i, texture.getID(), level + 1 + i, GL_FALSE, 0, GL_READ_WRITE, base.internal_format);
+
+        uint groups_x = groupCount(width, 64);
+        uint groups_y = groupCount(height, 64);
+
+        glUniform1i(base_level_location, level);
+        glUniform1i(level_count_location, count);
+        glUniform1ui(groups_location, groups_x * groups_y);
+        HEPTCORE_COUNT(uniform_uploads, 3);
+
+        glDispatchCompute(groups_x, groups_y, 1);
+        HEPTCORE_COUNT(dispatches, 1);
+
+        imageBarrier();
+
+        level += count;
+        width = std::max(width >> count, 1);
+        height = std::max(height >> count, 1);
+    }
+}
+
+GaussianBlur::GaussianBlur(ShaderVariantCache& cache): cache(cache){
+    uniformLinker().ignore("blurSource");
+    uniformLinker().ignore("blurDestination");
+    uniformLinker().ignore("blurSourceLevel");
+    uniformLinker().ignore("blurRadius");
+    uniformLinker().ignore("blurSigma");
+}
+
+void GaussianBlur::ensureTemporary(const ImageLevel& level){
+    if(temporary && temporary_level.width == level.width && temporary_level.height == level.height && temporary_level.internal_format == level.internal_format) return;
+
+    temporary = std::make_unique<Texture2D>();
+    temporary->setup(level.width, level.height, 1, level.internal_format);
+    temporary->label("GaussianBlur temporary");
+    temporary_level = level;
+}
+
+void GaussianBlur::apply(Texture2D& texture, float sigma, int level){
+    ImageLevel image = queryImageLevel(texture, level);
+    int radius = std::clamp((int) std::ceil(sigma * 3.0f), 1, max_radius);
+    std::string format = imageFormatQualifier(image.internal_format);
+
+    ensureTemporary(image);
+
+    HEPTCORE_DEBUG_GROUP("GaussianBlur::apply");
+
+    // Horizontal into the temporary, vertical back into the level
+    for(int pass = 0; pass < 2; pass++){
+        bool vertical = pass == 1;
+
+        ShaderDefines defines = {{"IMAGE_FORMAT", format}, {"MAX_RADIUS", std::to_string(max_radius)}};
+        if(vertical) defines["BLUR_VERTICAL"] = "";
+        ShaderProgram& program = cache.getFromSources({{blur_source, GL_COMPUTE_SHADER}}, defines);
+
+        program.use();
+        glUniform1i(program.getUniformLocation("blurSourceLevel"), vertical ? 0 : level);
+        glUniform1i(program.getUniformLocation("blurRadius"), radius);
+        glUniform1f(program.getUniformLocation("blurSigma"), sigma);
+        HEPTCORE_COUNT(uniform_uploads, 3);
+
+        if(vertical){
+            temporary->bind(0);
+            glBindImageTexture(0, texture.getID(), level, GL_FALSE, 0, GL_WRITE_ONLY, image.internal_format);
+        }
+        else{
+            texture.bind(0);
+            glBindImageTexture(0, temporary->getID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, image.internal_format);
+        }
+
+        // One workgroup per 256 texels of a row (or column)
+        if(vertical) glDispatchCompute(groupCount(image.height, 256), image.width, 1);
+        else glDispatchCompute(groupCount(image.width, 256), image.height, 1);
+        HEPTCORE_COUNT(dispatches, 1);
+
+        imageBarrier();
+    }
+}
+
+BloomPyramid::BloomPyramid(ShaderVariantCache& cache, int max_levels): cache(cache), downsampler(cache), max_levels(max_levels){
+    uniformLinker().ignore("bloomInput");
+    uniformLinker().ignore("bloomPyramid");
+    uniformLinker().ignore("bloomTarget");
+    uniformLinker().ignore("bloomThreshold");
+    uniformLinker().ignore("bloomKnee");
+    uniformLinker().ignore("bloomLevel");
+    uniformLinker().ignore("bloomRadius");
+}
+
+void BloomPyramid::ensurePyramid(int width, int height){
+    width = std::max(width / 2, 1);
+    height = std::max(height / 2, 1);
+    if(pyramid && pyramid_width == width && pyramid_height == height) return;
+
+    int levels = std::min(max_levels, (int) std::floor(std::log2(std::max(width, height))) + 1);
+
+    pyramid = std::make_unique<Texture2D>();
+    pyramid->setup(width, height, levels, GL_RGBA16F);
+    pyramid->label("BloomPyramid");
+
+    // Level 0 is what gets composited, sampled like any other texture
+    glTextureParameteri(pyramid->getID(), GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(pyramid->getID(), GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(pyramid->getID(), GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(pyramid->getID(), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    pyramid_width = width;
+    pyramid_height = height;
+    pyramid_levels = levels;
+}
+
+void BloomPyramid::render(BindableTexture& input, int width, int height){
+    ensurePyramid(width, height);
+
+    HEPTCORE_DEBUG_GROUP("BloomPyramid::render");
+
+    ShaderProgram& prefilter = cache.getFromSources({{bloom_prefilter_source, GL_COMPUTE_SHADER}});
+    prefilter.use();
+    glUniform1f(prefilter.getUniformLocation("bloomThreshold"), threshold);
+    glUniform1f(prefilter.getUniformLocation("bloomKnee"), std::max(knee, 0.0f));
+    HEPTCORE_COUNT(uniform_uploads, 2);
+
+    input.bind(0, samplerCache().get(SamplerDescription::linear(GL_CLAMP_TO_EDGE)));
+    glBindImageTexture(0, pyramid->getID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    glDispatchCompute(groupCount(pyramid_width, 8), groupCount(pyramid_height, 8), 1);
+    HEPTCORE_COUNT(dispatches, 1);
+    imageBarrier();
+
+    downsampler.generate(*pyramid, DOWNSAMPLE_AVERAGE);
+
+    // Explicit levels through textureLod, the pyramid itself only filters level 0
+    SamplerDescription description = SamplerDescription::linear(GL_CLAMP_TO_EDGE);
+    description.min_filter = GL_LINEAR_MIPMAP_NEAREST;
+
+    ShaderProgram& upsample = cache.getFromSources({{bloom_upsample_source, GL_COMPUTE_SHADER}});
+    upsample.use();
+    int level_location = upsample.getUniformLocation("bloomLevel");
+    glUniform1f(upsample.getUniformLocation("bloomRadius"), radius);
+    HEPTCORE_COUNT(uniform_uploads, 1);
+
+    pyramid->bind(0, samplerCache().get(description));
+
+    for(int level = pyramid_levels - 2; level >= 0; level--){
+        glUniform1i(level_location, level);
+        HEPTCORE_COUNT(uniform_uploads, 1);
+        glBindImageTexture(0, pyramid->getID(), level, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+
+        glDispatchCompute(groupCount(std::max(pyramid_width >> level, 1), 8), groupCount(std::max(pyramid_height >> level, 1), 8), 1);
+        HEPTCORE_COUNT(dispatches, 1);
+        imageBarrier();
+    }
+}
+
+Texture2D& BloomPyramid::getTexture(){
+    if(!pyramid) throw std::logic_error("BloomPyramid::getTexture before the first render.");
+    return *pyramid;
+}
+
+PostEffect BloomPyramid::effect(float intensity){
+    PostEffect effect = {"bloom", R"(
+vec4 apply(vec4 color, vec2 uv){
+    return vec4(color.rgb + texture(heptcoreBloom, uv).rgb * )" + std::to_string(intensity) + R"(, color.a);
+}
+)"};
+    effect.textures = {"heptcoreBloom"};
+    return effect;
+}
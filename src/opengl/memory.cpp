@@ -0,0 +1,135 @@
+#include <opengl/memory.hpp>
+
+#include <algorithm>
+
+using namespace Heptcore;
+
+// Not in the core profile loader
+#define HEPTCORE_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define HEPTCORE_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#define HEPTCORE_TEXTURE_FREE_MEMORY_ATI 0x87FC
+
+GpuMemoryTracker Heptcore::memoryTracker = GpuMemoryTracker();
+
+void GpuMemoryTracker::allocate(MemoryCategory category, size_t bytes){
+    size_t current = usage[category].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    allocations[category].fetch_add(1, std::memory_order_relaxed);
+
+    size_t highest = peak[category].load(std::memory_order_relaxed);
+    while(current > highest && !peak[category].compare_exchange_weak(highest, current, std::memory_order_relaxed));
+}
+
+void GpuMemoryTracker::free(MemoryCategory category, size_t bytes){
+    usage[category].fetch_sub(bytes, std::memory_order_relaxed);
+    allocations[category].fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t GpuMemoryTracker::getTotalUsage() const{
+    size_t total = 0;
+    for(auto& category: usage) total += category.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool Heptcore::isExtensionSupported(const std::string& name){
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for(GLint i = 0; i < count; i++){
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if(extension && name == extension) return true;
+    }
+    return false;
+}
+
+size_t GpuMemoryTracker::queryAvailableMemory(){
+    static const bool nvx = isExtensionSupported("GL_NVX_gpu_memory_info");
+    static const bool ati = isExtensionSupported("GL_ATI_meminfo");
+
+    if(nvx){
+        GLint kilobytes = 0;
+        glGetIntegerv(HEPTCORE_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &kilobytes);
+        return (size_t) kilobytes * 1024;
+    }
+    if(ati){
+        GLint values[4] = {0, 0, 0, 0}; // Total free, largest free block, total auxiliary free, largest auxiliary free
+        glGetIntegerv(HEPTCORE_TEXTURE_FREE_MEMORY_ATI, values);
+        return (size_t) values[0] * 1024;
+    }
+    return 0;
+}
+
+size_t GpuMemoryTracker::queryTotalMemory(){
+    static const bool nvx = isExtensionSupported("GL_NVX_gpu_memory_info");
+    if(!nvx) return 0;
+
+    GLint kilobytes = 0;
+    glGetIntegerv(HEPTCORE_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &kilobytes);
+    return (size_t) kilobytes * 1024;
+}
+
+const char* GpuMemoryTracker::getCategoryName(MemoryCategory category){
+    switch(category){
+        case MEMORY_BUFFER:       return "buffer";
+        case MEMORY_TEXTURE:      return "texture";
+        case MEMORY_RENDERBUFFER: return "renderbuffer";
+        default:                  return "unknown";
+    }
+}
+
+size_t Heptcore::internalFormatSize(uint internal_format){
+    switch(internal_format){
+        case GL_R8:
+        case GL_RED:
+        case GL_STENCIL_INDEX8:
+            return 1;
+        case GL_RG8:
+        case GL_RG:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGBA8:
+        case GL_RGBA:
+        case GL_SRGB8_ALPHA8:
+        case GL_RGB10_A2:
+        case GL_R11F_G11F_B10F:
+        case GL_RG16F:
+        case GL_R32F:
+        case GL_R32I:
+        case GL_R32UI:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH_COMPONENT:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH_STENCIL:
+        // Three component formats are padded to four by pretty much every driver
+        case GL_RGB8:
+        case GL_RGB:
+        case GL_SRGB8:
+            return 4;
+        case GL_RGBA16F:
+        case GL_RGB16F:
+        case GL_RG32F:
+        case GL_DEPTH32F_STENCIL8:
+            return 8;
+        case GL_RGBA32F:
+        case GL_RGB32F:
+        case GL_RGBA32I:
+        case GL_RGBA32UI:
+            return 16;
+        default:
+            return 4;
+    }
+}
+
+size_t Heptcore::textureMemorySize(uint internal_format, int width, int height, int levels){
+    size_t texel_size = internalFormatSize(internal_format);
+    size_t total = 0;
+
+    for(int level = 0; level < levels; level++){
+        total += (size_t) width * height * texel_size;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    return total;
+}
@@ -0,0 +1,318 @@
+#include <opengl/post_process.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+
+using namespace Heptcore;
+
+static const char* post_vertex_source = R"(
+#version 450 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+out vec2 TexCoord;
+void main(){
+    gl_Position = vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+}
+)";
+
+PostEffect PostEffect::toneMapACES(){
+    // Narkowicz fit of the ACES filmic curve
+    return {"tonemap_aces", R"(
+vec4 apply(vec4 color, vec2 uv){
+    vec3 x = max(color.rgb, vec3(0.0));
+    x = clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+    return vec4(x, color.a);
+}
+)"};
+}
+
+PostEffect PostEffect::gamma(float gamma){
+    return {"gamma", R"(
+vec4 apply(vec4 color, vec2 uv){
+    return vec4(pow(max(color.rgb, vec3(0.0)), vec3()" + std::to_string(1.0f / gamma) + R"()), color.a);
+}
+)"};
+}
+
+PostEffect PostEffect::vignette(float strength){
+    return {"vignette", R"(
+vec4 apply(vec4 color, vec2 uv){
+    float falloff = smoothstep(0.3, 0.75, distance(uv, vec2(0.5)));
+    return vec4(color.rgb * (1.0 - )" + std::to_string(strength) + R"( * falloff), color.a);
+}
+)"};
+}
+
+PostEffect PostEffect::fxaa(){
+    // The small FXAA variant, one pass over 5 taps
+    PostEffect effect = {"fxaa", R"(
+float post_fxaa_luma(vec3 color){
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+vec4 apply(sampler2D source, vec2 uv){
+    vec3 north_west = texture(source, uv + vec2(-1.0, -1.0) * postTexelSize).rgb;
+    vec3 north_east = texture(source, uv + vec2( 1.0, -1.0) * postTexelSize).rgb;
+    vec3 south_west = texture(source, uv + vec2(-1.0,  1.0) * postTexelSize).rgb;
+    vec3 south_east = texture(source, uv + vec2( 1.0,  1.0) * postTexelSize).rgb;
+    vec4 middle = texture(source, uv);
+
+    float luma_nw = post_fxaa_luma(north_west);
+    float luma_ne = post_fxaa_luma(north_east);
+    float luma_sw = post_fxaa_luma(south_west);
+    float luma_se = post_fxaa_luma(south_east);
+    float luma_m = post_fxaa_luma(middle.rgb);
+
+    float luma_min = min(luma_m, min(min(luma_nw, luma_ne), min(luma_sw, luma_se)));
+    float luma_max = max(luma_m, max(max(luma_nw, luma_ne), max(luma_sw, luma_se)));
+
+    vec2 direction = vec2(-((luma_nw + luma_ne) - (luma_sw + luma_se)), (luma_nw + luma_sw) - (luma_ne + luma_se));
+    float reduce = max((luma_nw + luma_ne + luma_sw + luma_se) * 0.25 * (1.0 / 8.0), 1.0 / 128.0);
+    float scale = 1.0 / (min(abs(direction.x), abs(direction.y)) + reduce);
+    direction = clamp(direction * scale, vec2(-8.0), vec2(8.0)) * postTexelSize;
+
+    vec3 near = 0.5 * (texture(source, uv + direction * (1.0 / 3.0 - 0.5)).rgb + texture(source, uv + direction * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 far = near * 0.5 + 0.25 * (texture(source, uv - direction * 0.5).rgb + texture(source, uv + direction * 0.5).rgb);
+
+    float luma_far = post_fxaa_luma(far);
+    return vec4((luma_far < luma_min || luma_far > luma_max) ? near : far, middle.a);
+}
+)"};
+    effect.neighborhood = true;
+    return effect;
+}
+
+/*
+    Splits a single "uniform type name;" line (optionally with an initializer or array size) into its
+    name and a normalized declaration. Blocks and lists like "uniform float a, b;" arent matched
+*/
+static bool parseUniform(const std::string& line, std::string& name, std::string& declaration){
+    // No spaces around punctuation, single spaces elsewhere, so formatting doesnt make two declarations differ
+    auto punctuation = [](char c){ return c == '=' || c == '[' || c == ']' || c == ';'; };
+    declaration.clear();
+    bool space = false;
+    for(char c: line){
+        if(std::isspace((unsigned char) c)){
+            space = !declaration.empty();
+            continue;
+        }
+        if(space && !punctuation(c) && !punctuation(declaration.back())) declaration += ' ';
+        declaration += c;
+        space = false;
+    }
+
+    if(!declaration.starts_with("uniform ") || !declaration.ends_with(";")) return false;
+    if(declaration.find_first_of(",{") != std::string::npos) return false;
+
+    size_t end = declaration.find_first_of("=[;");
+    size_t start = end;
+    while(start > 0 && (std::isalnum((unsigned char) declaration[start - 1]) || declaration[start - 1] == '_')) start--;
+    if(start == end || start <= 8) return false; // No type before the name
+
+    name = declaration.substr(start, end - start);
+    return true;
+}
+
+PostProcessChain::PostProcessChain(ShaderVariantCache& cache, uint intermediate_format): cache(cache), intermediate_format(intermediate_format){}
+
+size_t PostProcessChain::add(const PostEffect& effect){
+    effects.push_back(effect);
+    dirty = true;
+    return effects.size() - 1;
+}
+
+void PostProcessChain::setEnabled(const std::string& name, bool enabled){
+    for(auto& effect: effects){
+        if(effect.name != name || effect.enabled == enabled) continue;
+        effect.enabled = enabled;
+        dirty = true;
+    }
+}
+
+void PostProcessChain::setTexture(const std::string& name, BindableTexture& texture){
+    for(auto& [texture_name, pointer]: textures){
+        if(texture_name != name) continue;
+        pointer = &texture;
+        return;
+    }
+    textures.push_back({name, &texture});
+}
+
+BindableTexture* PostProcessChain::findTexture(const std::string& name){
+    for(auto& [texture_name, pointer]: textures) if(texture_name == name) return pointer;
+    return nullptr;
+}
+
+std::string PostProcessChain::generate(const std::vector<const PostEffect*>& fused, std::vector<std::string>& pass_textures){
+    // Name and declaration of every uniform in the pass, each is declared once at the top.
+    // GLSL rejects a redeclaration, so snippets sharing a uniform have their own declarations dropped
+    std::vector<std::pair<std::string, std::string>> uniforms = {
+        {"postSource", "uniform sampler2D postSource;"},
+        {"postTexelSize", "uniform vec2 postTexelSize;"}
+    };
+    auto declare = [&](const PostEffect& effect, const std::string& name, const std::string& declaration){
+        for(auto& [existing_name, existing]: uniforms){
+            if(existing_name != name) continue;
+            if(existing != declaration) throw std::logic_error("Post effect '" + effect.name + "' declares uniform '" + name + "' differently than another effect in its pass.");
+            return;
+        }
+        uniforms.push_back({name, declaration});
+    };
+
+    for(auto* effect: fused){
+        for(auto& name: effect->textures){
+            if(std::find(pass_textures.begin(), pass_textures.end(), name) != pass_textures.end()) continue;
+            pass_textures.push_back(name);
+            declare(*effect, name, "uniform sampler2D " + name + ";");
+        }
+    }
+
+    // Every snippet calls its entry point apply, renamed so they can live side by side
+    std::string snippets = "";
+    for(size_t i = 0; i < fused.size(); i++){
+        snippets += "\n// " + fused[i]->name + "\n";
+        snippets += "#define apply heptcore_post_" + std::to_string(i) + "\n";
+
+        std::istringstream stream(fused[i]->code);
+        std::string line, name, declaration;
+        while(std::getline(stream, line)){
+            if(parseUniform(line, name, declaration)) declare(*fused[i], name, declaration);
+            else snippets += line + "\n";
+        }
+
+        snippets += "#undef apply\n";
+    }
+
+    std::string source = "#version 450 core\n"
+        "in vec2 TexCoord;\n"
+        "out vec4 FragColor;\n";
+    for(auto& [name, declaration]: uniforms) source += declaration + "\n";
+    source += snippets;
+
+    source += "\nvoid main(){\n";
+    source += "    vec2 uv = TexCoord;\n";
+    if(fused.empty()) source += "    vec4 color = texture(postSource, uv);\n";
+    else if(fused[0]->neighborhood) source += "    vec4 color = heptcore_post_0(postSource, uv);\n";
+    else source += "    vec4 color = heptcore_post_0(texture(postSource, uv), uv);\n";
+
+    for(size_t i = 1; i < fused.size(); i++) source += "    color = heptcore_post_" + std::to_string(i) + "(color, uv);\n";
+
+    source += "    FragColor = color;\n";
+    source += "}\n";
+
+    return source;
+}
+
+void PostProcessChain::build(){
+    std::vector<std::vector<const PostEffect*>> groups = {};
+
+    for(auto& effect: effects){
+        if(!effect.enabled) continue;
+
+        // Neighborhood effects need the previous result in a texture, so they start a new pass
+        if(groups.empty() || effect.neighborhood) groups.push_back({});
+        groups.back().push_back(&effect);
+    }
+    if(groups.empty()) groups.push_back({}); // Plain copy
+
+    passes.clear();
+    for(auto& group: groups){
+        Pass pass = {};
+
+        std::string fragment_source = generate(group, pass.textures);
+        pass.program = &cache.getFromSources({{post_vertex_source, GL_VERTEX_SHADER}, {fragment_source, GL_FRAGMENT_SHADER}});
+
+        for(auto* effect: group) pass.effects.push_back(effect->name);
+
+        pass.program->setSamplerSlot("postSource", 0);
+        for(size_t i = 0; i < pass.textures.size(); i++) pass.program->setSamplerSlot(pass.textures[i], (int) i + 1);
+
+        pass.texel_size_location = pass.program->getUniformLocation("postTexelSize");
+        uniformLinker().ignore("postTexelSize");
+
+        passes.push_back(pass);
+    }
+
+    dirty = false;
+}
+
+void PostProcessChain::ensureIntermediates(int width, int height){
+    if(intermediates[0] && intermediate_width == width && intermediate_height == height) return;
+
+    FramebufferSettings settings = {};
+    settings.depth = DEPTH_NONE;
+
+    for(auto& intermediate: intermediates){
+        intermediate = std::make_unique<Framebuffer>(width, height, std::vector<Framebuffer::FramebufferTexture>{{intermediate_format, GL_RGBA, GL_FLOAT}}, settings);
+        intermediate->label("PostProcessChain intermediate");
+    }
+
+    intermediate_width = width;
+    intermediate_height = height;
+}
+
+const std::vector<PostProcessChain::Pass>& PostProcessChain::getPasses(){
+    if(dirty) build();
+    return passes;
+}
+
+void PostProcessChain::render(BindableTexture& input, int width, int height, Framebuffer* output){
+    if(dirty) build();
+    if(passes.size() > 1) ensureIntermediates(width, height);
+
+    HEPTCORE_DEBUG_GROUP("PostProcessChain::render");
+
+    GLboolean depth_enabled = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend_enabled = glIsEnabled(GL_BLEND);
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    // Neighborhood taps land between texels, sample every input bilinearly whatever the textures own filter is
+    Sampler& sampler = samplerCache().get(SamplerDescription::linear(GL_CLAMP_TO_EDGE));
+
+    // The input can have any size, the intermediates are the size of the output
+    int source_width = width, source_height = height;
+    glGetTextureLevelParameteriv(input.getID(), 0, GL_TEXTURE_WIDTH, &source_width);
+    glGetTextureLevelParameteriv(input.getID(), 0, GL_TEXTURE_HEIGHT, &source_height);
+
+    BindableTexture* source = &input;
+    for(size_t i = 0; i < passes.size(); i++){
+        Pass& pass = passes[i];
+        bool last = i + 1 == passes.size();
+
+        Framebuffer* target = last ? output : intermediates[i % 2].get();
+        if(target) target->bind();
+        else Framebuffer::bindDefault();
+        glViewport(0, 0, width, height);
+
+        pass.program->use();
+        pass.program->updateUniforms();
+        glUniform2f(pass.texel_size_location, 1.0f / source_width, 1.0f / source_height);
+        HEPTCORE_COUNT(uniform_uploads, 1);
+
+        source->bind(0, sampler);
+        for(size_t j = 0; j < pass.textures.size(); j++){
+            BindableTexture* texture = findTexture(pass.textures[j]);
+            if(!texture) throw std::logic_error("Post process texture '" + pass.textures[j] + "' was never set.");
+            texture->bind((int) j + 1);
+        }
+
+        quad.render();
+
+        // Ping pong, the next pass reads what this one wrote
+        if(!last){
+            source = &intermediates[i % 2]->getTextures()[0];
+            source_width = width;
+            source_height = height;
+        }
+    }
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    if(depth_enabled) glEnable(GL_DEPTH_TEST);
+    if(blend_enabled) glEnable(GL_BLEND);
+}
@@ -3,6 +3,8 @@
 using namespace Heptcore;
 
 FullscreenQuad::FullscreenQuad(){
+    HEPTCORE_RECORD_SUPPRESS();
+
     std::array<float, 20> quad_data = {
         -1.0f, 1.0f,  0.0f, 1.0f, 
          1.0f, 1.0f,  1.0f, 1.0f, 
@@ -15,9 +17,26 @@ FullscreenQuad::FullscreenQuad(){
     vao.attachBuffer(&quad_buffer, {VEC2, VEC2});
 }
 
+FullscreenQuad::FullscreenQuad(FullscreenQuad&& other) noexcept:
+    vao(std::move(other.vao)),
+    quad_buffer(std::move(other.quad_buffer)){
+    vao.replaceBuffer(&other.quad_buffer, &quad_buffer);
+}
+
+FullscreenQuad& FullscreenQuad::operator=(FullscreenQuad&& other) noexcept{
+    // Both vaos swap their pointers along with the buffers
+    vao = std::move(other.vao);
+    quad_buffer = std::move(other.quad_buffer);
+    vao.replaceBuffer(&other.quad_buffer, &quad_buffer);
+    other.vao.replaceBuffer(&quad_buffer, &other.quad_buffer);
+    return *this;
+}
+
 void FullscreenQuad::render(){
-    vao.bind();
+    HEPTCORE_RECORD(renderQuad());
+    HEPTCORE_RECORD_SUPPRESS();
+
     quad_buffer.bind();
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    vao.draw(GL_TRIANGLE_STRIP, 0, 4);
     vao.unbind();
 }
\ No newline at end of file
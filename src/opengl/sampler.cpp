@@ -0,0 +1,149 @@
+#include <opengl/sampler.hpp>
+#include <opengl/context_state.hpp>
+#include <opengl/memory.hpp>
+#include <opengl/texture.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+using namespace Heptcore;
+
+SamplerCache& Heptcore::samplerCache(){
+    return *ContextState::current().getSamplerCache();
+}
+
+SamplerDescription SamplerDescription::nearest(int wrap){
+    SamplerDescription description = {};
+    description.min_filter = GL_NEAREST;
+    description.mag_filter = GL_NEAREST;
+    description.wrap_s = description.wrap_t = description.wrap_r = wrap;
+    return description;
+}
+
+SamplerDescription SamplerDescription::linear(int wrap){
+    SamplerDescription description = {};
+    description.min_filter = GL_LINEAR;
+    description.mag_filter = GL_LINEAR;
+    description.wrap_s = description.wrap_t = description.wrap_r = wrap;
+    return description;
+}
+
+SamplerDescription SamplerDescription::trilinear(int wrap, float anisotropy){
+    SamplerDescription description = {};
+    description.wrap_s = description.wrap_t = description.wrap_r = wrap;
+    description.anisotropy = anisotropy;
+    return description;
+}
+
+SamplerDescription SamplerDescription::shadow(){
+    SamplerDescription description = linear(GL_CLAMP_TO_EDGE);
+    description.compare_mode = GL_COMPARE_REF_TO_TEXTURE;
+    return description;
+}
+
+size_t SamplerDescriptionHash::operator()(const SamplerDescription& description) const{
+    size_t hash = 0;
+    auto combine = [&hash](size_t value){
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    };
+
+    combine(std::hash<int>{}(description.min_filter));
+    combine(std::hash<int>{}(description.mag_filter));
+    combine(std::hash<int>{}(description.wrap_s));
+    combine(std::hash<int>{}(description.wrap_t));
+    combine(std::hash<int>{}(description.wrap_r));
+    combine(std::hash<float>{}(description.anisotropy));
+    combine(std::hash<float>{}(description.lod_bias));
+    combine(std::hash<float>{}(description.min_lod));
+    combine(std::hash<float>{}(description.max_lod));
+    combine(std::hash<int>{}(description.compare_mode));
+    combine(std::hash<int>{}(description.compare_function));
+
+    return hash;
+}
+
+Sampler::Sampler(const SamplerDescription& description, float anisotropy_limit): description(description){
+    glCreateSamplers(1, &sampler);
+
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, description.min_filter);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, description.mag_filter);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, description.wrap_s);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, description.wrap_t);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, description.wrap_r);
+    glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, description.lod_bias);
+    glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, description.min_lod);
+    glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, description.max_lod);
+    glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, description.compare_mode);
+    glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, description.compare_function);
+
+    apply(anisotropy_limit);
+}
+
+Sampler::~Sampler(){
+    if(!sampler) return; // Moved from
+
+    // Dont leave a dangling name in the bind cache, it could be reused by the next sampler
+    for(int unit = 0; unit < 32; unit++) if(getBoundSampler(unit) == sampler) bindSampler(unit, 0);
+    glDeleteSamplers(1, &sampler);
+}
+
+Sampler::Sampler(Sampler&& other) noexcept: sampler(std::exchange(other.sampler, 0)), description(other.description){}
+Sampler& Sampler::operator=(Sampler&& other) noexcept{
+    std::swap(sampler, other.sampler);
+    std::swap(description, other.description);
+    return *this;
+}
+
+void Sampler::apply(float anisotropy_limit){
+    if(anisotropy_limit <= 0.0f) return; // The context cant filter anisotropically, the parameter doesnt exist there
+    float anisotropy = std::max(1.0f, std::min(description.anisotropy, anisotropy_limit));
+    glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+}
+
+void Sampler::bind(int unit) const{
+    bindSampler(unit, sampler);
+}
+
+void Sampler::unbind(int unit) const{
+    if(getBoundSampler(unit) == sampler) bindSampler(unit, 0);
+}
+
+float SamplerCache::effectiveLimit(){
+    if(!anisotropy_queried){
+        // Core since 4.6, before that only with one of the extensions (same enums)
+        bool supported = GLAD_GL_VERSION_4_6 || isExtensionSupported("GL_ARB_texture_filter_anisotropic") || isExtensionSupported("GL_EXT_texture_filter_anisotropic");
+        if(supported){
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &hardware_anisotropy);
+            if(hardware_anisotropy < 1.0f) hardware_anisotropy = 1.0f;
+        }
+        anisotropy_queried = true;
+    }
+
+    if(hardware_anisotropy == 0.0f) return 0.0f;
+    return std::min(anisotropy_limit, hardware_anisotropy);
+}
+
+Sampler& SamplerCache::get(const SamplerDescription& description){
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iterator = samplers.find(description);
+    if(iterator != samplers.end()) return *iterator->second;
+
+    auto sampler = std::make_unique<Sampler>(description, effectiveLimit());
+    return *samplers.emplace(description, std::move(sampler)).first->second;
+}
+
+void SamplerCache::setAnisotropyLimit(float limit){
+    std::lock_guard<std::mutex> lock(mutex);
+    anisotropy_limit = std::max(1.0f, limit);
+    if(samplers.empty()) return;
+
+    // Only the sampler objects change, textures are left alone
+    float effective = effectiveLimit();
+    for(auto& [description, sampler]: samplers) sampler->apply(effective);
+}
+
+void SamplerCache::clear(){
+    std::lock_guard<std::mutex> lock(mutex);
+    samplers.clear();
+}
@@ -0,0 +1,245 @@
+#include <opengl/shader_preprocessor.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+using namespace Heptcore;
+
+ShaderPreprocessor Heptcore::shaderPreprocessor = {};
+
+uint64_t Heptcore::hashString(const std::string& text, uint64_t seed){
+    // FNV-1a, only has to be stable and cheap
+    uint64_t hash = seed;
+    for(unsigned char character: text){
+        hash ^= character;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string_view trimStart(std::string_view line){
+    size_t start = line.find_first_not_of(" \t");
+    if(start == std::string_view::npos) return {};
+    return line.substr(start);
+}
+
+static bool isDirective(std::string_view line, std::string_view directive){
+    line = trimStart(line);
+    if(line.empty() || line[0] != '#') return false;
+    line = trimStart(line.substr(1)); // "# include" is valid too
+    if(!line.starts_with(directive)) return false;
+    return line.size() == directive.size() || line[directive.size()] == ' ' || line[directive.size()] == '\t' || line[directive.size()] == '\r';
+}
+
+static bool isIdentifierStart(char character){
+    return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '_';
+}
+
+static bool isIdentifierCharacter(char character){
+    return isIdentifierStart(character) || (character >= '0' && character <= '9');
+}
+
+std::string ShaderPreprocessor::readFile(const std::string& path){
+    std::ifstream file(path);
+    if(!file.is_open()){
+        std::cerr << "Failed to open shader file: " << path << std::endl;
+        throw std::runtime_error("Failed to open shader file: " + path);
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+std::string ShaderPreprocessor::resolve(const std::string& name, const std::string& including_file, std::string& source){
+    namespace fs = std::filesystem;
+
+    std::vector<fs::path> candidates = {};
+    if(fs::exists(including_file)) candidates.push_back(fs::path(including_file).parent_path() / name);
+    for(auto& directory: include_directories) candidates.push_back(fs::path(directory) / name);
+
+    for(auto& candidate: candidates){
+        if(!fs::is_regular_file(candidate)) continue;
+
+        std::string path = candidate.lexically_normal().string();
+        source = readFile(path);
+        return path;
+    }
+
+    auto named = named_sources.find(name);
+    if(named != named_sources.end()){
+        source = named->second;
+        return name;
+    }
+
+    std::cerr << "Failed to resolve shader include '" << name << "' in " << including_file << std::endl;
+    throw std::runtime_error("Failed to resolve shader include: " + name);
+}
+
+void ShaderPreprocessor::expandInto(const std::string& source, const std::string& filename, ExpandedShader& result, std::vector<std::string>& stack, std::unordered_set<std::string>& once){
+    auto index_iterator = std::find(result.files.begin(), result.files.end(), filename);
+    size_t file_index = index_iterator - result.files.begin();
+    if(index_iterator == result.files.end()) result.files.push_back(filename);
+
+    stack.push_back(filename);
+
+    std::istringstream stream(source);
+    std::string line;
+    size_t line_number = 0;
+
+    while(std::getline(stream, line)){
+        line_number++;
+
+        if(isDirective(line, "pragma once")){
+            once.insert(filename);
+            result.source += "\n"; // Keeps the line numbers right
+            continue;
+        }
+
+        if(!isDirective(line, "include")){
+            result.source += line;
+            result.source += '\n';
+            continue;
+        }
+
+        size_t open = line.find_first_of("\"<");
+        size_t close = open == std::string::npos ? open : line.find_first_of("\">", open + 1);
+        if(close == std::string::npos){
+            std::cerr << "Malformed #include in " << filename << " at line " << line_number << std::endl;
+            throw std::runtime_error("Malformed shader include in " + filename);
+        }
+
+        std::string included_source;
+        std::string included = resolve(line.substr(open + 1, close - open - 1), filename, included_source);
+
+        if(std::find(stack.begin(), stack.end(), included) != stack.end()){
+            std::cerr << "Recursive shader include of " << included << " in " << filename << std::endl;
+            throw std::runtime_error("Recursive shader include: " + included);
+        }
+
+        if(once.contains(included)){
+            result.source += "\n";
+            continue;
+        }
+
+        size_t included_index = std::find(result.files.begin(), result.files.end(), included) - result.files.begin();
+        result.source += "#line 1 " + std::to_string(included_index) + "\n";
+        expandInto(included_source, included, result, stack, once);
+        result.source += "#line " + std::to_string(line_number + 1) + " " + std::to_string(file_index) + "\n";
+    }
+
+    stack.pop_back();
+}
+
+ExpandedShader ShaderPreprocessor::expandSource(const std::string& source, const std::string& filename){
+    ExpandedShader result = {};
+    std::vector<std::string> stack = {};
+    std::unordered_set<std::string> once = {};
+
+    expandInto(source, filename, result, stack, once);
+
+    result.hash = hashString(result.source);
+
+    const std::string& text = result.source;
+    for(size_t i = 0; i < text.size();){
+        if(!isIdentifierStart(text[i]) || (i > 0 && isIdentifierCharacter(text[i - 1]))){
+            i++;
+            continue;
+        }
+
+        size_t end = i;
+        while(end < text.size() && isIdentifierCharacter(text[end])) end++;
+        result.identifiers.emplace(text, i, end - i);
+        i = end;
+    }
+
+    return result;
+}
+
+void ShaderPreprocessor::addIncludeDirectory(const std::string& directory){
+    std::lock_guard<std::mutex> lock(mutex);
+    include_directories.push_back(directory);
+}
+
+void ShaderPreprocessor::addSource(const std::string& name, const std::string& source){
+    std::lock_guard<std::mutex> lock(mutex);
+    named_sources[name] = source;
+}
+
+/*
+    Named sources arent files and never change, they get the same (minimum) time every time
+*/
+static std::filesystem::file_time_type modifiedTime(const std::string& path){
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : time;
+}
+
+std::shared_ptr<const ExpandedShader> ShaderPreprocessor::load(const std::string& filename, bool check_modified){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto iterator = cache.find(filename);
+    if(iterator != cache.end()){
+        CachedShader& cached = iterator->second;
+
+        bool modified = false;
+        for(size_t i = 0; check_modified && !modified && i < cached.shader->files.size(); i++)
+            modified = modifiedTime(cached.shader->files[i]) != cached.modified[i];
+        if(!modified) return cached.shader;
+    }
+
+    CachedShader loaded = {std::make_shared<const ExpandedShader>(expandSource(readFile(filename), filename)), {}};
+    for(auto& file: loaded.shader->files) loaded.modified.push_back(modifiedTime(file));
+
+    // Threads still holding the old version keep reading it, the entry only points at the new one
+    if(iterator != cache.end()) iterator->second = std::move(loaded);
+    else iterator = cache.emplace(filename, std::move(loaded)).first;
+    return iterator->second.shader;
+}
+
+ExpandedShader ShaderPreprocessor::expand(const std::string& source, const std::string& name){
+    std::lock_guard<std::mutex> lock(mutex);
+    return expandSource(source, name);
+}
+
+std::string ShaderPreprocessor::inject(const ExpandedShader& shader, const ShaderDefines& defines, bool skip_unused){
+    std::string block = "";
+    for(auto& [name, value]: defines){
+        if(skip_unused && !shader.identifiers.contains(name)) continue;
+        block += "#define " + name + (value != "" ? " " + value : "") + "\n";
+    }
+
+    // #version has to stay the first thing in the shader
+    const std::string& source = shader.source;
+    size_t line_start = 0;
+    size_t line_number = 1;
+    while(line_start < source.size()){
+        size_t line_end = source.find('\n', line_start);
+        if(line_end == std::string::npos) line_end = source.size();
+
+        std::string_view line(source.data() + line_start, line_end - line_start);
+        if(isDirective(line, "version")){
+            size_t after = std::min(line_end + 1, source.size());
+            return source.substr(0, after) + block + "#line " + std::to_string(line_number + 1) + " 0\n" + source.substr(after);
+        }
+
+        // Only comments and empty lines may come before it
+        std::string_view trimmed = trimStart(line);
+        if(!trimmed.empty() && !trimmed.starts_with("//") && trimmed[0] != '\r') break;
+
+        line_start = line_end + 1;
+        line_number++;
+    }
+
+    return block + "#line 1 0\n" + source;
+}
+
+void ShaderPreprocessor::invalidate(){
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.clear();
+}
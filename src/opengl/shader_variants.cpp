@@ -0,0 +1,98 @@
+#include <opengl/shader_variants.hpp>
+
+using namespace Heptcore;
+
+std::string ShaderVariantCache::variantKey(const std::vector<uint64_t>& hashes, const ShaderDefines& defines){
+    std::string key = "";
+    for(uint64_t hash: hashes){
+        key += std::to_string(hash);
+        key += ',';
+    }
+    key += '|';
+    for(auto& [name, value]: defines){
+        key += name;
+        key += '=';
+        key += value;
+        key += ';';
+    }
+    return key;
+}
+
+ShaderProgram& ShaderVariantCache::build(const std::vector<std::pair<const ExpandedShader*, int>>& stages, const ShaderDefines& defines, const std::string& key){
+    std::vector<std::string> sources = {};
+    uint64_t hash = 14695981039346656037ull;
+    for(auto& [shader, type]: stages){
+        sources.push_back(ShaderPreprocessor::inject(*shader, defines, true));
+        hash = hashString(std::to_string(type), hashString(sources.back(), hash));
+    }
+
+    auto iterator = programs.find(hash);
+    if(iterator != programs.end()){
+        variants[key] = iterator->second.get();
+        return *iterator->second;
+    }
+
+    auto program = std::make_unique<ShaderProgram>();
+    for(size_t i = 0; i < stages.size(); i++){
+        const ExpandedShader& shader = *stages[i].first;
+        program->addShaderSource(sources[i], stages[i].second, shader.files.empty() ? "" : shader.files[0]);
+    }
+    program->compile();
+    compiled++;
+
+    ShaderProgram* pointer = program.get();
+    programs.emplace(hash, std::move(program));
+    variants[key] = pointer;
+
+    return *pointer;
+}
+
+ShaderProgram& ShaderVariantCache::get(const std::vector<ShaderStage>& stages, const ShaderDefines& defines){
+    std::lock_guard<std::mutex> lock(mutex);
+    requests++;
+
+    std::vector<std::shared_ptr<const ExpandedShader>> loaded = {}; // Keeps them alive until the program is built
+    std::vector<std::pair<const ExpandedShader*, int>> expanded = {};
+    std::vector<uint64_t> hashes = {};
+    for(auto& stage: stages){
+        loaded.push_back(preprocessor.load(stage.path));
+        expanded.push_back({loaded.back().get(), stage.type});
+        hashes.push_back(loaded.back()->hash ^ (uint64_t) stage.type);
+    }
+
+    std::string key = variantKey(hashes, defines);
+    auto iterator = variants.find(key);
+    if(iterator != variants.end()) return *iterator->second;
+
+    return build(expanded, defines, key);
+}
+
+ShaderProgram& ShaderVariantCache::getFromSources(const std::vector<std::pair<std::string, int>>& sources, const ShaderDefines& defines){
+    std::lock_guard<std::mutex> lock(mutex);
+    requests++;
+
+    std::vector<std::pair<const ExpandedShader*, int>> expanded = {};
+    std::vector<uint64_t> hashes = {};
+    for(auto& [source, type]: sources){
+        uint64_t raw_hash = hashString(source);
+
+        auto iterator = embedded.find(raw_hash);
+        if(iterator == embedded.end()) iterator = embedded.emplace(raw_hash, preprocessor.expand(source)).first;
+
+        expanded.push_back({&iterator->second, type});
+        hashes.push_back(iterator->second.hash ^ (uint64_t) type);
+    }
+
+    std::string key = variantKey(hashes, defines);
+    auto iterator = variants.find(key);
+    if(iterator != variants.end()) return *iterator->second;
+
+    return build(expanded, defines, key);
+}
+
+void ShaderVariantCache::clear(){
+    std::lock_guard<std::mutex> lock(mutex);
+    variants.clear();
+    programs.clear();
+    embedded.clear();
+}
@@ -30,27 +30,63 @@ uint compileShader(const char* source, int type, std::string filename = ""){
     return shader;
 }
 
-void ShaderProgram::addShader(std::string filename, int type){
-    std::ifstream file(filename);  // Open the file
-    if (!file.is_open()) {              // Check if the file is open
-        std::cerr << "Failed to open shader file: " << filename << std::endl;
-        return;
+/*
+    Names every source string number used in #line so compiler errors can be traced back to includes
+*/
+static std::string describeFiles(const ExpandedShader& shader){
+    if(shader.files.size() <= 1) return shader.files.empty() ? "" : shader.files[0];
+
+    std::string description = shader.files[0] + " (source strings:";
+    for(size_t i = 0; i < shader.files.size(); i++) description += " " + std::to_string(i) + " = " + shader.files[i];
+    return description + ")";
+}
+
+void ShaderProgram::addShader(std::string filename, int type, const ShaderDefines& defines){
+    std::shared_ptr<const ExpandedShader> shader = nullptr;
+    try{
+        // Edited files are read again, so recreating a program picks up the changes
+        shader = shaderPreprocessor.load(filename, true);
+    }
+    catch(const std::runtime_error&){
+        std::cerr << "Failed to load shader: " << filename << std::endl;
+        throw;
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();             
+    addShaderSource(*shader, type, defines);
+}
 
-    std::string source = buffer.str();
+void ShaderProgram::addShaderSource(std::string source, int type, std::string name){
+    uint shader = compileShader(source.c_str(), type, name);
+    this->shaders.push_back(shader);
+#if HEPTCORE_CAPTURE
+    this->sources.emplace_back(type, std::move(source));
+#endif
+}
 
-    file.close();  // Close the file
+void ShaderProgram::addShaderSource(const ExpandedShader& shader, int type, const ShaderDefines& defines){
+    addShaderSource(ShaderPreprocessor::inject(shader, defines), type, describeFiles(shader));
+}
 
-    uint shader = compileShader(source.c_str(), type, filename);
-    this->shaders.push_back(shader);
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept:
+    program(std::exchange(other.program, 0)),
+    shaders(std::move(other.shaders)),
+    linked_uniforms(std::move(other.linked_uniforms)){
+#if HEPTCORE_CAPTURE
+    sources = std::move(other.sources);
+#endif
 }
 
-void ShaderProgram::addShaderSource(std::string source, int type){
-    uint shader = compileShader(source.c_str(), type);
-    this->shaders.push_back(shader);
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept{
+    if(this == &other) return *this;
+
+    // Our old program goes away with other
+    std::swap(program, other.program);
+    std::swap(shaders, other.shaders);
+    std::swap(linked_uniforms, other.linked_uniforms);
+#if HEPTCORE_CAPTURE
+    std::swap(sources, other.sources);
+#endif
+    return *this;
 }
 
 int ShaderProgram::getUniformLocation(std::string name){
@@ -70,36 +106,15 @@ void ShaderProgram::compile(){
         glDeleteShader(this->shaders[i]);
     }
 
-    uniformLinker.addProgram(this);
-}
-
-void ShaderProgram::updateUniforms(){
-    uniformLinker.updateUniforms(this);
+    linkUniforms();
 }
 
-ShaderUniformLinker Heptcore::uniformLinker = ShaderUniformLinker();
-
-void ShaderUniformLinker::updateUniforms(ShaderProgram* program){
-    if(!shaderPrograms.contains(program)) return;
-
-    program->use();
-    for(auto& [name,location]: shaderPrograms[program].uniforms){
-        if(!uniforms.contains(name)){
-            if(ignored_uniforms.contains(name)) continue;
-            //std::cerr << "Shader program is missing a uniform: " << name << std::endl;
-            continue;
-        }
-
-        uniforms[name]->update(location);
-    }
-}
+void ShaderProgram::linkUniforms(){
+    linked_uniforms.clear();
 
-void ShaderUniformLinker::addProgram(ShaderProgram* program){
-    LinkedProgram linked_program = {};
-    
-    program->use();
+    use();
     GLint numUniforms = 0;
-    glGetProgramiv(program->getID(), GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
 
     for (GLint i = 0; i < numUniforms; ++i) {
         char name_buffer[256]; 
@@ -107,7 +122,13 @@ void ShaderUniformLinker::addProgram(ShaderProgram* program){
         GLint size = 0;
         GLenum type = 0;
 
-        glGetActiveUniform(program->getID(), i, sizeof(name_buffer), &nameLength, &size, &type, name_buffer);
+        glGetActiveUniform(program, i, sizeof(name_buffer), &nameLength, &size, &type, name_buffer);
+
+        // Members of uniform blocks have no location, the block is filled through its buffer
+        GLuint index = i;
+        GLint block = -1;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+        if(block != -1) continue;
 
         std::string name = std::string(name_buffer);
         if(name.ends_with("]")){ // For array uniforms
@@ -115,20 +136,42 @@ void ShaderUniformLinker::addProgram(ShaderProgram* program){
             std::cout << "Changed name: " << name <<  std::endl;
         }
 
-        int location = glGetUniformLocation(program->getID(), name.c_str());
+        int location = glGetUniformLocation(program, name.c_str());
 
         if(location == -1) {
             std::cerr << "Reported uniform '" << name << "' not found." << std::endl;
             continue;
         }
 
-        linked_program.uniforms[name] = location;
+        linked_uniforms[name] = location;
     }
+}
+
+void ShaderProgram::updateUniforms(){
+    uniformLinker().updateUniforms(this);
+}
 
-    shaderPrograms[program] = linked_program;
+ShaderUniformLinker& Heptcore::uniformLinker(){
+    return *ContextState::current().getUniformLinker();
+}
+
+void ShaderUniformLinker::updateUniforms(ShaderProgram* program){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    program->use();
+    for(auto& [name,location]: program->linked_uniforms){
+        if(!uniforms.contains(name)){
+            if(ignored_uniforms.contains(name)) continue;
+            //std::cerr << "Shader program is missing a uniform: " << name << std::endl;
+            continue;
+        }
+
+        uniforms[name]->update(location);
+    }
 }
 
 void ShaderUniformLinker::addUniform(UniformBase* uniform){
+    std::lock_guard<std::mutex> lock(mutex);
     if(uniforms.contains(uniform->getName())){
         std::cerr << "Cannot overwrite already existing uniform '" << uniform->getName() << "'." << std::endl;
         return;
@@ -137,18 +180,12 @@ void ShaderUniformLinker::addUniform(UniformBase* uniform){
     uniforms[uniform->getName()] = uniform;
 }
 
-void ShaderUniformLinker::removeProgram(ShaderProgram* program){
-    if(!shaderPrograms.contains(program)){ // Can happend for uncompiled programs
-        return;
-    }
-
-    shaderPrograms.erase(program);
-}
 void ShaderUniformLinker::removeUniform(UniformBase* uniform){
+    std::lock_guard<std::mutex> lock(mutex);
     if(!uniforms.contains(uniform->getName())){
         std::cerr << "Removing a missing uniform from uniform linker? This shouldnt happen." << std::endl;
         return;
     }
 
     uniforms.erase(uniform->getName());
-}
\ No newline at end of file
+}
@@ -0,0 +1,214 @@
+#include <opengl/sprite_batch.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Heptcore;
+
+static const char* sprite_vertex_source = R"(
+#version 450 core
+layout (location = 0) in vec4 aPositionSize;
+layout (location = 1) in vec4 aUV;
+layout (location = 2) in vec4 aTint;
+layout (location = 3) in vec2 aRotationLayer;
+
+uniform mat4 viewProjection;
+
+out vec3 uv;
+out vec4 tint;
+
+void main(){
+    // Triangle strip corners, 0 1 2 3 -> (0,0) (1,0) (0,1) (1,1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    vec2 local = (corner - 0.5) * aPositionSize.zw;
+    float s = sin(aRotationLayer.x);
+    float c = cos(aRotationLayer.x);
+    vec2 rotated = vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+    gl_Position = viewProjection * vec4(aPositionSize.xy + rotated, 0.0, 1.0);
+    uv = vec3(mix(aUV.xy, aUV.zw, corner), aRotationLayer.y);
+    tint = aTint;
+}
+)";
+
+static const char* sprite_fragment_source = R"(
+#version 450 core
+in vec3 uv;
+in vec4 tint;
+
+uniform sampler2DArray sprites;
+
+out vec4 FragColor;
+
+void main(){
+    FragColor = texture(sprites, uv) * tint;
+}
+)";
+
+SpriteBatch::SpriteBatch(size_t section_capacity): section_capacity(section_capacity), instances(section_capacity * SECTIONS * sizeof(Instance), GL_ARRAY_BUFFER){
+    if(section_capacity == 0) throw std::logic_error("Sprite batch needs room for at least one sprite.");
+
+    program.addShaderSource(sprite_vertex_source, GL_VERTEX_SHADER);
+    program.addShaderSource(sprite_fragment_source, GL_FRAGMENT_SHADER);
+    program.compile();
+
+    program.setSamplerSlot("sprites", 0);
+    view_projection_location = program.getUniformLocation("viewProjection");
+    uniformLinker().ignore("viewProjection");
+    program.label("SpriteBatch program");
+
+    // The instance attributes never change, which section is drawn is picked with the base instance
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instances.getID());
+
+    uint slot = 0;
+    VertexFormat({VEC4, VEC4, VEC4, VEC2}, true).apply(slot);
+
+    glBindVertexArray(0);
+    labelObject(GL_VERTEX_ARRAY, vao, "SpriteBatch vao");
+    labelObject(GL_BUFFER, instances.getID(), "SpriteBatch instances");
+}
+
+SpriteBatch::~SpriteBatch(){
+    for(auto& fence: section_fences) if(fence) glDeleteSync(fence);
+    glDeleteVertexArrays(1, &vao);
+}
+
+uint32_t SpriteBatch::sortKey(int layer, SpriteBlendMode blend){
+    // Layer in the upper 24 bits (offset so negative layers sort first), blend mode in the lower 8
+    int clamped = std::clamp(layer, -(1 << 23), (1 << 23) - 1);
+    return ((uint32_t) (clamped + (1 << 23)) << 8) | (uint32_t) blend;
+}
+
+void SpriteBatch::begin(TextureArray2D& texture, const glm::mat4& view_projection){
+    if(begun) throw std::logic_error("SpriteBatch::begin called twice without end.");
+
+    this->texture = &texture;
+    this->view_projection = view_projection;
+    begun = true;
+}
+
+void SpriteBatch::draw(const Sprite& sprite){
+    if(!begun) throw std::logic_error("SpriteBatch::draw called without begin.");
+
+    uint32_t key = sortKey(sprite.layer, sprite.blend);
+
+    // Consecutive sprites almost always share a bin, skip the map lookup for those
+    if(key != last_key || !last_bin){
+        last_bin = &bins[key];
+        last_key = key;
+    }
+
+    last_bin->push_back({
+        {sprite.position.x, sprite.position.y},
+        {sprite.size.x, sprite.size.y},
+        {sprite.uv.x, sprite.uv.y, sprite.uv.z, sprite.uv.w},
+        {sprite.tint.x, sprite.tint.y, sprite.tint.z, sprite.tint.w},
+        sprite.rotation,
+        (float) sprite.texture_layer
+    });
+}
+
+void SpriteBatch::applyBlendMode(SpriteBlendMode blend){
+    switch(blend){
+        case SPRITE_BLEND_OPAQUE:
+            glDisable(GL_BLEND);
+            return;
+        case SPRITE_BLEND_ALPHA:
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case SPRITE_BLEND_PREMULTIPLIED:
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case SPRITE_BLEND_ADDITIVE:
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+            break;
+    }
+    glEnable(GL_BLEND);
+}
+
+void SpriteBatch::nextSection(){
+    section_fences[section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    section = (section + 1) % SECTIONS;
+    section_used = 0;
+
+    GLsync& fence = section_fences[section];
+    if(!fence) return;
+
+    // Only blocks when the gpu is more than two sections behind
+    while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void SpriteBatch::drawBin(const std::vector<Instance>& bin){
+    size_t offset = 0;
+
+    while(offset < bin.size()){
+        if(section_used == section_capacity) nextSection();
+
+        size_t count = std::min(bin.size() - offset, section_capacity - section_used);
+        size_t base = section * section_capacity + section_used;
+
+        std::memcpy(instances.data() + base, bin.data() + offset, count * sizeof(Instance));
+        // Writes through the mapping dont go through a wrapper, the capture needs them for the draw
+        HEPTCORE_RECORD(bufferSubData(instances.getID(), base * sizeof(Instance), count * sizeof(Instance), bin.data() + offset));
+
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) count, (GLuint) base);
+        HEPTCORE_COUNT(draw_calls, 1);
+        HEPTCORE_COUNT(vertices, count * 4);
+        HEPTCORE_COUNT(instances, count);
+
+        section_used += count;
+        offset += count;
+    }
+}
+
+void SpriteBatch::end(){
+    if(!begun) throw std::logic_error("SpriteBatch::end called without begin.");
+    begun = false;
+
+    HEPTCORE_DEBUG_GROUP("SpriteBatch::end");
+
+    GLboolean blend_enabled = glIsEnabled(GL_BLEND);
+    GLint blend_source_rgb = 0, blend_destination_rgb = 0;
+    GLint blend_source_alpha = 0, blend_destination_alpha = 0;
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blend_source_rgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blend_destination_rgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_source_alpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_destination_alpha);
+
+    program.use();
+    glUniformMatrix4fv(view_projection_location, 1, GL_FALSE, glm::value_ptr(view_projection));
+    HEPTCORE_COUNT(uniform_uploads, 1);
+
+    texture->bind(0);
+
+    glBindVertexArray(vao);
+    HEPTCORE_COUNT(vao_binds, 1);
+
+    int current_blend = -1;
+    for(auto& [key, bin]: bins){
+        if(bin.empty()) continue;
+
+        SpriteBlendMode blend = (SpriteBlendMode) (key & 0xFF);
+        if(blend != current_blend){
+            applyBlendMode(blend);
+            current_blend = blend;
+        }
+
+        drawBin(bin);
+        bin.clear(); // Keeps the capacity for the next frame
+    }
+
+    glBindVertexArray(0);
+
+    glBlendFuncSeparate(blend_source_rgb, blend_destination_rgb, blend_source_alpha, blend_destination_alpha);
+    if(blend_enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+
+    texture = nullptr;
+}
@@ -0,0 +1,62 @@
+#include <opengl/stats.hpp>
+
+#include <fstream>
+#include <iostream>
+
+using namespace Heptcore;
+
+thread_local RenderStatisticsCollector Heptcore::renderStatistics = RenderStatisticsCollector();
+
+static const std::pair<const char*, uint64_t RenderStatistics::*> counter_fields[] = {
+    {"draw_calls",              &RenderStatistics::draw_calls},
+    {"vertices",                &RenderStatistics::vertices},
+    {"instances",               &RenderStatistics::instances},
+    {"dispatches",              &RenderStatistics::dispatches},
+    {"program_binds",           &RenderStatistics::program_binds},
+    {"vao_binds",               &RenderStatistics::vao_binds},
+    {"texture_binds",           &RenderStatistics::texture_binds},
+    {"sampler_binds",           &RenderStatistics::sampler_binds},
+    {"framebuffer_binds",       &RenderStatistics::framebuffer_binds},
+    {"redundant_binds_skipped", &RenderStatistics::redundant_binds_skipped},
+    {"uniform_uploads",         &RenderStatistics::uniform_uploads},
+    {"buffer_upload_bytes",     &RenderStatistics::buffer_upload_bytes},
+    {"texture_upload_bytes",    &RenderStatistics::texture_upload_bytes},
+};
+
+void RenderStatisticsCollector::endFrame(){
+    auto now = std::chrono::steady_clock::now();
+    current.cpu_frame_time = std::chrono::duration<double, std::milli>(now - frame_start).count();
+    frame_start = now;
+
+    last_frame = current;
+    if(record_history) history.push_back(current);
+
+    current = {};
+    frame++;
+}
+
+void RenderStatisticsCollector::writeCSVHeader(std::ostream& stream){
+    for(auto& [name, field]: counter_fields) stream << name << ",";
+    stream << "cpu_frame_time\n";
+}
+
+void RenderStatisticsCollector::writeCSVRow(std::ostream& stream, const RenderStatistics& statistics){
+    for(auto& [name, field]: counter_fields) stream << statistics.*field << ",";
+    stream << statistics.cpu_frame_time << "\n";
+}
+
+void RenderStatisticsCollector::writeCSV(std::ostream& stream) const{
+    writeCSVHeader(stream);
+    for(auto& statistics: history) writeCSVRow(stream, statistics);
+}
+
+bool RenderStatisticsCollector::writeCSV(const std::string& filename) const{
+    std::ofstream file(filename);
+    if(!file.is_open()){
+        std::cerr << "Failed to open statistics file: " << filename << std::endl;
+        return false;
+    }
+
+    writeCSV(file);
+    return true;
+}
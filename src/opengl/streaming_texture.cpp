@@ -0,0 +1,223 @@
+#include <opengl/streaming_texture.hpp>
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <stb_image.h>
+
+using namespace Heptcore;
+
+// ARB_sparse_texture, not in the core profile loader
+#define HEPTCORE_TEXTURE_SPARSE_ARB 0x91A6
+#define HEPTCORE_VIRTUAL_PAGE_SIZE_INDEX_ARB 0x91A7
+#define HEPTCORE_NUM_SPARSE_LEVELS_ARB 0x91AA
+#define HEPTCORE_NUM_VIRTUAL_PAGE_SIZES_ARB 0x91A8
+#define HEPTCORE_VIRTUAL_PAGE_SIZE_X_ARB 0x9195
+#define HEPTCORE_VIRTUAL_PAGE_SIZE_Y_ARB 0x9196
+#define HEPTCORE_MAX_SPARSE_TEXTURE_SIZE_ARB 0x9198
+
+typedef void (APIENTRYP TexPageCommitment)(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLboolean commit);
+
+static TexPageCommitment texPageCommitment(){
+    static const TexPageCommitment function = isExtensionSupported("GL_ARB_sparse_texture") ?
+        reinterpret_cast<TexPageCommitment>(glfwGetProcAddress("glTexPageCommitmentARB")) : nullptr;
+    return function;
+}
+
+StreamingTexture2D::StreamingTexture2D(const char* filename, bool allow_sparse, int initial_size){
+    int width = 0, height = 0, channels = 0;
+    unsigned char* data = stbi_load(filename, &width, &height, &channels, 4);
+    if(!data){
+        std::cerr << "Failed to load texture: " << filename << std::endl;
+        return;
+    }
+
+    load(data, width, height, allow_sparse);
+    stbi_image_free(data);
+
+    // Coarse levels go up right away, the finer ones wait for the streamer
+    while(resident_level > 0 && std::max(width >> (resident_level - 1), height >> (resident_level - 1)) <= initial_size) uploadNextLevel();
+}
+
+StreamingTexture2D::StreamingTexture2D(const unsigned char* data, int width, int height, bool allow_sparse, int initial_size){
+    load(data, width, height, allow_sparse);
+    while(resident_level > 0 && std::max(width >> (resident_level - 1), height >> (resident_level - 1)) <= initial_size) uploadNextLevel();
+}
+
+void StreamingTexture2D::load(const unsigned char* data, int width, int height, bool allow_sparse){
+    TYPE = GL_TEXTURE_2D;
+    this->width = width;
+    this->height = height;
+    levels = (int) floor(log2(fmax(width, height))) + 1;
+    chain = buildMipChain(data, width, height);
+
+    bind(0); // Names from glGenTextures only become objects once bound
+    sparse = allow_sparse && setupSparse();
+
+    glTextureStorage2D(texture, levels, GL_RGBA8, width, height);
+    glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    tail_level = levels;
+    if(sparse) glGetTextureParameteriv(texture, HEPTCORE_NUM_SPARSE_LEVELS_ARB, &tail_level);
+    tail_level = std::clamp(tail_level, 0, levels);
+
+    resident_level = levels; // Nothing yet
+    requested_level = levels - 1;
+    wanted_level = levels - 1;
+
+    if(!sparse) setMemorySize(textureMemorySize(GL_RGBA8, width, height, levels));
+
+    // The mip tail can only be committed as a whole, so it is uploaded as a whole
+    uploadNextLevel();
+    while(resident_level > tail_level) uploadNextLevel();
+}
+
+bool StreamingTexture2D::setupSparse(){
+    if(!texPageCommitment()) return false;
+
+    GLint page_sizes = 0;
+    glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, HEPTCORE_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &page_sizes);
+    if(page_sizes <= 0) return false;
+
+    GLint page_width = 0, page_height = 0, max_size = 0;
+    glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, HEPTCORE_VIRTUAL_PAGE_SIZE_X_ARB, 1, &page_width);
+    glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, HEPTCORE_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &page_height);
+    glGetIntegerv(HEPTCORE_MAX_SPARSE_TEXTURE_SIZE_ARB, &max_size);
+
+    // Sparse storage has to be made of whole pages
+    if(page_width <= 0 || page_height <= 0 || width % page_width != 0 || height % page_height != 0) return false;
+    if(width > max_size || height > max_size) return false;
+
+    glTextureParameteri(texture, HEPTCORE_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+    glTextureParameteri(texture, HEPTCORE_TEXTURE_SPARSE_ARB, GL_TRUE);
+    return true;
+}
+
+void StreamingTexture2D::commit(int level, bool commit){
+    if(!sparse) return;
+
+    // Committing any level of the tail commits all of it
+    level = std::min(level, tail_level);
+
+    bind(0);
+    glActiveTexture(GL_TEXTURE0); // The commitment call works on the active unit, the bind cache may have left another one active
+    texPageCommitment()(GL_TEXTURE_2D, level, 0, 0, 0, std::max(1, width >> level), std::max(1, height >> level), 1, commit ? GL_TRUE : GL_FALSE);
+}
+
+void StreamingTexture2D::setResidentLevel(int level){
+    resident_level = level;
+    glTextureParameteri(texture, GL_TEXTURE_BASE_LEVEL, level);
+    updateMemorySize();
+}
+
+void StreamingTexture2D::updateMemorySize(){
+    if(!sparse) return;
+
+    size_t committed = 0;
+    for(int level = std::min(resident_level, tail_level); level < levels; level++) committed += getLevelSize(level);
+    setMemorySize(committed);
+}
+
+size_t StreamingTexture2D::getLevelSize(int level) const{
+    return textureMemorySize(GL_RGBA8, std::max(1, width >> level), std::max(1, height >> level));
+}
+
+size_t StreamingTexture2D::uploadNextLevel(){
+    if(resident_level <= 0) return 0;
+    int level = resident_level - 1;
+
+    if(level < tail_level || level == levels - 1) commit(level, true);
+
+    int level_width = std::max(1, width >> level);
+    int level_height = std::max(1, height >> level);
+    glTextureSubImage2D(texture, level, 0, 0, level_width, level_height, GL_RGBA, GL_UNSIGNED_BYTE, chain[level].data());
+
+    size_t size = getLevelSize(level);
+    HEPTCORE_COUNT(texture_upload_bytes, size);
+
+    // Without sparse storage a level never leaves again, neither does the sparse mip tail
+    if(!sparse || level >= tail_level){
+        chain[level].clear();
+        chain[level].shrink_to_fit();
+    }
+
+    setResidentLevel(level);
+    HEPTCORE_RECORD(textureData(texture, TYPE));
+    return size;
+}
+
+void StreamingTexture2D::endFrame(int drop_delay){
+    if(levels == 0) return; // Failed to load, there is nothing to stream
+    wanted_level = requested_level;
+    requested_level = levels - 1; // Textures nobody asks for only need the coarsest level
+
+    if(!sparse || resident_level >= wanted_level || resident_level >= tail_level){
+        unneeded_frames = 0;
+        return;
+    }
+    if(++unneeded_frames < drop_delay) return;
+
+    // Base level first, nothing may sample the pages once they are gone
+    int dropped = resident_level;
+    setResidentLevel(dropped + 1);
+    commit(dropped, false);
+
+    unneeded_frames = 0;
+}
+
+void StreamingTexture2D::requestLevel(int level){
+    if(levels == 0) return;
+    requested_level = std::min(requested_level, std::clamp(level, 0, levels - 1));
+}
+
+void StreamingTexture2D::requestScreenSize(float pixels_wide, float pixels_high){
+    if(pixels_wide <= 0 || pixels_high <= 0) return;
+
+    float texels_per_pixel = std::max(width / pixels_wide, height / pixels_high);
+    requestLevel(texels_per_pixel <= 1.0f ? 0 : (int) floor(log2(texels_per_pixel)));
+}
+
+void TextureStreamer::add(StreamingTexture2D* texture){
+    if(std::find(textures.begin(), textures.end(), texture) == textures.end()) textures.push_back(texture);
+}
+
+void TextureStreamer::remove(StreamingTexture2D* texture){
+    textures.erase(std::remove(textures.begin(), textures.end(), texture), textures.end());
+}
+
+void TextureStreamer::update(){
+    HEPTCORE_DEBUG_GROUP("TextureStreamer::update");
+
+    std::vector<StreamingTexture2D*> behind = {};
+    for(auto* texture: textures){
+        texture->endFrame(drop_delay);
+        if(texture->resident_level > texture->wanted_level) behind.push_back(texture);
+    }
+
+    std::stable_sort(behind.begin(), behind.end(), [](StreamingTexture2D* a, StreamingTexture2D* b){
+        return a->resident_level - a->wanted_level > b->resident_level - b->wanted_level;
+    });
+
+    // One level per texture and pass, until the budget is used or everything is where it wants to be
+    size_t uploaded = 0;
+    bool progress = true;
+    while(progress){
+        progress = false;
+        for(auto* texture: behind){
+            if(texture->resident_level <= texture->wanted_level) continue;
+
+            // Always allow at least one upload so huge levels still make progress
+            size_t size = texture->getLevelSize(texture->resident_level - 1);
+            if(uploaded > 0 && uploaded + size > upload_budget) continue;
+
+            uploaded += texture->uploadNextLevel();
+            progress = true;
+        }
+    }
+
+    last_upload = uploaded;
+}
@@ -1,30 +1,109 @@
 #include <opengl/texture.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 using namespace Heptcore;
 
-static std::array<uint, 32> texture_bindings = {};
+void Heptcore::bindSampler(int unit, uint sampler){
+    if(unit < 0 || unit >= 32) return;
+    auto& sampler_bindings = ContextState::current().sampler_bindings;
+    if(sampler_bindings[unit] == sampler){
+        HEPTCORE_COUNT(redundant_binds_skipped, 1);
+        return;
+    }
+
+    glBindSampler(unit, sampler);
+    HEPTCORE_COUNT(sampler_binds, 1);
+
+    sampler_bindings[unit] = sampler;
+}
+
+uint Heptcore::getBoundSampler(int unit){
+    if(unit < 0 || unit >= 32) return 0;
+    return ContextState::current().sampler_bindings[unit];
+}
+
+void Heptcore::unbindAllTextures(){
+    ContextState& state = ContextState::current();
+    for(int unit = 0; unit < 32; unit++){
+        if(state.texture_bindings[unit] != 0){
+            glBindTextureUnit(unit, 0);
+            state.texture_bindings[unit] = 0;
+        }
+        if(state.sampler_bindings[unit] != 0) bindSampler(unit, 0);
+    }
+}
+
+static void bindTextureUnit(int unit, uint type, uint texture){
+    auto& texture_bindings = ContextState::current().texture_bindings;
+    if(texture_bindings[unit] == texture){
+        HEPTCORE_COUNT(redundant_binds_skipped, 1);
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(type, texture);
+    HEPTCORE_COUNT(texture_binds, 1);
+
+    texture_bindings[unit] = texture;
+}
+
+/*
+    Dont leave a dangling name in the bind cache, it could be reused by the next texture.
+    Deleting unbinds it from every unit of this context, so the cache only has to follow.
+*/
+static void deleteTexture(uint texture){
+    if(!texture) return; // 0 after a move
+    for(auto& bound: ContextState::current().texture_bindings) if(bound == texture) bound = 0;
+    glDeleteTextures(1, &texture);
+}
 
 BindableTexture::BindableTexture(){
     glGenTextures(1, &this->texture);
 }
 BindableTexture::~BindableTexture(){
-    glDeleteTextures(1, &this->texture);
+    deleteTexture(texture);
+    setMemorySize(0);
+}
+BindableTexture::BindableTexture(BindableTexture&& other) noexcept:
+    texture(std::exchange(other.texture, 0)),
+    TYPE(other.TYPE),
+    memory_size(std::exchange(other.memory_size, 0)){}
+BindableTexture& BindableTexture::operator=(BindableTexture&& other) noexcept{
+    std::swap(texture, other.texture);
+    std::swap(TYPE, other.TYPE);
+    std::swap(memory_size, other.memory_size);
+    return *this;
+}
+void BindableTexture::setMemorySize(size_t bytes){
+    if(memory_size != 0) memoryTracker.free(MEMORY_TEXTURE, memory_size);
+    if(bytes != 0) memoryTracker.allocate(MEMORY_TEXTURE, bytes);
+    memory_size = bytes;
 }
 void BindableTexture::bind(int unit) const{
     if(unit < 0 || unit >= 32) return;
-    if(texture_bindings[unit] == this->texture) return;
+    HEPTCORE_RECORD(bindTexture(texture, TYPE, unit, nullptr));
+    if(getBoundSampler(unit) != 0) bindSampler(unit, 0);
 
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(TYPE, this->texture);
+    bindTextureUnit(unit, TYPE, this->texture);
+}
 
-    texture_bindings[unit] = this->texture;
-}  
+void BindableTexture::bind(int unit, const Sampler& sampler) const{
+    if(unit < 0 || unit >= 32) return;
+    HEPTCORE_RECORD(bindTexture(texture, TYPE, unit, &sampler.getDescription()));
+    bindSampler(unit, sampler.getID());
+
+    bindTextureUnit(unit, TYPE, this->texture);
+}
 
 void BindableTexture::unbind(int unit) const{
     if(unit < 0 || unit >= 32) return;
+    HEPTCORE_RECORD(unbindTexture(texture, TYPE, unit));
+    auto& texture_bindings = ContextState::current().texture_bindings;
     if(texture_bindings[unit] != this->texture) return;
 
     glActiveTexture(GL_TEXTURE0 + unit);
@@ -34,12 +113,53 @@ void BindableTexture::unbind(int unit) const{
 }
 
 void BindableTexture::parameter(int identifier, int value){
+    HEPTCORE_RECORD(textureParameter(texture, TYPE, identifier, value));
     glTexParameteri(TYPE, identifier, value);
 }
 
 uint BindableTexture::getType() const {return TYPE;}
 uint BindableTexture::getID() const {return texture;}
 
+/*
+    2x2 box filter of an RGBA8 image, odd edges reuse the last texel
+*/
+static std::vector<unsigned char> downsample(const std::vector<unsigned char>& source, int width, int height){
+    int target_width = std::max(1, width / 2);
+    int target_height = std::max(1, height / 2);
+
+    std::vector<unsigned char> target((size_t) target_width * target_height * 4);
+
+    for(int y = 0; y < target_height; y++){
+        int y0 = std::min(y * 2, height - 1);
+        int y1 = std::min(y * 2 + 1, height - 1);
+        for(int x = 0; x < target_width; x++){
+            int x0 = std::min(x * 2, width - 1);
+            int x1 = std::min(x * 2 + 1, width - 1);
+
+            for(int c = 0; c < 4; c++){
+                int sum = source[((size_t) y0 * width + x0) * 4 + c] + source[((size_t) y0 * width + x1) * 4 + c]
+                        + source[((size_t) y1 * width + x0) * 4 + c] + source[((size_t) y1 * width + x1) * 4 + c];
+                target[((size_t) y * target_width + x) * 4 + c] = (unsigned char) ((sum + 2) / 4);
+            }
+        }
+    }
+
+    return target;
+}
+
+std::vector<std::vector<unsigned char>> Heptcore::buildMipChain(const unsigned char* data, int width, int height){
+    int levels = (int) floor(log2(fmax(width, height))) + 1;
+
+    std::vector<std::vector<unsigned char>> chain(levels);
+    chain[0].assign(data, data + (size_t) width * height * 4);
+
+    for(int level = 1; level < levels; level++){
+        chain[level] = downsample(chain[level - 1], std::max(1, width >> (level - 1)), std::max(1, height >> (level - 1)));
+    }
+
+    return chain;
+}
+
 void Texture2D::loadData(unsigned char* data, int width, int height, int channels){
     glBindTexture(GL_TEXTURE_2D, this->texture);
 
@@ -56,8 +176,13 @@ void Texture2D::loadData(unsigned char* data, int width, int height, int channel
 
     GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    HEPTCORE_COUNT(texture_upload_bytes, (size_t) width * height * channels);
 
     glGenerateMipmap(GL_TEXTURE_2D);
+
+    int levels = (int) floor(log2(fmax(width, height))) + 1;
+    setMemorySize(textureMemorySize(format, width, height, levels));
+    HEPTCORE_RECORD(textureData(texture, TYPE));
 }
 
 Texture2D::Texture2D(const char* filename): Texture2D(){
@@ -82,6 +207,8 @@ void Texture2D::configure(int storage_type, int color_format, int data_type, int
     bind(0);
 
     glTexImage2D(GL_TEXTURE_2D, 0, storage_type, width, height, 0, color_format, data_type, data );
+    setMemorySize(textureMemorySize(storage_type, width, height));
+    if(data) HEPTCORE_COUNT(texture_upload_bytes, textureMemorySize(storage_type, width, height));
     
     parameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     parameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -89,11 +216,32 @@ void Texture2D::configure(int storage_type, int color_format, int data_type, int
     parameter(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);  
 
     configured = true;
+    HEPTCORE_RECORD(textureData(texture, TYPE));
+}
+
+void Texture2D::setup(int width, int height, int levels, int internal_format){
+    if(configured) reset();
+    bind(0); // Names from glGenTextures only become objects once bound
+
+    // Direct state access from here, doesnt depend on which texture unit is active
+    glTextureStorage2D(this->texture, levels, internal_format, width, height);
+    glTextureParameteri(this->texture, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    setMemorySize(textureMemorySize(internal_format, width, height, levels));
+
+    configured = true;
+    HEPTCORE_RECORD(textureData(texture, TYPE));
+}
+
+void Texture2D::upload(int level, int width, int height, const void* data, int format, int data_type){
+    glTextureSubImage2D(this->texture, level, 0, 0, width, height, format, data_type, data);
+    HEPTCORE_COUNT(texture_upload_bytes, textureMemorySize(format, width, height));
+    HEPTCORE_RECORD(textureData(texture, TYPE));
 }
 
 void Texture2D::reset(){
-    glDeleteTextures(1, &this->texture);
+    deleteTexture(texture);
     glGenTextures(1, &this->texture);
+    setMemorySize(0);
 }
 
 TextureArray2D::TextureArray2D(){
@@ -117,6 +265,7 @@ void TextureArray2D::loadFromFiles(std::vector<std::string>& filenames, int laye
 
     int mipLevels = (int) floor(log2(fmax(layerWidth, layerHeight))) + 1;
     glTexStorage3D(GL_TEXTURE_2D_ARRAY, mipLevels, GL_RGBA8, layerWidth, layerHeight,  size);
+    setMemorySize(textureMemorySize(GL_RGBA8, layerWidth, layerHeight, mipLevels) * size);
 
     int width = 0, height = 0, nrChannels = 0;
     unsigned char *data;  
@@ -127,23 +276,16 @@ void TextureArray2D::loadFromFiles(std::vector<std::string>& filenames, int laye
         if (!data) throw std::runtime_error("Failed to load texture in texture array 2D.\n");
 
         glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, std::min(width, layerWidth), std::min(height, layerHeight), 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        HEPTCORE_COUNT(texture_upload_bytes, (size_t) std::min(width, layerWidth) * std::min(height, layerHeight) * 4);
         stbi_image_free(data);
     }
 
     //CHECK_GL_ERROR();;
 
-    // Set texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_R, GL_REPEAT);
-
-    //CHECK_GL_ERROR();;
-
+    // Wrapping and MAG_FILTER are already set by the constructor, only the mip chain is new
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    HEPTCORE_RECORD(textureData(texture, TYPE));
 
     //CHECK_GL_ERROR();;
 }
@@ -200,6 +342,7 @@ void Skybox::load(std::array<std::string, 6> filenames){
 
     int width = 0, height = 0, nrChannels = 0;
     unsigned char *data = nullptr;  
+    size_t memory = 0;
     for(uint i = 0; i < 6; i++)
     {
         data = stbi_load(filenames[i].c_str(), &width, &height, &nrChannels, 0);
@@ -218,7 +361,11 @@ void Skybox::load(std::array<std::string, 6> filenames){
         GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         stbi_image_free(data);
+
+        memory += textureMemorySize(format, width, height);
+        HEPTCORE_COUNT(texture_upload_bytes, (size_t) width * height * nrChannels);
     }
+    setMemorySize(memory);
 
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -234,6 +381,7 @@ void Skybox::load(std::array<std::string, 6> filenames){
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_DYNAMIC_DRAW);
+    memoryTracker.allocate(MEMORY_BUFFER, sizeof(skyboxVertices));
     
     //CHECK_GL_ERROR();;
 
@@ -251,14 +399,19 @@ void Skybox::load(std::array<std::string, 6> filenames){
 void Skybox::draw(){
     glDepthMask(GL_FALSE);
     glBindVertexArray(this->vao);
+    HEPTCORE_COUNT(vao_binds, 1);
     
     //CHECK_GL_ERROR();;
     
     glBindTexture(GL_TEXTURE_CUBE_MAP, this->texture);
+    HEPTCORE_COUNT(texture_binds, 1);
     
     //CHECK_GL_ERROR();;
 
     glDrawArrays(GL_TRIANGLES, 0, 36);
+    HEPTCORE_COUNT(draw_calls, 1);
+    HEPTCORE_COUNT(vertices, 36);
+    HEPTCORE_COUNT(instances, 1);
     
     //CHECK_GL_ERROR();;
     glBindVertexArray(0);
@@ -266,5 +419,16 @@ void Skybox::draw(){
 }
 Skybox::~Skybox(){
     glDeleteBuffers(1 , &this->vertexBufferID);
+    if(this->vertexBufferID != 0) memoryTracker.free(MEMORY_BUFFER, sizeof(skyboxVertices));
     glDeleteVertexArrays(1, &this->vao);
+}
+Skybox::Skybox(Skybox&& other) noexcept:
+    BindableTexture(std::move(other)),
+    vertexBufferID(std::exchange(other.vertexBufferID, 0)),
+    vao(std::exchange(other.vao, 0)){}
+Skybox& Skybox::operator=(Skybox&& other) noexcept{
+    BindableTexture::operator=(std::move(other));
+    std::swap(vertexBufferID, other.vertexBufferID);
+    std::swap(vao, other.vao);
+    return *this;
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <opengl/texture_atlas.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Heptcore;
+
+TextureAtlas::TextureAtlas(int width, int height, int internal_format, int format): width(width), height(height), internal_format(internal_format), format(format){
+    texture = std::make_unique<Texture2D>();
+    texture->configure(internal_format, format, GL_UNSIGNED_BYTE, width, height);
+    texture->label("TextureAtlas");
+
+    glTextureParameteri(texture->getID(), GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(texture->getID(), GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Fresh storage has undefined contents
+    glClearTexImage(texture->getID(), 0, format, GL_UNSIGNED_BYTE, nullptr);
+}
+
+void TextureAtlas::grow(){
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+    int new_width = width;
+    int new_height = height;
+    // Keep it roughly square, shelves only ever need more height but wider shelves waste less
+    if(height <= width) new_height = height * 2;
+    else new_width = width * 2;
+
+    if(new_width > max_size || new_height > max_size) throw std::runtime_error("Texture atlas cannot grow any further.");
+
+    auto grown = std::make_unique<Texture2D>();
+    grown->configure(internal_format, format, GL_UNSIGNED_BYTE, new_width, new_height);
+    grown->label("TextureAtlas");
+    glTextureParameteri(grown->getID(), GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(grown->getID(), GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glClearTexImage(grown->getID(), 0, format, GL_UNSIGNED_BYTE, nullptr);
+
+    // Gpu side copy, nothing goes through the cpu
+    glCopyImageSubData(texture->getID(), GL_TEXTURE_2D, 0, 0, 0, 0, grown->getID(), GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+
+    // Widening leaves room at the end of every shelf
+    texture = std::move(grown);
+    width = new_width;
+    height = new_height;
+    generation++;
+}
+
+TextureAtlas::Region TextureAtlas::allocate(int region_width, int region_height){
+    int padded_width = region_width + padding;
+    int padded_height = region_height + padding;
+
+    while(true){
+        // Best fitting shelf that has room left
+        Shelf* best = nullptr;
+        for(auto& shelf: shelves){
+            if(shelf.height < padded_height || shelf.x + padded_width > width) continue;
+            if(shelf.height > padded_height * 2) continue; // Dont waste tall shelves on tiny regions
+            if(!best || shelf.height < best->height) best = &shelf;
+        }
+
+        if(best){
+            Region region = {best->x, best->y, region_width, region_height};
+            best->x += padded_width;
+            return region;
+        }
+
+        int next_y = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+        if(next_y + padded_height <= height && padded_width <= width){
+            shelves.push_back({next_y, padded_height, 0});
+            continue;
+        }
+
+        grow();
+    }
+}
+
+void TextureAtlas::upload(const Region& region, const void* data, int data_type){
+    if(region.width == 0 || region.height == 0) return;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(texture->getID(), 0, region.x, region.y, region.width, region.height, format, data_type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    HEPTCORE_COUNT(texture_upload_bytes, (size_t) region.width * region.height * internalFormatSize(internal_format));
+}
+
+void TextureAtlas::clear(){
+    shelves.clear();
+    glClearTexImage(texture->getID(), 0, format, GL_UNSIGNED_BYTE, nullptr);
+}
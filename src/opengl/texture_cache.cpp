@@ -0,0 +1,178 @@
+#include <opengl/texture_cache.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stb_image.h>
+
+using namespace Heptcore;
+
+TextureCache::TextureCache(size_t budget): budget(budget){}
+
+bool TextureCache::load(const std::string& path, Entry& entry){
+    int width = 0, height = 0, channels = 0;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if(!data){
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return false;
+    }
+
+    int levels = (int) floor(log2(fmax(width, height))) + 1;
+    size_t memory = textureMemorySize(GL_RGBA8, width, height, levels);
+
+    makeRoom(memory);
+
+    std::vector<std::vector<unsigned char>> chain = buildMipChain(data, width, height);
+    stbi_image_free(data);
+
+    entry.texture = std::make_unique<Texture2D>();
+    entry.texture->setup(width, height, levels, GL_RGBA8);
+    entry.width = width;
+    entry.height = height;
+    entry.memory = memory;
+
+    // Coarse levels go up right away, the finer ones wait for update()
+    int first_level = std::min(initial_skip_levels, levels - 1);
+    for(int level = levels - 1; level >= first_level; level--){
+        entry.texture->upload(level, std::max(1, width >> level), std::max(1, height >> level), chain[level].data());
+    }
+
+    entry.resident_level = first_level;
+    chain.resize(first_level);
+    entry.pending_levels = std::move(chain);
+
+    uint id = entry.texture->getID();
+    glTextureParameteri(id, GL_TEXTURE_BASE_LEVEL, first_level);
+    glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    resident_memory += memory;
+    return true;
+}
+
+void TextureCache::unload(Entry& entry){
+    if(!entry.texture) return;
+
+    resident_memory -= entry.memory;
+    entry.texture = nullptr;
+    entry.pending_levels.clear();
+    entry.memory = 0;
+}
+
+void TextureCache::erase(std::unordered_map<std::string, Entry>::iterator iterator){
+    unload(iterator->second);
+    lru.erase(iterator->second.lru_position);
+    entries.erase(iterator);
+}
+
+void TextureCache::makeRoom(size_t bytes){
+    // Evict from the least recently used end, but nothing that is used this frame
+    auto position = lru.end();
+    while(resident_memory + bytes > budget && position != lru.begin()){
+        auto candidate = std::prev(position);
+
+        auto iterator = entries.find(*candidate);
+        if(iterator->second.last_used >= frame){
+            position = candidate;
+            continue;
+        }
+
+        erase(iterator); // Only removes candidate, position stays valid
+    }
+
+    if(resident_memory + bytes > budget)
+        std::cerr << "Texture cache over budget: " << (resident_memory + bytes) << " / " << budget << " bytes." << std::endl;
+}
+
+Texture2D* TextureCache::get(const std::string& path){
+    auto iterator = entries.find(path);
+    if(iterator != entries.end()){
+        Entry& entry = iterator->second;
+        lru.splice(lru.begin(), lru, entry.lru_position);
+        entry.last_used = frame;
+        return entry.texture.get();
+    }
+
+    if(failed.contains(path)) return nullptr;
+
+    Entry entry = {};
+    entry.last_used = frame;
+    if(!load(path, entry)){
+        // A missing file would otherwise hit the disk every frame
+        if(failed.size() >= max_failed) failed.clear();
+        failed.insert(path);
+        return nullptr;
+    }
+
+    lru.push_front(path);
+    entry.lru_position = lru.begin();
+    return entries.emplace(path, std::move(entry)).first->second.texture.get();
+}
+
+void TextureCache::update(){
+    HEPTCORE_DEBUG_GROUP("TextureCache::update");
+    size_t uploaded = 0;
+
+    // Most recently used first, they are the most likely to be on screen
+    for(auto& path: lru){
+        Entry& entry = entries.find(path)->second;
+        if(entry.pending_levels.empty()) continue;
+
+        while(entry.resident_level > 0){
+            int level = entry.resident_level - 1;
+            size_t size = entry.pending_levels[level].size();
+
+            // Always allow at least one upload so huge levels still make progress
+            if(uploaded > 0 && uploaded + size > upload_budget) break;
+
+            entry.texture->upload(level, std::max(1, entry.width >> level), std::max(1, entry.height >> level), entry.pending_levels[level].data());
+            glTextureParameteri(entry.texture->getID(), GL_TEXTURE_BASE_LEVEL, level);
+
+            entry.resident_level = level;
+            entry.pending_levels.resize(level);
+            uploaded += size;
+        }
+
+        if(entry.pending_levels.empty()) entry.pending_levels.shrink_to_fit();
+        if(uploaded >= upload_budget) break;
+    }
+
+    frame++;
+}
+
+void TextureCache::evict(const std::string& path){
+    failed.erase(path);
+
+    auto iterator = entries.find(path);
+    if(iterator != entries.end()) erase(iterator);
+}
+
+void TextureCache::clear(){
+    for(auto& [path, entry]: entries) unload(entry);
+    entries.clear();
+    lru.clear();
+    failed.clear();
+}
+
+void TextureCache::setBudget(size_t bytes){
+    budget = bytes;
+    makeRoom(0);
+}
+
+bool TextureCache::isResident(const std::string& path){
+    return entries.contains(path);
+}
+
+bool TextureCache::isFullyResident(const std::string& path){
+    auto iterator = entries.find(path);
+    return iterator != entries.end() && iterator->second.resident_level == 0;
+}
+
+size_t TextureCache::recommendedBudget(float fraction, size_t fallback){
+    size_t available = GpuMemoryTracker::queryAvailableMemory();
+    if(available == 0) return fallback;
+
+    return (size_t) (available * fraction) + resident_memory;
+}
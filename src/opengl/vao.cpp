@@ -7,6 +7,11 @@ VertexFormat::VertexFormat(std::initializer_list<VertexBindingType> bindings, bo
     for(auto& size: bindings) totalSize += size;
 }   
 
+VertexFormat::VertexFormat(const std::vector<VertexBindingType>& bindings, bool per_instance): bindings(bindings), per_instance(per_instance){
+    totalSize = 0;
+    for(auto& size: bindings) totalSize += size;
+}
+
 void VertexFormat::apply(uint& slot){
     size_t stride =  totalSize * sizeof(float);
     size_t size_to_now = 0;
@@ -22,3 +27,29 @@ void VertexFormat::apply(uint& slot){
         slot++;
     }
 }
+
+void VertexArrayObject::draw(uint mode, int first, int count, int instances){
+    HEPTCORE_RECORD(draw(vao_id, mode, first, count, instances));
+    HEPTCORE_RECORD_SUPPRESS();
+
+    bind();
+    if(instances == 1) glDrawArrays(mode, first, count);
+    else glDrawArraysInstanced(mode, first, count, instances);
+
+    HEPTCORE_COUNT(draw_calls, 1);
+    HEPTCORE_COUNT(vertices, (size_t) count * instances);
+    HEPTCORE_COUNT(instances, instances);
+}
+
+void VertexArrayObject::drawIndexed(uint mode, int count, uint index_type, size_t offset, int instances){
+    HEPTCORE_RECORD(drawIndexed(vao_id, mode, count, index_type, offset, instances));
+    HEPTCORE_RECORD_SUPPRESS();
+
+    bind();
+    if(instances == 1) glDrawElements(mode, count, index_type, (void*) offset);
+    else glDrawElementsInstanced(mode, count, index_type, (void*) offset, instances);
+
+    HEPTCORE_COUNT(draw_calls, 1);
+    HEPTCORE_COUNT(vertices, (size_t) count * instances);
+    HEPTCORE_COUNT(instances, instances);
+}
@@ -0,0 +1,305 @@
+#include <render_farm.hpp>
+#include <opengl/debug.hpp>
+#include <opengl/memory.hpp>
+#include <opengl/sampler.hpp>
+#include <opengl/shaders.hpp>
+
+#include <algorithm>
+
+using namespace Heptcore;
+
+void RenderJob::finish(std::exception_ptr error){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->error = error;
+        complete.store(true, std::memory_order_release);
+    }
+    condition.notify_all();
+}
+
+void RenderJob::wait(){
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]{ return complete.load(std::memory_order_acquire); });
+    if(error) std::rethrow_exception(error);
+}
+
+RenderImage& RenderJob::getImage(){
+    wait();
+    return image;
+}
+
+RenderFarm::RenderFarm(RenderFarmSettings settings): settings(settings), owns_glfw(true), loader_state(nullptr, std::make_shared<SamplerCache>()){
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize glfw!" << std::endl;
+        throw std::runtime_error("Failed to initialize glfw!");
+    }
+
+    loader = createContext(nullptr);
+
+    GLFWwindow* previous = glfwGetCurrentContext();
+    ContextState* previous_state = ContextState::setCurrent(&loader_state);
+    glfwMakeContextCurrent(loader);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr  << "Failed to initialize glad!" << std::endl;
+        throw std::runtime_error("Failed to initialize glad!");
+    }
+#if HEPTCORE_CAPTURE
+    installCaptureHooks(); // Before any worker or farm thread exists
+#endif
+    if(settings.debug && !debugOutput.install()) std::cerr << "Failed to create a debug context, debug output is disabled." << std::endl;
+
+    makeContextCurrent(previous, previous_state);
+
+    start();
+}
+
+RenderFarm::RenderFarm(Window& window, RenderFarmSettings settings): settings(settings), owns_glfw(false), loader_state(nullptr, window.getContextState().getSamplerCache()){
+    loader = createContext(window.getHandle());
+    start();
+}
+
+RenderFarm::~RenderFarm(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    condition.notify_all();
+
+    // The threads drain the queue before they stop
+    for(auto& context: contexts) context->thread.join();
+    for(auto& context: contexts) glfwDestroyWindow(context->context);
+    contexts.clear();
+
+    if(owns_glfw){
+        // Nobody else is going to clear the samplers made for the jobs
+        makeContextCurrent(loader, &loader_state);
+        loader_state.getSamplerCache()->clear();
+        makeContextCurrent(nullptr, nullptr);
+    }
+
+    glfwDestroyWindow(loader);
+    if(owns_glfw) glfwTerminate();
+}
+
+GLFWwindow* RenderFarm::createContext(GLFWwindow* share){
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, settings.version_major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, settings.version_minor);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, settings.debug ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* context = glfwCreateWindow(1, 1, "", NULL, share);
+
+    glfwDefaultWindowHints();
+
+    if (!context) {
+        std::cerr << "Failed to create a render farm context!" << std::endl;
+        throw std::runtime_error("Failed to create a render farm context!");
+    }
+    return context;
+}
+
+void RenderFarm::start(){
+    size_t count = settings.contexts;
+    if(count == 0) count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Created up front on this thread (glfw requirement), every thread then only makes its own current
+    for(size_t i = 0; i < count; i++)
+        contexts.push_back(std::make_unique<RenderFarmContext>(i, createContext(loader), std::make_shared<ShaderUniformLinker>(), loader_state.getSamplerCache()));
+
+    for(auto& context: contexts) context->thread = std::thread(&RenderFarm::run, this, std::ref(*context));
+}
+
+void RenderFarm::load(const std::function<void()>& function){
+    GLFWwindow* previous = glfwGetCurrentContext();
+    ContextState* previous_state = ContextState::setCurrent(&loader_state);
+    glfwMakeContextCurrent(loader);
+
+    try{
+        function();
+    }
+    catch(...){
+        glFinish();
+        makeContextCurrent(previous, previous_state);
+        throw;
+    }
+
+    // Other contexts only see complete objects once the commands creating them are done
+    glFinish();
+    makeContextCurrent(previous, previous_state);
+}
+
+std::shared_ptr<RenderJob> RenderFarm::submit(int width, int height, std::function<void(RenderFarmContext&)> function, std::function<void(RenderImage&)> on_complete){
+    if(width <= 0 || height <= 0) throw std::logic_error("Render jobs need a size above 0.");
+
+    auto job = std::make_shared<RenderJob>(width, height, std::move(function), std::move(on_complete));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(job);
+        outstanding++;
+    }
+    condition.notify_one();
+    return job;
+}
+
+void RenderFarm::finish(){
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]{ return outstanding == 0; });
+}
+
+size_t RenderFarm::pending(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return outstanding;
+}
+
+void RenderFarm::run(RenderFarmContext& context){
+    makeContextCurrent(context.context, &context.state);
+    if(settings.debug) debugOutput.install(); // The callback is per context
+
+    size_t in_flight = std::max<size_t>(settings.readbacks_in_flight, 1);
+
+    while(true){
+        collectReadbacks(context, false);
+
+        std::shared_ptr<RenderJob> job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // With readbacks still out dont sleep, they have to be collected
+            if(context.readbacks.empty()) condition.wait(lock, [this]{ return !running || !jobs.empty(); });
+
+            if(!jobs.empty()){
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            else if(!running && context.readbacks.empty()) break;
+        }
+
+        if(!job){
+            collectReadbacks(context, true);
+            continue;
+        }
+
+        if(context.readbacks.size() >= in_flight) collectReadbacks(context, true);
+        render(context, std::move(job));
+    }
+
+    releaseResources(context);
+    makeContextCurrent(nullptr, nullptr);
+}
+
+void RenderFarm::render(RenderFarmContext& context, std::shared_ptr<RenderJob> job){
+    int width = job->image.width;
+    int height = job->image.height;
+
+    // A target that cant be created fails the job like the job itself throwing would, not the thread
+    try{
+        if(!context.target || context.target->getWidth() != width || context.target->getHeight() != height){
+            FramebufferSettings target_settings = {};
+            target_settings.samples = settings.samples;
+            target_settings.depth = settings.depth;
+
+            context.target = nullptr; // Before the new one, the old readbacks are already queued on the gpu
+            context.target = std::make_unique<Framebuffer>(width, height, std::vector<Framebuffer::FramebufferTexture>{{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}}, target_settings);
+        }
+
+        context.target->bind();
+        glViewport(0, 0, width, height);
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        job->function(context);
+    }
+    catch(...){
+        job->function = nullptr;
+        complete(job, std::current_exception());
+        return;
+    }
+    job->function = nullptr;
+
+    context.target->resolve();
+
+    size_t bytes = (size_t) width * height * 4;
+    uint buffer = 0;
+    auto free_buffer = std::find_if(context.free_buffers.begin(), context.free_buffers.end(), [bytes](auto& free){ return free.second == bytes; });
+    if(free_buffer != context.free_buffers.end()){
+        buffer = free_buffer->first;
+        context.free_buffers.erase(free_buffer);
+    }
+    else{
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, bytes, nullptr, 0);
+        memoryTracker.allocate(MEMORY_BUFFER, bytes);
+    }
+
+    // Into the buffer, the copy happens whenever the gpu gets to it
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+    glGetTextureImage(context.target->getTextures()[0].getID(), 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    context.readbacks.push_back({std::move(job), buffer, bytes, fence});
+}
+
+void RenderFarm::collectReadbacks(RenderFarmContext& context, bool wait){
+    while(!context.readbacks.empty()){
+        auto& readback = context.readbacks.front();
+
+        GLenum status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000 : 0);
+        if(status == GL_TIMEOUT_EXPIRED){
+            if(!wait) return;
+            continue;
+        }
+        glDeleteSync(readback.fence);
+
+        RenderImage& image = readback.job->image;
+        image.pixels.resize(readback.bytes);
+        glGetNamedBufferSubData(readback.buffer, 0, readback.bytes, image.pixels.data());
+        context.free_buffers.push_back({readback.buffer, readback.bytes});
+
+        std::shared_ptr<RenderJob> job = std::move(readback.job);
+        context.readbacks.pop_front();
+        complete(job, nullptr);
+
+        wait = false; // Only the oldest one is waited for, the rest only if they are done already
+    }
+}
+
+void RenderFarm::complete(const std::shared_ptr<RenderJob>& job, std::exception_ptr error){
+    if(!error && job->on_complete){
+        try{
+            job->on_complete(job->image);
+        }
+        catch(...){
+            error = std::current_exception();
+        }
+    }
+    job->on_complete = nullptr;
+    job->finish(error);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding--;
+    }
+    idle.notify_all();
+}
+
+void RenderFarm::releaseResources(RenderFarmContext& context){
+    while(!context.readbacks.empty()) collectReadbacks(context, true);
+
+    for(auto& [buffer, bytes]: context.free_buffers){
+        glDeleteBuffers(1, &buffer);
+        memoryTracker.free(MEMORY_BUFFER, bytes);
+    }
+    context.free_buffers.clear();
+
+    // Objects of this context go while it is still current
+    context.locals.clear();
+    context.programs.clear();
+    context.target = nullptr;
+    glFinish();
+}
@@ -0,0 +1,481 @@
+#include <scene/bvh.hpp>
+
+#include <algorithm>
+#include <functional>
+
+#if defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+    #define HEPTCORE_BVH_SSE 1
+#else
+    #define HEPTCORE_BVH_SSE 0
+#endif
+
+using namespace Heptcore;
+
+static constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+static constexpr int SAH_BINS = 16;
+
+/*
+    Per plane, which bound rows give the corner furthest along the normal (positive)
+    and the one furthest against it (negative)
+*/
+struct Bvh::CullPlanes{
+    Frustum frustum;
+    int positive[6][3];
+    int negative[6][3];
+};
+
+/*
+    Binary tree the build makes before it is collapsed into 4 wide nodes
+*/
+struct BuildNode{
+    Aabb box;
+    uint32_t first;
+    uint32_t count;
+    int32_t left = -1;
+    int32_t right = -1;
+};
+
+static void setSlot(BvhNode& node, int slot, const Aabb& box){
+    node.bounds[BVH_MIN_X][slot] = box.min.x;
+    node.bounds[BVH_MIN_Y][slot] = box.min.y;
+    node.bounds[BVH_MIN_Z][slot] = box.min.z;
+    node.bounds[BVH_MAX_X][slot] = box.max.x;
+    node.bounds[BVH_MAX_Y][slot] = box.max.y;
+    node.bounds[BVH_MAX_Z][slot] = box.max.z;
+}
+
+static Aabb getSlot(const BvhNode& node, int slot){
+    return {
+        {node.bounds[BVH_MIN_X][slot], node.bounds[BVH_MIN_Y][slot], node.bounds[BVH_MIN_Z][slot]},
+        {node.bounds[BVH_MAX_X][slot], node.bounds[BVH_MAX_Y][slot], node.bounds[BVH_MAX_Z][slot]}
+    };
+}
+
+static Aabb nodeBounds(const BvhNode& node){
+    Aabb box = Aabb::empty();
+    for(int slot = 0; slot < 4; slot++) if(node.count[slot] > 0) box.grow(getSlot(node, slot));
+    return box;
+}
+
+static BvhNode emptyNode(){
+    BvhNode node = {};
+    // Inverted boxes are outside of every plane, unused slots never pass a test
+    for(int slot = 0; slot < 4; slot++){
+        setSlot(node, slot, Aabb::empty());
+        node.child[slot] = -1;
+    }
+    return node;
+}
+
+/*
+    Binned SAH over the centroids, returns false if the objects cant be split that way
+*/
+static bool findSplit(const std::vector<uint32_t>& order, const std::vector<Aabb>& bounds, const BuildNode& node, size_t max_leaf_size, int& best_axis, float& best_position){
+    Aabb centroids = Aabb::empty();
+    for(uint32_t i = node.first; i < node.first + node.count; i++) centroids.grow(bounds[order[i]].center());
+
+    float best_cost = node.box.surfaceArea() * node.count; // Of not splitting
+    bool must_split = node.count > max_leaf_size;
+    if(must_split) best_cost = 1e30f;
+    best_axis = -1;
+
+    for(int axis = 0; axis < 3; axis++){
+        float low = centroids.min[axis];
+        float extent = centroids.max[axis] - low;
+        if(extent <= 0) continue;
+
+        Aabb bin_boxes[SAH_BINS];
+        uint32_t bin_counts[SAH_BINS] = {};
+        for(auto& box: bin_boxes) box = Aabb::empty();
+
+        float scale = SAH_BINS / extent;
+        for(uint32_t i = node.first; i < node.first + node.count; i++){
+            const Aabb& box = bounds[order[i]];
+            int bin = std::min((int) ((box.center()[axis] - low) * scale), SAH_BINS - 1);
+            bin_boxes[bin].grow(box);
+            bin_counts[bin]++;
+        }
+
+        // Right to left sweep first, then evaluate every split left to right
+        float right_areas[SAH_BINS] = {};
+        uint32_t right_counts[SAH_BINS] = {};
+        Aabb right = Aabb::empty();
+        uint32_t right_count = 0;
+        for(int bin = SAH_BINS - 1; bin > 0; bin--){
+            right.grow(bin_boxes[bin]);
+            right_count += bin_counts[bin];
+            right_areas[bin] = right_count > 0 ? right.surfaceArea() : 0;
+            right_counts[bin] = right_count;
+        }
+
+        Aabb left = Aabb::empty();
+        uint32_t left_count = 0;
+        for(int bin = 0; bin < SAH_BINS - 1; bin++){
+            left.grow(bin_boxes[bin]);
+            left_count += bin_counts[bin];
+            if(left_count == 0 || right_counts[bin + 1] == 0) continue;
+
+            float cost = left.surfaceArea() * left_count + right_areas[bin + 1] * right_counts[bin + 1];
+            if(cost < best_cost){
+                best_cost = cost;
+                best_axis = axis;
+                best_position = low + (bin + 1) / scale;
+            }
+        }
+    }
+
+    return best_axis != -1;
+}
+
+void Bvh::build(const std::vector<Aabb>& bounds){
+    nodes.clear();
+    parents.clear();
+    dirty.clear();
+    node_dirty.clear();
+
+    order.resize(bounds.size());
+    for(uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    object_nodes.assign(bounds.size(), NO_NODE);
+
+    if(bounds.empty()){
+        ordered_bounds.clear();
+        positions.clear();
+        return;
+    }
+
+    // Binary SAH tree
+    std::vector<BuildNode> build = {};
+    build.reserve(bounds.size() * 2 / std::max(max_leaf_size, (size_t) 1) + 1);
+    build.push_back({Aabb::empty(), 0, (uint32_t) bounds.size()});
+
+    std::vector<uint32_t> stack = {0};
+    while(!stack.empty()){
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        BuildNode node = build[index];
+        node.box = Aabb::empty();
+        for(uint32_t i = node.first; i < node.first + node.count; i++) node.box.grow(bounds[order[i]]);
+        build[index].box = node.box;
+
+        if(node.count <= 1) continue;
+
+        int axis = 0;
+        float position = 0;
+        uint32_t split = 0;
+
+        if(findSplit(order, bounds, node, max_leaf_size, axis, position)){
+            auto middle = std::partition(order.begin() + node.first, order.begin() + node.first + node.count,
+                [&](uint32_t object){ return bounds[object].center()[axis] < position; });
+            split = middle - order.begin();
+        }
+        else if(node.count > max_leaf_size) split = node.first + node.count / 2; // Every centroid in the same spot
+        else continue; // Cheaper as a leaf
+
+        if(split == node.first || split == node.first + node.count) split = node.first + node.count / 2;
+
+        int32_t left = build.size();
+        build.push_back({Aabb::empty(), node.first, split - node.first});
+        build.push_back({Aabb::empty(), split, node.first + node.count - split});
+        build[index].left = left;
+        build[index].right = left + 1;
+
+        stack.push_back(left + 1);
+        stack.push_back(left);
+    }
+
+    // Collapse into 4 wide nodes, depth first so children come after their parent
+    nodes.reserve(build.size() / 3 + 1);
+    std::function<uint32_t(uint32_t, uint32_t)> emit = [&](uint32_t build_index, uint32_t parent) -> uint32_t{
+        uint32_t index = nodes.size();
+        nodes.push_back(emptyNode());
+        parents.push_back(parent);
+
+        uint32_t slots[4] = {build_index};
+        int used = 1;
+        if(build[build_index].left >= 0){
+            slots[0] = build[build_index].left;
+            slots[1] = build[build_index].right;
+            used = 2;
+        }
+
+        // Keep opening the largest inner child until all four slots are in use
+        while(used < 4){
+            int largest = -1;
+            float largest_area = -1;
+            for(int slot = 0; slot < used; slot++){
+                const BuildNode& candidate = build[slots[slot]];
+                if(candidate.left < 0 || candidate.box.surfaceArea() <= largest_area) continue;
+                largest = slot;
+                largest_area = candidate.box.surfaceArea();
+            }
+            if(largest == -1) break;
+
+            uint32_t opened = slots[largest];
+            slots[largest] = build[opened].left;
+            slots[used++] = build[opened].right;
+        }
+
+        for(int slot = 0; slot < used; slot++){
+            const BuildNode& child = build[slots[slot]];
+
+            setSlot(nodes[index], slot, child.box);
+            nodes[index].first[slot] = child.first;
+            nodes[index].count[slot] = child.count;
+
+            if(child.left < 0){
+                for(uint32_t i = child.first; i < child.first + child.count; i++) object_nodes[order[i]] = index;
+                continue;
+            }
+
+            uint32_t child_index = emit(slots[slot], index);
+            nodes[index].child[slot] = child_index;
+        }
+
+        return index;
+    };
+    emit(0, NO_NODE);
+
+    ordered_bounds.resize(order.size());
+    positions.resize(order.size());
+    for(uint32_t i = 0; i < order.size(); i++){
+        ordered_bounds[i] = bounds[order[i]];
+        positions[order[i]] = i;
+    }
+
+    node_dirty.assign(nodes.size(), 0);
+}
+
+void Bvh::update(uint object, const Aabb& bounds){
+    ordered_bounds[positions[object]] = bounds;
+
+    for(uint32_t node = object_nodes[object]; node != NO_NODE && !node_dirty[node]; node = parents[node]){
+        node_dirty[node] = 1;
+        dirty.push_back(node);
+    }
+}
+
+void Bvh::refit(){
+    if(dirty.empty()) return;
+
+    // Children have higher indices than their parents
+    std::sort(dirty.begin(), dirty.end(), std::greater<uint32_t>());
+
+    for(uint32_t index: dirty){
+        BvhNode& node = nodes[index];
+
+        for(int slot = 0; slot < 4; slot++){
+            if(node.count[slot] == 0) continue;
+
+            Aabb box = Aabb::empty();
+            if(node.child[slot] < 0){
+                for(uint32_t i = node.first[slot]; i < node.first[slot] + node.count[slot]; i++) box.grow(ordered_bounds[i]);
+            }
+            else box = nodeBounds(nodes[node.child[slot]]);
+
+            setSlot(node, slot, box);
+        }
+
+        node_dirty[index] = 0;
+    }
+
+    dirty.clear();
+}
+
+/*
+    visible: slots at least partially inside every plane, inside: slots completely inside every plane
+*/
+static void testNode(const BvhNode& node, const int positive[6][3], const int negative[6][3], const Frustum& frustum, uint32_t& visible, uint32_t& inside){
+#if HEPTCORE_BVH_SSE
+    __m128 outside_mask = _mm_setzero_ps();
+    __m128 crossing_mask = _mm_setzero_ps();
+    const __m128 zero = _mm_setzero_ps();
+
+    for(int i = 0; i < 6; i++){
+        const glm::vec4& plane = frustum.planes[i];
+        __m128 x = _mm_set1_ps(plane.x);
+        __m128 y = _mm_set1_ps(plane.y);
+        __m128 z = _mm_set1_ps(plane.z);
+        __m128 w = _mm_set1_ps(plane.w);
+
+        __m128 furthest = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(x, _mm_load_ps(node.bounds[positive[i][0]])), _mm_mul_ps(y, _mm_load_ps(node.bounds[positive[i][1]]))),
+            _mm_add_ps(_mm_mul_ps(z, _mm_load_ps(node.bounds[positive[i][2]])), w));
+        __m128 nearest = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(x, _mm_load_ps(node.bounds[negative[i][0]])), _mm_mul_ps(y, _mm_load_ps(node.bounds[negative[i][1]]))),
+            _mm_add_ps(_mm_mul_ps(z, _mm_load_ps(node.bounds[negative[i][2]])), w));
+
+        outside_mask = _mm_or_ps(outside_mask, _mm_cmplt_ps(furthest, zero));
+        crossing_mask = _mm_or_ps(crossing_mask, _mm_cmplt_ps(nearest, zero));
+    }
+
+    visible = ~_mm_movemask_ps(outside_mask) & 0xF;
+    inside = visible & ~_mm_movemask_ps(crossing_mask);
+#else
+    visible = 0;
+    inside = 0;
+    for(int slot = 0; slot < 4; slot++){
+        bool outside = false;
+        bool crossing = false;
+        for(int i = 0; i < 6; i++){
+            const glm::vec4& plane = frustum.planes[i];
+            float furthest = plane.x * node.bounds[positive[i][0]][slot] + plane.y * node.bounds[positive[i][1]][slot] + plane.z * node.bounds[positive[i][2]][slot] + plane.w;
+            float nearest = plane.x * node.bounds[negative[i][0]][slot] + plane.y * node.bounds[negative[i][1]][slot] + plane.z * node.bounds[negative[i][2]][slot] + plane.w;
+            outside |= furthest < 0;
+            crossing |= nearest < 0;
+        }
+        if(outside) continue;
+        visible |= 1u << slot;
+        if(!crossing) inside |= 1u << slot;
+    }
+#endif
+}
+
+int Bvh::visitNode(uint32_t index, const CullPlanes& planes, std::vector<uint>& visible, uint32_t descend[4]) const{
+    const BvhNode& node = nodes[index];
+
+    uint32_t visible_slots = 0;
+    uint32_t inside_slots = 0;
+    testNode(node, planes.positive, planes.negative, planes.frustum, visible_slots, inside_slots);
+
+    int descending = 0;
+    for(int slot = 0; slot < 4; slot++){
+        if(!(visible_slots & (1u << slot))) continue;
+
+        uint32_t first = node.first[slot];
+        uint32_t count = node.count[slot];
+
+        // Everything below is inside, no need to look any further
+        if(inside_slots & (1u << slot)){
+            visible.insert(visible.end(), order.begin() + first, order.begin() + first + count);
+            continue;
+        }
+
+        if(node.child[slot] >= 0){
+            descend[descending++] = node.child[slot];
+            continue;
+        }
+
+        for(uint32_t i = first; i < first + count; i++)
+            if(planes.frustum.intersects(ordered_bounds[i])) visible.push_back(order[i]);
+    }
+
+    return descending;
+}
+
+void Bvh::cullSubtree(uint32_t root, const CullPlanes& planes, std::vector<uint>& visible) const{
+    std::vector<uint32_t> stack = {root};
+    stack.reserve(64);
+
+    uint32_t descend[4];
+    while(!stack.empty()){
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        int count = visitNode(index, planes, visible, descend);
+        for(int i = 0; i < count; i++) stack.push_back(descend[i]);
+    }
+}
+
+static void preparePlanes(const Frustum& frustum, int positive[6][3], int negative[6][3]){
+    for(int i = 0; i < 6; i++){
+        const glm::vec4& plane = frustum.planes[i];
+        float normal[3] = {plane.x, plane.y, plane.z};
+        for(int axis = 0; axis < 3; axis++){
+            positive[i][axis] = normal[axis] > 0 ? BVH_MAX_X + axis : BVH_MIN_X + axis;
+            negative[i][axis] = normal[axis] > 0 ? BVH_MIN_X + axis : BVH_MAX_X + axis;
+        }
+    }
+}
+
+void Bvh::cull(const Frustum& frustum, std::vector<uint>& visible) const{
+    visible.clear();
+    if(nodes.empty()) return;
+
+    CullPlanes planes = {frustum, {}, {}};
+    preparePlanes(frustum, planes.positive, planes.negative);
+
+    cullSubtree(0, planes, visible);
+}
+
+void Bvh::cull(const Frustum& frustum, std::vector<uint>& visible, ThreadPool& pool) const{
+    if(pool.getThreadCount() == 0){
+        cull(frustum, visible);
+        return;
+    }
+
+    visible.clear();
+    if(nodes.empty()) return;
+
+    CullPlanes planes = {frustum, {}, {}};
+    preparePlanes(frustum, planes.positive, planes.negative);
+
+    // Breadth first until there are plenty more subtrees than threads, stealing evens out their sizes
+    size_t target = (pool.getThreadCount() + 1) * 8;
+    std::vector<uint32_t> frontier = {0};
+    size_t next = 0;
+
+    uint32_t descend[4];
+    while(next < frontier.size() && frontier.size() - next < target){
+        int count = visitNode(frontier[next++], planes, visible, descend);
+        for(int i = 0; i < count; i++) frontier.push_back(descend[i]);
+    }
+
+    size_t subtrees = frontier.size() - next;
+    std::vector<std::vector<uint>> results(subtrees);
+
+    TaskGroup group = {};
+    for(size_t i = 0; i < subtrees; i++)
+        pool.run(group, [this, &planes, &results, &frontier, next, i]{ cullSubtree(frontier[next + i], planes, results[i]); });
+    pool.wait(group);
+
+    size_t total = visible.size();
+    for(auto& result: results) total += result.size();
+    visible.reserve(total);
+    for(auto& result: results) visible.insert(visible.end(), result.begin(), result.end());
+}
+
+float Bvh::getSahCost() const{
+    if(nodes.empty()) return 0;
+
+    float root_area = nodeBounds(nodes[0]).surfaceArea();
+    if(root_area <= 0) return 0;
+
+    float cost = 0;
+    for(auto& node: nodes){
+        for(int slot = 0; slot < 4; slot++){
+            if(node.count[slot] == 0) continue;
+            float area = getSlot(node, slot).surfaceArea();
+            cost += node.child[slot] < 0 ? area * node.count[slot] : area;
+        }
+    }
+
+    return cost / root_area;
+}
+
+void Heptcore::groupVisible(const std::vector<uint>& visible, const std::vector<uint>& object_keys, uint key_count,
+    std::vector<uint>& grouped, std::vector<VisibleBatch>& batches){
+    std::vector<uint> offsets(key_count + 1, 0);
+    for(uint object: visible) offsets[object_keys[object] + 1]++;
+    for(uint key = 0; key < key_count; key++) offsets[key + 1] += offsets[key];
+
+    batches.clear();
+    for(uint key = 0; key < key_count; key++){
+        uint count = offsets[key + 1] - offsets[key];
+        if(count > 0) batches.push_back({key, offsets[key], count});
+    }
+
+    grouped.resize(visible.size());
+    for(uint object: visible) grouped[offsets[object_keys[object]]++] = object;
+}
+
+void Heptcore::buildIndirectCommands(const std::vector<VisibleBatch>& batches, const std::vector<DrawElementsIndirectCommand>& key_commands,
+    std::vector<DrawElementsIndirectCommand>& commands){
+    commands.resize(batches.size());
+    for(size_t i = 0; i < batches.size(); i++){
+        commands[i] = key_commands[batches[i].key];
+        commands[i].instance_count = batches[i].count;
+        commands[i].base_instance = batches[i].first;
+    }
+}
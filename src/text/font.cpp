@@ -0,0 +1,149 @@
+#include <text/font.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+using namespace Heptcore;
+
+/*
+    Decodes one codepoint and advances position, invalid sequences become U+FFFD
+*/
+static uint32_t decodeUTF8(const std::string& text, size_t& position){
+    unsigned char lead = (unsigned char) text[position++];
+    if(lead < 0x80) return lead;
+
+    int length = 0;
+    uint32_t codepoint = 0;
+    if((lead & 0xE0) == 0xC0){ length = 1; codepoint = lead & 0x1F; }
+    else if((lead & 0xF0) == 0xE0){ length = 2; codepoint = lead & 0x0F; }
+    else if((lead & 0xF8) == 0xF0){ length = 3; codepoint = lead & 0x07; }
+    else return 0xFFFD;
+
+    for(int i = 0; i < length; i++){
+        if(position >= text.size() || ((unsigned char) text[position] & 0xC0) != 0x80) return 0xFFFD;
+        codepoint = (codepoint << 6) | ((unsigned char) text[position++] & 0x3F);
+    }
+
+    return codepoint;
+}
+
+Font::Font(const std::string& filename, TextureAtlas& atlas, int base_size, int spread): atlas(atlas), base_size(base_size), spread(spread){
+    if(FT_Init_FreeType(&library)) throw std::runtime_error("Failed to initialize FreeType.");
+
+    if(FT_New_Face(library, filename.c_str(), 0, &face)){
+        FT_Done_FreeType(library);
+        std::cerr << "Failed to load font: " << filename << std::endl;
+        throw std::runtime_error("Failed to load font: " + filename);
+    }
+
+    FT_Set_Pixel_Sizes(face, 0, base_size);
+
+    // Both sdf renderers default to a spread of 2 which is too little for scaling up
+    FT_Property_Set(library, "sdf", "spread", &this->spread);
+    FT_Property_Set(library, "bsdf", "spread", &this->spread);
+}
+
+Font::~Font(){
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+}
+
+Font::Glyph Font::rasterize(uint32_t codepoint){
+    Glyph glyph = {};
+
+    FT_UInt index = FT_Get_Char_Index(face, codepoint);
+    if(FT_Load_Glyph(face, index, FT_LOAD_DEFAULT)) return glyph;
+
+    glyph.advance = (float) (face->glyph->advance.x >> 6);
+
+    if(sdf && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF)){
+        // FreeType built without the sdf module, fall back to coverage for the whole font
+        std::cerr << "Font has no signed distance field support, falling back to coverage." << std::endl;
+        sdf = false;
+    }
+    if(!sdf && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL)) return glyph;
+
+    FT_Bitmap& bitmap = face->glyph->bitmap;
+    glyph.bearing_x = (float) face->glyph->bitmap_left;
+    glyph.bearing_y = (float) face->glyph->bitmap_top;
+
+    if(bitmap.width == 0 || bitmap.rows == 0) return glyph; // Spaces and such
+
+    glyph.region = atlas.allocate((int) bitmap.width, (int) bitmap.rows);
+
+    if(bitmap.pitch == (int) bitmap.width) atlas.upload(glyph.region, bitmap.buffer);
+    else{
+        std::vector<unsigned char> packed((size_t) bitmap.width * bitmap.rows);
+        for(unsigned int row = 0; row < bitmap.rows; row++){
+            const unsigned char* source = bitmap.pitch > 0 ? bitmap.buffer + row * bitmap.pitch : bitmap.buffer + (bitmap.rows - 1 - row) * -bitmap.pitch;
+            std::copy(source, source + bitmap.width, packed.begin() + (size_t) row * bitmap.width);
+        }
+        atlas.upload(glyph.region, packed.data());
+    }
+
+    return glyph;
+}
+
+const Font::Glyph& Font::getGlyph(uint32_t codepoint){
+    auto iterator = glyphs.find(codepoint);
+    if(iterator != glyphs.end()) return iterator->second;
+
+    return glyphs.emplace(codepoint, rasterize(codepoint)).first->second;
+}
+
+const Font::ShapedRun& Font::shape(const std::string& text){
+    auto iterator = runs.find(text);
+    if(iterator != runs.end()) return iterator->second;
+
+    if(runs.size() >= max_cached_runs) runs.clear(); // Text that changes every frame shouldnt grow this forever, invalidates earlier results
+
+    ShapedRun run = {};
+    float line_height = getLineHeight();
+    float pen_x = 0;
+    float pen_y = 0;
+    FT_UInt previous = 0;
+    bool kerning = FT_HAS_KERNING(face);
+
+    size_t position = 0;
+    while(position < text.size()){
+        uint32_t codepoint = decodeUTF8(text, position);
+
+        if(codepoint == '\n'){
+            run.width = std::max(run.width, pen_x);
+            pen_x = 0;
+            pen_y += line_height;
+            previous = 0;
+            continue;
+        }
+
+        FT_UInt index = FT_Get_Char_Index(face, codepoint);
+        if(kerning && previous && index){
+            FT_Vector delta = {0, 0};
+            FT_Get_Kerning(face, previous, index, FT_KERNING_DEFAULT, &delta);
+            pen_x += (float) (delta.x >> 6);
+        }
+        previous = index;
+
+        const Glyph& glyph = getGlyph(codepoint);
+        run.glyphs.push_back({codepoint, pen_x, pen_y});
+        pen_x += glyph.advance;
+    }
+
+    run.width = std::max(run.width, pen_x);
+    run.height = pen_y + line_height;
+
+    return runs.emplace(text, std::move(run)).first->second;
+}
+
+float Font::getLineHeight(){
+    return (float) (face->size->metrics.height >> 6);
+}
+
+float Font::getAscender(){
+    return (float) (face->size->metrics.ascender >> 6);
+}
@@ -0,0 +1,151 @@
+#include <text/text_renderer.hpp>
+
+#include <algorithm>
+
+using namespace Heptcore;
+
+static const char* text_vertex_source = R"(
+#version 450 core
+layout (location = 0) in vec2 aPosition;
+layout (location = 1) in vec2 aUV;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in float aSDF;
+
+uniform vec2 screenSize;
+
+out vec2 uv;
+out vec4 color;
+out float sdf;
+
+void main(){
+    vec2 ndc = aPosition / screenSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    uv = aUV;
+    color = aColor;
+    sdf = aSDF;
+}
+)";
+
+static const char* text_fragment_source = R"(
+#version 450 core
+in vec2 uv;
+in vec4 color;
+in float sdf;
+
+uniform sampler2D atlas;
+
+out vec4 FragColor;
+
+void main(){
+    // Texture coordinates are in atlas pixels so the atlas can grow without touching queued vertices
+    float value = texture(atlas, uv / vec2(textureSize(atlas, 0))).r;
+
+    float alpha = value;
+    if(sdf > 0.5){
+        // 0.5 is the glyph edge, fwidth keeps the edge about one screen pixel wide at any scale
+        float width = max(fwidth(value) * 0.75, 1e-4);
+        alpha = smoothstep(0.5 - width, 0.5 + width, value);
+    }
+
+    if(alpha <= 0.0) discard;
+    FragColor = vec4(color.rgb, color.a * alpha);
+}
+)";
+
+TextRenderer::TextRenderer(){
+    program.addShaderSource(text_vertex_source, GL_VERTEX_SHADER);
+    program.addShaderSource(text_fragment_source, GL_FRAGMENT_SHADER);
+    program.compile();
+
+    program.setSamplerSlot("atlas", 0);
+    screen_size_location = program.getUniformLocation("screenSize");
+    uniformLinker().ignore("screenSize");
+
+    vertex_buffer.initialize(6 * 9 * 256);
+    vao.attachBuffer(&vertex_buffer, {VEC2, VEC2, VEC4, FLOAT});
+
+    program.label("TextRenderer program");
+    vertex_buffer.label("TextRenderer vertices");
+    vao.label("TextRenderer vao");
+}
+
+Font& TextRenderer::loadFont(const std::string& filename, int base_size){
+    fonts.push_back(std::make_unique<Font>(filename, atlas, base_size));
+    return *fonts.back();
+}
+
+void TextRenderer::pushVertex(float x, float y, float u, float v, const glm::vec4& color, float sdf){
+    vertices.insert(vertices.end(), {x, y, u, v, color.x, color.y, color.z, color.w, sdf});
+}
+
+void TextRenderer::add(Font& font, const std::string& text, glm::vec2 position, float size, glm::vec4 color){
+    const Font::ShapedRun& run = font.shape(text);
+
+    float scale = size / font.getLineHeight();
+    float baseline = position.y + font.getAscender() * scale;
+    float sdf = font.isSDF() ? 1.0f : 0.0f;
+
+    vertices.reserve(vertices.size() + run.glyphs.size() * 6 * 9);
+
+    for(auto& shaped: run.glyphs){
+        const Font::Glyph& glyph = font.getGlyph(shaped.codepoint);
+        if(glyph.region.width == 0 || glyph.region.height == 0) continue;
+
+        float x0 = position.x + (shaped.x + glyph.bearing_x) * scale;
+        float y0 = baseline + (shaped.y - glyph.bearing_y) * scale;
+        float x1 = x0 + glyph.region.width * scale;
+        float y1 = y0 + glyph.region.height * scale;
+
+        float u0 = (float) glyph.region.x;
+        float v0 = (float) glyph.region.y;
+        float u1 = u0 + glyph.region.width;
+        float v1 = v0 + glyph.region.height;
+
+        pushVertex(x0, y0, u0, v0, color, sdf);
+        pushVertex(x1, y0, u1, v0, color, sdf);
+        pushVertex(x0, y1, u0, v1, color, sdf);
+
+        pushVertex(x1, y0, u1, v0, color, sdf);
+        pushVertex(x1, y1, u1, v1, color, sdf);
+        pushVertex(x0, y1, u0, v1, color, sdf);
+    }
+}
+
+void TextRenderer::render(int screen_width, int screen_height){
+    if(vertices.empty()) return;
+
+    HEPTCORE_DEBUG_GROUP("TextRenderer::render");
+
+    // Grow geometrically so a slowly growing amount of text doesnt reallocate every frame
+    if(vertices.size() > vertex_buffer.size()) vertex_buffer.initialize(std::max(vertices.size(), vertex_buffer.size() * 2), vertices.data());
+    else vertex_buffer.insert(0, vertices.size(), vertices.data());
+
+    GLboolean blend_enabled = glIsEnabled(GL_BLEND);
+    GLboolean depth_enabled = glIsEnabled(GL_DEPTH_TEST);
+    GLint blend_source_rgb = 0, blend_destination_rgb = 0;
+    GLint blend_source_alpha = 0, blend_destination_alpha = 0;
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blend_source_rgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blend_destination_rgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_source_alpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_destination_alpha);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+
+    program.use();
+    glUniform2f(screen_size_location, (float) screen_width, (float) screen_height);
+    HEPTCORE_COUNT(uniform_uploads, 1);
+
+    atlas.getTexture().bind(0);
+
+    size_t vertex_count = vertices.size() / 9;
+    vao.draw(GL_TRIANGLES, 0, (int) vertex_count);
+    vao.unbind();
+
+    glBlendFuncSeparate(blend_source_rgb, blend_destination_rgb, blend_source_alpha, blend_destination_alpha);
+    if(!blend_enabled) glDisable(GL_BLEND);
+    if(depth_enabled) glEnable(GL_DEPTH_TEST);
+
+    vertices.clear();
+}
@@ -0,0 +1,120 @@
+#include <thread_pool.hpp>
+
+#include <algorithm>
+
+using namespace Heptcore;
+
+// Pool and queue of the worker thread that is running, nullptr on threads outside any pool
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local size_t current_index = 0;
+
+ThreadPool::ThreadPool(size_t thread_count){
+    for(size_t i = 0; i < thread_count + 1; i++) queues.push_back(std::make_unique<Queue>());
+
+    threads.reserve(thread_count);
+    for(size_t i = 0; i < thread_count; i++) threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        running.store(false, std::memory_order_release);
+    }
+    sleep.notify_all();
+
+    for(auto& thread: threads) thread.join();
+}
+
+size_t ThreadPool::currentQueue(){
+    return current_pool == this ? current_index : queues.size() - 1;
+}
+
+void ThreadPool::run(TaskGroup& group, std::function<void()> function){
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    Queue& queue = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back({std::move(function), &group});
+    }
+    queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock makes sure a worker that just found nothing is already waiting and gets the notification
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    sleep.notify_one();
+}
+
+bool ThreadPool::take(size_t index, Task& task){
+    if(queued.load(std::memory_order_acquire) == 0) return false;
+
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()){
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for(size_t offset = 1; offset < queues.size(); offset++){
+        Queue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(victim.tasks.empty()) continue;
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::execute(Task& task){
+    try{
+        task.function();
+    }
+    catch(...){
+        std::lock_guard<std::mutex> lock(task.group->mutex);
+        if(!task.group->error) task.group->error = std::current_exception();
+    }
+
+    task.function = nullptr;
+    task.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::workerLoop(size_t index){
+    current_pool = this;
+    current_index = index;
+
+    Task task = {};
+    while(true){
+        if(take(index, task)){
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep.wait(lock, [this]{ return !running.load(std::memory_order_acquire) || queued.load(std::memory_order_acquire) > 0; });
+        if(!running.load(std::memory_order_acquire)) break;
+    }
+}
+
+void ThreadPool::wait(TaskGroup& group){
+    size_t index = currentQueue();
+
+    Task task = {};
+    while(!group.isDone()){
+        if(take(index, task)) execute(task);
+        else std::this_thread::yield();
+    }
+
+    std::exception_ptr error = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        std::swap(error, group.error);
+    }
+    if(error) std::rethrow_exception(error);
+}
@@ -1,8 +1,13 @@
 #include <window.hpp>
+#include <opengl/capture.hpp>
 
 using namespace Heptcore;
 
-Window::Window(int width, int height, std::string title){
+static Window* owner(GLFWwindow* handle){
+    return static_cast<Window*>(glfwGetWindowUserPointer(handle));
+}
+
+Window::Window(int width, int height, std::string title, WindowSettings settings): settings(settings), input_queue(settings.input_queue_size){
     /* Initialize the library */
     if (!glfwInit()) {
         std::cerr << "Failed to initialize glfw!" << std::endl;
@@ -10,16 +15,22 @@ Window::Window(int width, int height, std::string title){
         return;
     }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    applyContextHints();
 
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_SAMPLES, settings.samples);
+    glfwWindowHint(GLFW_VISIBLE, settings.visible ? GLFW_TRUE : GLFW_FALSE);
     
     ///glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_FALSE);
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(width, height, title.c_str(), NULL, NULL);
 
+    if(!window && this->settings.version_major == 4 && this->settings.version_minor > 5){
+        // Worker contexts are created with the same settings, so they fall back along with it
+        this->settings.version_minor = 5;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, this->settings.version_minor);
+        window = glfwCreateWindow(width, height, title.c_str(), NULL, NULL);
+    }
+
     if (!window) {
         std::cerr << "Failed to initialize glfw window!" << std::endl;
         glfwTerminate();
@@ -27,8 +38,8 @@ Window::Window(int width, int height, std::string title){
         return;
     }
     
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(0);
+    makeContextCurrent(window, &state);
+    glfwSwapInterval(settings.vsync ? 1 : 0);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -36,24 +47,167 @@ Window::Window(int width, int height, std::string title){
         throw std::runtime_error("Failed to initialize glad!");
         return;
     }
+#if HEPTCORE_CAPTURE
+    installCaptureHooks(); // Before any worker or farm thread exists
+#endif
+
+    if(settings.debug && !debugOutput.install()) std::cerr << "Failed to create a debug context, debug output is disabled." << std::endl;
+
+    event_thread = std::this_thread::get_id();
+    installCallbacks();
+
+    int framebuffer_width = 0, framebuffer_height = 0;
+    glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+    input.apply({INPUT_FRAMEBUFFER_SIZE, glfwGetTime(), 0, 0, 0, 0, glm::dvec2(framebuffer_width, framebuffer_height)});
+    input.takeResize();
 
     //std::cout << "OpenGL version: " << glGetString(GL_VERSION) << std::endl;
 }
 
+void Window::installCallbacks(){
+    glfwSetWindowUserPointer(window, this);
+
+    // Runs on the event thread, all it does is timestamp and queue
+    glfwSetKeyCallback(window, [](GLFWwindow* handle, int key, int scancode, int action, int mods){
+        owner(handle)->queueInput({INPUT_KEY, glfwGetTime(), key, scancode, action, mods});
+    });
+    glfwSetCharCallback(window, [](GLFWwindow* handle, unsigned int codepoint){
+        owner(handle)->queueInput({INPUT_CHARACTER, glfwGetTime(), (int) codepoint});
+    });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* handle, int button, int action, int mods){
+        owner(handle)->queueInput({INPUT_MOUSE_BUTTON, glfwGetTime(), button, 0, action, mods});
+    });
+    glfwSetCursorPosCallback(window, [](GLFWwindow* handle, double x, double y){
+        owner(handle)->queueInput({INPUT_CURSOR, glfwGetTime(), 0, 0, 0, 0, glm::dvec2(x, y)});
+    });
+    glfwSetScrollCallback(window, [](GLFWwindow* handle, double x, double y){
+        owner(handle)->queueInput({INPUT_SCROLL, glfwGetTime(), 0, 0, 0, 0, glm::dvec2(x, y)});
+    });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* handle, int width, int height){
+        owner(handle)->queueInput({INPUT_FRAMEBUFFER_SIZE, glfwGetTime(), 0, 0, 0, 0, glm::dvec2(width, height)});
+    });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* handle, int focused){
+        owner(handle)->queueInput({INPUT_FOCUS, glfwGetTime(), 0, 0, focused});
+    });
+}
+
+void Window::queueInput(const InputEvent& event){
+    if(!input_queue.push(event)) dropped_input.fetch_add(1, std::memory_order_relaxed);
+}
+
+InputState& Window::sampleInput(){
+    InputEvent event;
+    while(input_queue.pop(event)) input.apply(event);
+    return input;
+}
+
+bool Window::pollInput(InputEvent& event){
+    if(!input_queue.pop(event)) return false;
+    input.apply(event);
+    return true;
+}
+
+void Window::applyContextHints(){
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, settings.version_major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, settings.version_minor);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, settings.debug ? GLFW_TRUE : GLFW_FALSE);
+}
+
+ContextWorker& Window::createWorker(){
+    glfwDefaultWindowHints();
+    applyContextHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* context = glfwCreateWindow(1, 1, "", NULL, window);
+
+    glfwDefaultWindowHints();
+
+    if (!context) {
+        std::cerr << "Failed to create a shared worker context!" << std::endl;
+        throw std::runtime_error("Failed to create a shared worker context!");
+    }
+
+    workers.push_back(std::make_unique<ContextWorker>(context, state.getUniformLinker(), state.getSamplerCache()));
+
+    // The callback is per context
+    if(settings.debug) workers.back()->submit([](){ debugOutput.install(); });
+    return *workers.back();
+}
+
+std::shared_ptr<WorkerTask> Window::submit(std::function<void()> function){
+    if(workers.empty()) createWorker();
+
+    auto& worker = workers[next_worker];
+    next_worker = (next_worker + 1) % workers.size();
+
+    return worker->submit(std::move(function));
+}
+
 bool Window::shouldClose(){
     return glfwWindowShouldClose(window);
 }
 
 void Window::swapBuffers(){
+#if HEPTCORE_CAPTURE
+    frameCapture.endFrame();
+#endif
     glfwSwapBuffers(window);
+#if HEPTCORE_STATS
+    renderStatistics.endFrame();
+#endif
 }
 
 void Window::pollEvents(){
+    if(rendering.load(std::memory_order_relaxed)) return; // The event thread is on it
     glfwPollEvents();
 }
 
+void Window::releaseContext(){
+    glFlush();
+    makeContextCurrent(nullptr, nullptr);
+}
+
+void Window::run(std::function<void(Window&)> frame){
+    if(std::this_thread::get_id() != event_thread) throw std::logic_error("Window::run has to be called from the thread that created the window.");
+
+    releaseContext();
+    rendering.store(true, std::memory_order_release);
+
+    std::exception_ptr error = nullptr;
+    std::thread render_thread([&](){
+        makeContextCurrent(window, &state);
+
+        try{
+            while(!shouldClose()){
+                frame(*this);
+                swapBuffers();
+            }
+        }
+        catch(...){
+            error = std::current_exception();
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+
+        releaseContext();
+        rendering.store(false, std::memory_order_release);
+        glfwPostEmptyEvent(); // Wakes the event loop up
+    });
+
+    // Blocks until there are events, input reaches the queue as soon as it happens
+    while(rendering.load(std::memory_order_acquire)) glfwWaitEvents();
+
+    render_thread.join();
+    makeContextCurrent(window, &state);
+
+    if(error) std::rethrow_exception(error);
+}
+
 
 Window::~Window(){
+    workers.clear(); // Shared contexts have to go before the window does
+    state.getSamplerCache()->clear(); // Only this windows samplers, needs the context to delete them
+    if(glfwGetCurrentContext() == window) makeContextCurrent(nullptr, nullptr);
     glfwDestroyWindow(window);
     glfwTerminate();
 }
\ No newline at end of file
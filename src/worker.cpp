@@ -0,0 +1,132 @@
+#include <worker.hpp>
+
+using namespace Heptcore;
+
+void Heptcore::makeContextCurrent(GLFWwindow* context, ContextState* state){
+    glfwMakeContextCurrent(context);
+    ContextState::setCurrent(state);
+}
+
+WorkerTask::~WorkerTask(){
+    if(!fence) return;
+
+    // Sync objects are shared, any context from the group can delete it
+    if(glfwGetCurrentContext()){
+        glDeleteSync(fence);
+        return;
+    }
+
+    // Otherwise the worker deletes it before its next task. Without the worker the group is gone and the fence with it
+    std::shared_ptr<OrphanedFences> orphans = orphaned_fences.lock();
+    if(!orphans) return;
+    std::lock_guard<std::mutex> lock(orphans->mutex);
+    orphans->fences.push_back(fence);
+}
+
+bool WorkerTask::isComplete(){
+    if(!executed.load(std::memory_order_acquire)) return false;
+    if(error) std::rethrow_exception(error);
+
+    if(!fence) return true;
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+
+    glDeleteSync(fence);
+    fence = nullptr;
+    return true;
+}
+
+void WorkerTask::wait(){
+    executed.wait(false, std::memory_order_acquire); // Sleeps until the worker notifies, returns right away if it already ran
+    if(error) std::rethrow_exception(error);
+
+    if(!fence) return;
+
+    while(true){
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) break;
+        if(status == GL_WAIT_FAILED) break;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+ContextWorker::ContextWorker(GLFWwindow* context, std::shared_ptr<ShaderUniformLinker> linker, std::shared_ptr<SamplerCache> samplers):
+    context(context), state(std::move(linker), std::move(samplers)){
+    thread = std::thread(&ContextWorker::run, this);
+}
+
+ContextWorker::~ContextWorker(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    condition.notify_all();
+    thread.join();
+
+    glfwDestroyWindow(context);
+}
+
+void ContextWorker::run(){
+    makeContextCurrent(context, &state);
+
+    while(true){
+        std::shared_ptr<WorkerTask> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]{ return !running || !tasks.empty(); });
+
+            if(tasks.empty()) break; // Stopped and drained
+            task = tasks.front();
+            tasks.pop_front();
+        }
+
+        deleteOrphanedFences();
+
+        try{
+            task->function();
+        }
+        catch(...){
+            task->error = std::current_exception();
+        }
+
+        task->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        task->orphaned_fences = orphaned_fences;
+        glFlush(); // The fence has to reach the gpu before another context can wait on it
+
+        task->function = nullptr;
+        task->executed.store(true, std::memory_order_release);
+        task->executed.notify_all();
+    }
+
+    deleteOrphanedFences();
+    glFinish();
+    makeContextCurrent(nullptr, nullptr);
+}
+
+void ContextWorker::deleteOrphanedFences(){
+    std::lock_guard<std::mutex> lock(orphaned_fences->mutex);
+    for(GLsync fence: orphaned_fences->fences) glDeleteSync(fence);
+    orphaned_fences->fences.clear();
+}
+
+std::shared_ptr<WorkerTask> ContextWorker::submit(std::function<void()> function){
+    auto task = std::make_shared<WorkerTask>(std::move(function));
+    submit(task);
+    return task;
+}
+
+void ContextWorker::submit(std::shared_ptr<WorkerTask> task){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+}
+
+size_t ContextWorker::pending(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size();
+}
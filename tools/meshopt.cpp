@@ -0,0 +1,238 @@
+#include <mesh/optimizer.hpp>
+#include <mesh/mesh_file.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+
+/*
+    Command line front end for the mesh optimizer
+
+    heptcore_meshopt input.obj [-o output.obj|output.hmesh] [--no-weld] [--epsilon E] [--cache N] [--overdraw T] [--meshlets V T]
+
+    --meshlets builds clusters of at most V vertices and T triangles, stored in .hmesh output
+*/
+
+using namespace Heptcore;
+
+struct ObjLayout{
+    bool texcoords = false;
+    bool normals = false;
+};
+
+/*
+    Loads positions, texcoords and normals, every face corner becomes its own vertex (welding merges them back)
+*/
+static bool loadObj(const std::string& filename, Mesh& mesh, ObjLayout& layout){
+    std::ifstream file(filename);
+    if(!file.is_open()){
+        std::cerr << "Failed to open mesh file: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> positions = {};
+    std::vector<glm::vec2> texcoords = {};
+    std::vector<glm::vec3> normals = {};
+
+    struct Corner{ int position, texcoord, normal; };
+    std::vector<Corner> corners = {};
+
+    auto resolve = [](int index, size_t count){
+        return index < 0 ? (int) count + index : index - 1;
+    };
+
+    std::string line;
+    while(std::getline(file, line)){
+        std::istringstream stream(line);
+        std::string type;
+        stream >> type;
+
+        if(type == "v"){
+            glm::vec3 position = {0,0,0};
+            stream >> position.x >> position.y >> position.z;
+            positions.push_back(position);
+        }
+        else if(type == "vt"){
+            glm::vec2 texcoord = {0,0};
+            stream >> texcoord.x >> texcoord.y;
+            texcoords.push_back(texcoord);
+        }
+        else if(type == "vn"){
+            glm::vec3 normal = {0,0,0};
+            stream >> normal.x >> normal.y >> normal.z;
+            normals.push_back(normal);
+        }
+        else if(type == "f"){
+            std::vector<Corner> face = {};
+            std::string token;
+            while(stream >> token){
+                Corner corner = {-1, -1, -1};
+
+                int values[3] = {0, 0, 0};
+                size_t start = 0;
+                for(int i = 0; i < 3 && start <= token.size(); i++){
+                    size_t end = token.find('/', start);
+                    std::string part = token.substr(start, end == std::string::npos ? std::string::npos : end - start);
+                    if(!part.empty()) values[i] = std::stoi(part);
+                    if(end == std::string::npos) break;
+                    start = end + 1;
+                }
+
+                corner.position = resolve(values[0], positions.size());
+                if(values[1] != 0) corner.texcoord = resolve(values[1], texcoords.size());
+                if(values[2] != 0) corner.normal = resolve(values[2], normals.size());
+                face.push_back(corner);
+            }
+
+            // Fan triangulation
+            for(size_t i = 2; i < face.size(); i++){
+                corners.push_back(face[0]);
+                corners.push_back(face[i - 1]);
+                corners.push_back(face[i]);
+            }
+        }
+    }
+
+    layout.texcoords = !texcoords.empty();
+    layout.normals = !normals.empty();
+
+    mesh.vertex_size = 3 + (layout.texcoords ? 2 : 0) + (layout.normals ? 3 : 0);
+    mesh.position_offset = 0;
+    mesh.vertices.reserve(corners.size() * mesh.vertex_size);
+    mesh.indices.reserve(corners.size());
+
+    for(auto& corner: corners){
+        if(corner.position < 0 || corner.position >= (int) positions.size()){
+            std::cerr << "Invalid position index in: " << filename << std::endl;
+            return false;
+        }
+
+        glm::vec3 position = positions[corner.position];
+        mesh.vertices.insert(mesh.vertices.end(), {position.x, position.y, position.z});
+
+        if(layout.texcoords){
+            glm::vec2 texcoord = (corner.texcoord >= 0 && corner.texcoord < (int) texcoords.size()) ? texcoords[corner.texcoord] : glm::vec2(0,0);
+            mesh.vertices.insert(mesh.vertices.end(), {texcoord.x, texcoord.y});
+        }
+        if(layout.normals){
+            glm::vec3 normal = (corner.normal >= 0 && corner.normal < (int) normals.size()) ? normals[corner.normal] : glm::vec3(0,0,0);
+            mesh.vertices.insert(mesh.vertices.end(), {normal.x, normal.y, normal.z});
+        }
+
+        mesh.indices.push_back((uint) mesh.indices.size());
+    }
+
+    return true;
+}
+
+static bool saveObj(const std::string& filename, const Mesh& mesh, const ObjLayout& layout){
+    std::ofstream file(filename);
+    if(!file.is_open()){
+        std::cerr << "Failed to open output file: " << filename << std::endl;
+        return false;
+    }
+
+    for(size_t vertex = 0; vertex < mesh.vertexCount(); vertex++){
+        const float* data = &mesh.vertices[vertex * mesh.vertex_size];
+        file << "v " << data[0] << " " << data[1] << " " << data[2] << "\n";
+
+        size_t offset = 3;
+        if(layout.texcoords){
+            file << "vt " << data[offset] << " " << data[offset + 1] << "\n";
+            offset += 2;
+        }
+        if(layout.normals) file << "vn " << data[offset] << " " << data[offset + 1] << " " << data[offset + 2] << "\n";
+    }
+
+    for(size_t triangle = 0; triangle < mesh.triangleCount(); triangle++){
+        file << "f";
+        for(int k = 0; k < 3; k++){
+            uint index = mesh.indices[triangle * 3 + k] + 1;
+            file << " " << index;
+            if(layout.texcoords || layout.normals) file << "/" << (layout.texcoords ? std::to_string(index) : "");
+            if(layout.normals) file << "/" << index;
+        }
+        file << "\n";
+    }
+
+    return true;
+}
+
+static void printStatistics(const char* label, const MeshStatistics& statistics){
+    std::cout << label
+              << " vertices: " << statistics.vertices
+              << " triangles: " << statistics.triangles
+              << " acmr: " << statistics.acmr
+              << " atvr: " << statistics.atvr
+              << " overfetch: " << statistics.overfetch << std::endl;
+}
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        std::cerr << "Usage: " << argv[0] << " input.obj [-o output.obj|output.hmesh] [--no-weld] [--epsilon E] [--cache N] [--overdraw T] [--meshlets V T]" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = "";
+    MeshOptimizerSettings settings = {};
+
+    try{
+        for(int i = 2; i < argc; i++){
+            std::string argument = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if(argument == "-o" && has_value) output = argv[++i];
+            else if(argument == "--no-weld") settings.weld = false;
+            else if(argument == "--epsilon" && has_value) settings.weld_epsilon = std::stof(argv[++i]);
+            else if(argument == "--cache" && has_value) settings.cache_size = std::stoul(argv[++i]);
+            else if(argument == "--overdraw" && has_value) settings.overdraw_threshold = std::stof(argv[++i]);
+            else if(argument == "--meshlets" && i + 2 < argc){
+                settings.meshlets = true;
+                settings.meshlet_max_vertices = std::stoul(argv[++i]);
+                settings.meshlet_max_triangles = std::stoul(argv[++i]);
+            }
+            else{
+                std::cerr << "Unknown argument: " << argument << std::endl;
+                return 1;
+            }
+        }
+
+        Mesh mesh = {};
+        ObjLayout layout = {};
+        if(!loadObj(input, mesh, layout)) return 1;
+
+        printStatistics("before", analyzeMesh(mesh, settings.cache_size));
+
+        MeshletData meshlets = {};
+        MeshStatistics statistics = optimizeMesh(mesh, settings, &meshlets);
+
+        printStatistics("after ", statistics);
+
+        if(settings.meshlets){
+            size_t cullable = 0;
+            for(auto& meshlet: meshlets.meshlets) if(meshlet.cone_cutoff < 1.0f) cullable++;
+            std::cout << "meshlets: " << meshlets.meshlets.size() << " with usable cones: " << cullable << std::endl;
+        }
+
+        if(output.ends_with(".hmesh")){
+            std::vector<VertexBindingType> bindings = {VEC3};
+            if(layout.texcoords) bindings.push_back(VEC2);
+            if(layout.normals) bindings.push_back(VEC3);
+
+            writeMeshFile(output, mesh, VertexFormat(bindings), settings.meshlets ? &meshlets : nullptr);
+        }
+        else{
+            if(settings.meshlets && output != "") std::cerr << "Meshlets are only written to .hmesh files." << std::endl;
+            if(output != "" && !saveObj(output, mesh, layout)) return 1;
+        }
+    }
+    catch(const std::exception& exception){
+        std::cerr << "Failed to optimize mesh: " << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <opengl/capture.hpp>
+#include <window.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+    Replays a capture made with frameCapture.captureFrames and times it
+
+    heptcore_replay capture.hcap [--loops N] [--warmup N] [--gpu-calls] [--no-restore]
+
+    Every loop replays all captured frames, by default starting from the captured state again.
+    --gpu-calls adds a timestamp query around every call, which itself costs time, so per frame
+    numbers are best taken without it. Runs headless like heptcore_bench.
+*/
+
+using namespace Heptcore;
+
+struct FrameSamples{
+    std::vector<double> cpu = {};
+    std::vector<double> gpu = {};
+};
+
+static void printSamples(const char* name, std::vector<double>& samples){
+    if(samples.empty()) return;
+
+    std::sort(samples.begin(), samples.end());
+    size_t middle = samples.size() / 2;
+    double median = samples.size() % 2 == 0 ? (samples[middle - 1] + samples[middle]) / 2.0 : samples[middle];
+
+    std::printf("  %s median %8.3f ms  min %8.3f ms  max %8.3f ms\n", name, median, samples.front(), samples.back());
+}
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        std::cerr << "Usage: " << argv[0] << " capture.hcap [--loops N] [--warmup N] [--gpu-calls] [--no-restore]" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    size_t loops = 20;
+    size_t warmup = 2;
+    bool gpu_calls = false;
+    bool restore = true;
+
+    // Declared first so it is destroyed last, after replay deleted its GL objects
+    std::unique_ptr<Window> window = nullptr;
+
+    try{
+        for(int i = 2; i < argc; i++){
+            std::string argument = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if(argument == "--loops" && has_value) loops = std::stoul(argv[++i]);
+            else if(argument == "--warmup" && has_value) warmup = std::stoul(argv[++i]);
+            else if(argument == "--gpu-calls") gpu_calls = true;
+            else if(argument == "--no-restore") restore = false;
+            else{
+                std::cerr << "Unknown argument: " << argument << std::endl;
+                return 1;
+            }
+        }
+
+        CaptureReplay replay = {};
+        replay.load(input);
+        if(replay.getFrameCount() == 0){
+            std::cerr << "Capture has no frames: " << input << std::endl;
+            return 1;
+        }
+
+        WindowSettings settings = {};
+        settings.visible = false;
+        settings.samples = 0;
+        settings.version_minor = 5;
+
+        window = std::make_unique<Window>(std::max(replay.getWidth(), 1), std::max(replay.getHeight(), 1), "heptcore_replay", settings);
+
+        size_t frame_count = replay.getFrameCount();
+        std::vector<FrameSamples> samples(frame_count);
+        CaptureTimings timings = {};
+        timings.gpu = gpu_calls;
+
+        GLuint frame_query = 0;
+        glGenQueries(1, &frame_query);
+
+        replay.restore();
+        for(size_t loop = 0; loop < warmup + loops; loop++){
+            bool measured = loop >= warmup;
+            if(restore && loop > 0) replay.restore();
+            glFinish();
+
+            for(size_t frame = 0; frame < frame_count; frame++){
+                glBeginQuery(GL_TIME_ELAPSED, frame_query);
+                auto start = std::chrono::steady_clock::now();
+
+                replay.replayFrame(frame, measured ? &timings : nullptr);
+                window->swapBuffers();
+
+                auto end = std::chrono::steady_clock::now();
+                glEndQuery(GL_TIME_ELAPSED);
+
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(frame_query, GL_QUERY_RESULT, &elapsed);
+                if(!measured) continue;
+
+                samples[frame].cpu.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                samples[frame].gpu.push_back(elapsed / 1000000.0);
+            }
+        }
+
+        glDeleteQueries(1, &frame_query);
+
+        std::printf("%s: %zu frames, %dx%d, %zu loops\n", input.c_str(), frame_count, replay.getWidth(), replay.getHeight(), loops);
+        for(size_t frame = 0; frame < frame_count; frame++){
+            std::printf("frame %zu (%zu calls)\n", frame, replay.getCallCount(frame));
+            printSamples("cpu", samples[frame].cpu);
+            printSamples("gpu", samples[frame].gpu);
+        }
+
+        std::printf("\n%-30s %10s %12s %12s\n", "call", "count", "cpu ms/loop", gpu_calls ? "gpu ms/loop" : "");
+        for(int op = 0; op < CAPTURE_OP_COUNT; op++){
+            CaptureCallTiming& call = timings.calls[op];
+            if(call.count == 0) continue;
+
+            std::printf("%-30s %10llu %12.4f", captureOpName((CaptureOp) op), (unsigned long long) (call.count / std::max(loops, (size_t) 1)), call.cpu_ms / std::max(loops, (size_t) 1));
+            if(gpu_calls) std::printf(" %12.4f", call.gpu_ms / std::max(loops, (size_t) 1));
+            std::printf("\n");
+        }
+    }
+    catch(const std::exception& exception){
+        std::cerr << "Failed to replay capture: " << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}